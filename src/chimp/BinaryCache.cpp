@@ -0,0 +1,208 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Implementation of chimp::BinaryCache.
+ */
+
+#include <chimp/BinaryCache.h>
+
+#include <fstream>
+#include <iterator>
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  define CHIMP_BINARYCACHE_MMAP 1
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+namespace chimp {
+
+  namespace {
+    const char magic[8] = { 'C', 'H', 'I', 'M', 'P', 'B', 'I', 'N' };
+    const unsigned int byte_order = 0x01020304u;
+  }
+
+  const unsigned int BinaryCache::version = 3u;
+
+  struct BinaryCache::Contents {
+    /** Beginning of the file contents. */
+    const char * data;
+
+    /** Size of the file contents. */
+    std::size_t length;
+
+    /** Whether data is memory-mapped (otherwise it was read into buffer). */
+    bool mapped;
+
+    /** Storage used when the file could not be memory-mapped. */
+    std::vector<char> buffer;
+
+    Contents() : data( NULL ), length( 0u ), mapped( false ) { }
+
+    /** Unmap (or free) the file contents. */
+    ~Contents() {
+#ifdef CHIMP_BINARYCACHE_MMAP
+      if ( mapped && data )
+        ::munmap( const_cast<char *>( data ), length );
+#endif
+    }
+  };
+
+  void BinaryCache::writeHeader( BinaryWriter & out,
+                                 const std::string & signature ) {
+    for ( unsigned int i = 0u; i < sizeof(magic); ++i )
+      out.write( magic[i] );
+    out.write( version );
+    out.write( byte_order );
+    out.write( static_cast<unsigned int>( sizeof(double) ) );
+    out.write( signature );
+  }
+
+  BinaryCache::BinaryCache( const std::string & filename,
+                            const Storage & storage )
+    : data( NULL ), length( 0u ), data_offset( 0u ) {
+    shared_ptr<Contents> c( new Contents );
+
+#ifdef CHIMP_BINARYCACHE_MMAP
+    int fd = storage == SHARED_MEMORY
+           ? ::shm_open( filename.c_str(), O_RDONLY, 0 )
+           : ::open( filename.c_str(), O_RDONLY );
+    if ( fd >= 0 ) {
+      struct stat st;
+      if ( ::fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+        void * p = ::mmap( NULL, st.st_size, PROT_READ,
+                           storage == SHARED_MEMORY ? MAP_SHARED : MAP_PRIVATE,
+                           fd, 0 );
+        if ( p != MAP_FAILED ) {
+          c->data = static_cast<const char *>( p );
+          c->length = st.st_size;
+          c->mapped = true;
+        }
+      }
+      ::close( fd );
+    }
+#endif
+
+    if ( storage == SHARED_MEMORY && !c->mapped )
+      throw std::runtime_error(
+        "chimp::BinaryCache:  could not attach to shared memory object '" +
+        filename + '\'' );
+
+    if ( !c->mapped ) {
+      /* fall back to reading the whole file into memory. */
+      std::ifstream in( filename.c_str(), std::ios::binary );
+      if ( !in )
+        throw std::runtime_error(
+          "chimp::BinaryCache:  could not open '" + filename + '\'' );
+      c->buffer.assign( std::istreambuf_iterator<char>( in ),
+                        std::istreambuf_iterator<char>() );
+      c->data = c->buffer.empty() ? NULL : &c->buffer[0];
+      c->length = c->buffer.size();
+    }
+
+    data = c->data;
+    length = c->length;
+
+    /* validate the header. */
+    BinaryReader in( data, data + length );
+    try {
+      if ( storage == SHARED_MEMORY && data[0] == '\0' )
+        throw std::runtime_error( "shared memory object is not complete" );
+
+      for ( unsigned int i = 0u; i < sizeof(magic); ++i )
+        if ( in.get<char>() != magic[i] )
+          throw std::runtime_error( "not a chimp binary cache" );
+
+      if ( in.get<unsigned int>() != version )
+        throw std::runtime_error( "incompatible format version" );
+
+      if ( in.get<unsigned int>() != byte_order ||
+           in.get<unsigned int>() != sizeof(double) )
+        throw std::runtime_error( "incompatible machine representation" );
+
+      in.read( signature );
+    } catch ( const std::runtime_error & e ) {
+      /* the contents are released with c. */
+      throw std::runtime_error(
+        "chimp::BinaryCache:  '" + filename + "':  " + e.what() );
+    }
+
+    data_offset = length - in.remaining();
+    contents = c;
+  }
+
+  void BinaryCache::publishShared( const std::string & name,
+                                   const std::string & contents ) {
+    const std::string error =
+      "chimp::BinaryCache:  could not publish shared memory object '" +
+      name + "':  ";
+
+    if ( contents.size() < sizeof(magic) )
+      throw std::runtime_error( error + "invalid contents" );
+
+#ifdef CHIMP_BINARYCACHE_MMAP
+    int fd = ::shm_open( name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644 );
+    if ( fd < 0 )
+      throw std::runtime_error( error + std::strerror( errno ) );
+
+    void * p = MAP_FAILED;
+    if ( ::ftruncate( fd, contents.size() ) == 0 )
+      p = ::mmap( NULL, contents.size(), PROT_READ | PROT_WRITE, MAP_SHARED,
+                  fd, 0 );
+    const int e = errno;
+    ::close( fd );
+
+    if ( p == MAP_FAILED ) {
+      ::shm_unlink( name.c_str() );
+      throw std::runtime_error( error + std::strerror( e ) );
+    }
+
+    /* the object is zero-filled by ftruncate; the magic is copied last such
+     * that attaching processes reject a partially written object. */
+    char * dst = static_cast<char *>( p );
+    std::memcpy( dst + sizeof(magic), contents.data() + sizeof(magic),
+                 contents.size() - sizeof(magic) );
+#  ifdef __GNUC__
+    __sync_synchronize();
+#  endif
+    std::memcpy( dst, contents.data(), sizeof(magic) );
+
+    ::munmap( p, contents.size() );
+#else
+    throw std::runtime_error( error + "not supported on this platform" );
+#endif
+  }
+
+  bool BinaryCache::removeShared( const std::string & name ) {
+#ifdef CHIMP_BINARYCACHE_MMAP
+    return ::shm_unlink( name.c_str() ) == 0;
+#else
+    return false;
+#endif
+  }
+
+  BinaryCache::~BinaryCache() { }
+
+} /* namespace chimp */
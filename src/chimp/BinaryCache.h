@@ -0,0 +1,289 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Versioned binary (memory-mapped) storage of a fully initialized
+ * chimp::RuntimeDB, either in a file or in a POSIX shared memory object.
+ */
+
+#ifndef chimp_BinaryCache_h
+#define chimp_BinaryCache_h
+
+#include <boost/shared_ptr.hpp>
+
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+
+namespace chimp {
+  using boost::shared_ptr;
+
+  /** Sequential writer of the binary cache format.  Plain data are written in
+   * the native representation of the machine (the cache header records the
+   * byte order and the size of double in order to reject foreign files).
+   */
+  class BinaryWriter {
+    /* MEMBER STORAGE */
+  private:
+    /** The stream to which all data is written. */
+    std::ostream & out;
+
+
+    /* MEMBER FUNCTIONS */
+  public:
+    /** Constructor. */
+    explicit BinaryWriter( std::ostream & out ) : out( out ) { }
+
+    /** Write a plain (trivially copyable) value. */
+    template < typename T >
+    void write( const T & value ) {
+      out.write( reinterpret_cast<const char*>( &value ), sizeof(T) );
+      if ( !out )
+        throw std::runtime_error( "chimp::BinaryWriter:  write failed" );
+    }
+
+    /** Write a string (length followed by characters). */
+    void write( const std::string & value ) {
+      write( static_cast<unsigned int>( value.size() ) );
+      out.write( value.data(), value.size() );
+      if ( !out )
+        throw std::runtime_error( "chimp::BinaryWriter:  write failed" );
+    }
+
+    /** Write n raw bytes. */
+    void write( const char * bytes, const std::size_t & n ) {
+      out.write( bytes, n );
+      if ( !out )
+        throw std::runtime_error( "chimp::BinaryWriter:  write failed" );
+    }
+
+    /** Write a vector (length followed by each element). */
+    template < typename T >
+    void write( const std::vector<T> & value ) {
+      write( static_cast<unsigned int>( value.size() ) );
+      for ( typename std::vector<T>::const_iterator i = value.begin(),
+                                                  end = value.end();
+            i != end; ++i )
+        write( *i );
+    }
+  };
+
+
+  /** Sequential reader of the binary cache format.  The reader does not own
+   * the memory that it reads from (see BinaryCache).
+   */
+  class BinaryReader {
+    /* MEMBER STORAGE */
+  private:
+    /** The current read position. */
+    const char * pos;
+
+    /** One past the last readable byte. */
+    const char * end;
+
+
+    /* MEMBER FUNCTIONS */
+  public:
+    /** Constructor for reading the range [begin, end). */
+    BinaryReader( const char * begin, const char * end )
+      : pos( begin ), end( end ) { }
+
+    /** Read a plain (trivially copyable) value. */
+    template < typename T >
+    void read( T & value ) {
+      std::memcpy( &value, take( sizeof(T) ), sizeof(T) );
+    }
+
+    /** Read a string. */
+    void read( std::string & value ) {
+      unsigned int n = 0u;
+      read( n );
+      value.assign( take( n ), n );
+    }
+
+    /** Read a vector. */
+    template < typename T >
+    void read( std::vector<T> & value ) {
+      unsigned int n = 0u;
+      read( n );
+      value.resize( n );
+      for ( unsigned int i = 0u; i < n; ++i )
+        read( value[i] );
+    }
+
+    /** Read and return a value of type T. */
+    template < typename T >
+    T get() {
+      T value;
+      read( value );
+      return value;
+    }
+
+    /** Return a reader for the next n bytes and skip them. */
+    BinaryReader split( const std::size_t & n ) {
+      const char * begin = take( n );
+      return BinaryReader( begin, begin + n );
+    }
+
+    /** Whether all data has been read. */
+    bool eof() const { return pos == end; }
+
+    /** The number of bytes that remain to be read. */
+    std::size_t remaining() const { return end - pos; }
+
+  private:
+    /** Advance the read position by n bytes and return the old position. */
+    const char * take( const std::size_t & n ) {
+      if ( static_cast<std::size_t>( end - pos ) < n )
+        throw std::runtime_error( "chimp::BinaryReader:  truncated data" );
+      const char * retval = pos;
+      pos += n;
+      return retval;
+    }
+  };
+
+
+  /** Read-only, memory-mapped binary cache file.
+   *
+   * A cache file consists of a header (magic, format version, byte order,
+   * size of double, and a signature string that identifies the RuntimeDB
+   * configuration) followed by the data written by RuntimeDB::saveBinaryCache.
+   * The file is mapped into memory (where supported) such that loading a
+   * RuntimeDB does not require any parsing of the XML data set.
+   *
+   * The format does not contain any pointers, so the same contents may also be
+   * published once per node as a POSIX shared memory object (see
+   * publishShared and RuntimeDB::saveSharedCache) that all processes on the
+   * node attach to read-only (see SHARED_MEMORY).  Only the serialized
+   * contents are shared this way:  each process still decodes the
+   * properties, cross sections (including the tables of DATA), and
+   * interaction models that it uses into its own memory.  Sharing thus saves
+   * each process the XML parsing and a private copy of the serialized data,
+   * not the memory of the decoded RuntimeDB.
+   *
+   * @see RuntimeDB::saveBinaryCache
+   * @see RuntimeDB::RuntimeDB( const BinaryCache & )
+   */
+  class BinaryCache {
+    /* STATIC STORAGE */
+  public:
+    /** Version of the binary format.  This must be incremented each time the
+     * format of any of the serialized classes changes. */
+    static const unsigned int version;
+
+
+    /* TYPEDEFS */
+  public:
+    /** The (mapped) contents of a cache (defined in the implementation
+     * file). */
+    struct Contents;
+
+    /** Storage from which a cache is opened. */
+    enum Storage {
+      /** A regular file. */
+      REGULAR_FILE,
+
+      /** A POSIX shared memory object (see publishShared). */
+      SHARED_MEMORY
+    };
+
+
+    /* MEMBER STORAGE */
+  private:
+    /** The file contents, which are unmapped (or freed) with the last copy of
+     * this pointer. */
+    shared_ptr<const Contents> contents;
+
+    /** Beginning of the file contents. */
+    const char * data;
+
+    /** Size of the file contents. */
+    std::size_t length;
+
+    /** The signature stored in the header. */
+    std::string signature;
+
+    /** Offset of the first byte following the header. */
+    std::size_t data_offset;
+
+
+    /* MEMBER FUNCTIONS */
+  public:
+    /** Open (map) the given cache file or shared memory object and validate
+     * its header.  A shared memory object is always mapped (read-only) and
+     * its name should be of the form "/name" (see shm_open).
+     * @throws std::runtime_error if the cache cannot be read, if the header
+     * is invalid, or if a shared memory object has not been completely
+     * published yet.
+     */
+    explicit BinaryCache( const std::string & name,
+                          const Storage & storage = REGULAR_FILE );
+
+    /** Release this reference to the contents of the cache file (see
+     * getContents()). */
+    ~BinaryCache();
+
+    /** The signature that was stored in the header of the file. */
+    const std::string & getSignature() const { return signature; }
+
+    /** Obtain a reader for the data following the header.  The reader is only
+     * valid while the contents are still mapped (see getContents()). */
+    BinaryReader reader() const {
+      return BinaryReader( data + data_offset, data + length );
+    }
+
+    /** Shared ownership of the contents of the cache.  The readers of the
+     * cache remain valid for as long as a copy of this pointer exists, even
+     * after the BinaryCache itself has been destroyed. */
+    const shared_ptr<const Contents> & getContents() const { return contents; }
+
+    /** Write the header of a cache file with the given signature. */
+    static void writeHeader( BinaryWriter & out, const std::string & signature );
+
+    /** Create the POSIX shared memory object with the given name and the
+     * given (complete) contents of a cache file.  The header is written last
+     * such that attaching to a partially written object fails.  The object
+     * persists until removeShared is called, even after all processes have
+     * detached.
+     * @throws std::runtime_error if the object already exists or cannot be
+     * created.
+     */
+    static void publishShared( const std::string & name,
+                               const std::string & contents );
+
+    /** Remove the name of the given POSIX shared memory object.  Processes
+     * that are attached to it keep their mapping.
+     * @return Whether the object existed.
+     */
+    static bool removeShared( const std::string & name );
+
+  private:
+    /* Not copyable. */
+    BinaryCache( const BinaryCache & );
+    BinaryCache & operator=( const BinaryCache & );
+  };
+
+} /* namespace chimp */
+
+#endif // chimp_BinaryCache_h
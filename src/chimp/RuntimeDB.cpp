@@ -31,6 +31,7 @@
 #  include <chimp/interaction/model/VSSElastic.h>
 #  include <chimp/interaction/filter/EqIO.h>
 #  include <chimp/interaction/filter/Elastic.h>
+#  include <chimp/interaction/detail/InteractionIndex.h>
 #  include <chimp/interaction/cross_section/VHS.h>
 #  include <chimp/interaction/cross_section/Log.h>
 #  include <chimp/interaction/cross_section/DATA.h>
@@ -43,13 +44,17 @@
 #  include <xylose/strutil.h>
 #  include <xylose/compat/math.hpp>
 
+#  include <physical/physical.h>
+
 #  include <ostream>
 #  include <fstream>
 #  include <sstream>
 #  include <cfloat>
 #  include <set>
 #  include <string>
+#  include <iterator>
 #  include <algorithm>
+#  include <typeinfo>
 
 /** \file
  * Implementation file for chimp::RuntimeDB.
@@ -61,11 +66,33 @@ namespace chimp {
   RuntimeDB<T>::RuntimeDB(const std::string & xml_doc)
     : xmlDb(xml_doc),
       default_ElasticCreator_vmax(0.0),
-      default_ElasticCreator_dv(0.0) {
-    /* Let's make sure that the calculator is prepared. */
+      default_ElasticCreator_dv(0.0),
+      default_PreComputedSet_Emax(100.0 * physical::constant::si::eV),
+      default_PreComputedSet_n(1000u),
+      set_loader(this) {
+    /* Let's make sure that the calculators are prepared:  our own for all
+     * loading done by this database and the process-wide calculator for
+     * quantities of the data set that are parsed outside of it. */
+    calculator.prepare(xmlDb);
     prepareCalculator(xmlDb);
 
+    registerDefaults();
+  }
+
+  template < typename T >
+  RuntimeDB<T>::RuntimeDB( const BinaryCache & cache )
+    : xmlDb(),
+      default_ElasticCreator_vmax(0.0),
+      default_ElasticCreator_dv(0.0),
+      default_PreComputedSet_Emax(100.0 * physical::constant::si::eV),
+      default_PreComputedSet_n(1000u),
+      set_loader(this) {
+    registerDefaults();
+    loadBinaryCache( cache );
+  }
 
+  template < typename T >
+  void RuntimeDB<T>::registerDefaults() {
     /* register the library-provided CrossSection functors. */
     typedef interaction::cross_section::VHS<options> VHS;
     typedef interaction::cross_section::Log<options> Log;
@@ -97,64 +124,139 @@ namespace chimp {
   template < typename T >
   typename RuntimeDB<T>::LHSRelatedInteractionCtx
   RuntimeDB<T>::findAllLHSRelatedInteractionCtx( const std::string & xpath_extra ) {
+    return findAllLHSRelatedInteractionCtx( xpath_extra, NULL );
+  }
+
+
+  template < typename T >
+  typename RuntimeDB<T>::LHSRelatedInteractionCtx
+  RuntimeDB<T>::findAllLHSRelatedInteractionCtx(
+    const std::set<std::string> & products ) {
+    return findAllLHSRelatedInteractionCtx( "", &products );
+  }
+
+
+  template < typename T >
+  typename RuntimeDB<T>::LHSRelatedInteractionCtx
+  RuntimeDB<T>::findAllLHSRelatedInteractionCtx(
+    const std::string & xpath_extra,
+    const std::set<std::string> * products ) {
     LHSRelatedInteractionCtx retval;
 
-    for (unsigned int A = 0; A < props.size(); ++A) {
-      for (unsigned int B = A; B < props.size(); ++B) {
-        interaction::Input in(A, B);
+    /* We index all Interactions that have total cross_section data by their
+     * inputs with one pass through the document. */
+    typedef interaction::detail::InteractionIndex Index;
+    const Index index( xmlDb.root_context );
 
-        using std::string;
-        using property::name;
-        const string & n_A = props[A].name::value;
-        const string & n_B = props[B].name::value;
-
-        using interaction::filter::EqTerm;
-        using interaction::filter::EqTermSet;
-        EqTermSet in_eq_set;
-        if ( A == B ) {
-          in_eq_set.insert( EqTerm(n_A,2) );
-        } else {
-          in_eq_set.insert( EqTerm(n_A,1) );
-          in_eq_set.insert( EqTerm(n_B,1) );
-        }
+    for (unsigned int A = 0; A < props.size(); ++A)
+      for (unsigned int B = A; B < props.size(); ++B)
+        retval[ interaction::Input(A, B) ] =
+          findLHSRelatedInteractionCtx( index, A, B, xpath_extra, products );
 
-        /* We search for all Interactions that have total cross_section data AND
-         * all interactions with the correct inputs. */
-        xml::Context::list xl = xmlDb.eval(
-          "//Interaction/cross_section/../" + getXpathQuery("In", in_eq_set)
-          + ( xpath_extra.size() > 0 ? '/' + xpath_extra : "" )
-        );
-        retval[in] = filter->filter( xml::Context::set( xl.begin(), xl.end() ) );
-      }
+    return retval;
+  }
+
+
+  template < typename T >
+  xml::Context::set
+  RuntimeDB<T>::findLHSRelatedInteractionCtx(
+    const interaction::detail::InteractionIndex & index,
+    const unsigned int & A,
+    const unsigned int & B,
+    const std::string & xpath_extra,
+    const std::set<std::string> * products,
+    const std::set<std::string> * previous ) {
+    typedef interaction::detail::InteractionIndex Index;
+
+    using std::string;
+    using property::name;
+    const string & n_A = props[A].name::value;
+    const string & n_B = props[B].name::value;
+
+    using interaction::filter::EqTerm;
+    using interaction::filter::EqTermSet;
+    EqTermSet in_eq_set;
+    if ( A == B ) {
+      in_eq_set.insert( EqTerm(n_A,2) );
+    } else {
+      in_eq_set.insert( EqTerm(n_A,1) );
+      in_eq_set.insert( EqTerm(n_B,1) );
     }
 
+    /* The views of the indexed entries are parsed only once and reused by
+     * the filter for each pair of species, unless xpath_extra selects other
+     * nodes. */
+    xml::Context::set xs;
+    interaction::filter::ViewList views;
+    bool changed = !previous;
+    const Index::EntryList & entries = index.find( in_eq_set );
+    for ( Index::EntryList::const_iterator i = entries.begin(),
+                                         end = entries.end();
+          i != end; ++i ) {
+      if ( products && !Index::hasOnlyProducts( *i, *products ) )
+        continue;
+
+      if ( previous && !Index::hasOnlyProducts( *i, *previous ) )
+        changed = true;
+
+      if ( xpath_extra.size() > 0 ) {
+        xml::Context::list xl = i->context().eval( xpath_extra );
+        xs.insert( xl.begin(), xl.end() );
+      } else
+        views.push_back( &i->view );
+    }
+
+    if ( !changed )
+      return xml::Context::set();
+
     /* now filter the interactions to get the desired subset. */
-    return retval;
+    if ( xpath_extra.size() > 0 )
+      return filter->filter( xs );
+
+    views = filter->filterViews( views );
+    for ( interaction::filter::ViewList::iterator i = views.begin(),
+                                                end = views.end();
+          i != end; ++i )
+      xs.insert( (*i)->context() );
+    return xs;
   }
 
 
   template < typename T >
   void RuntimeDB<T>::initBinaryInteractions() {
+    using property::name;
+
+    /* remember the current order of the species for the species_remap hook.
+     */
+    std::vector<std::string> previous;
+    if ( species_remap )
+      for ( unsigned int i = 0u; i < props.size(); ++i )
+        previous.push_back( props[i].name::value );
+
     /* first thing we do is to sort the particle property entries by mass and
      * name. */
     std::sort(props.begin(), props.end(), property::Comparator());
 
+    if ( species_remap ) {
+      std::vector<int> new_index( previous.size() );
+      bool renumbered = false;
+      for ( unsigned int i = 0u; i < previous.size(); ++i ) {
+        new_index[i] = findParticleIndx( previous[i] );
+        renumbered = renumbered || new_index[i] != static_cast<int>(i);
+      }
+
+      if ( renumbered )
+        (*species_remap)( new_index );
+    }
+
     /* We need to get the set of all particle names to do extra filtering */
-    std::string particles_output_filter;
+    std::set<std::string> particle_names;
     {
-      std::ostringstream istr;
       typedef typename PropertiesVector::iterator PIter;
       for ( PIter i = props.begin(), end = props.end(); i != end; ++i ) {
         using property::name;
-        istr << ':' << i->name::value << ':';
+        particle_names.insert( i->name::value );
       }
-
-      particles_output_filter =
-        "Eq/Out["
-          "T/P[     contains('" + istr.str() + "', concat(':',text(),':'))]"
-        "][not("
-          "T/P[not( contains('" + istr.str() + "', concat(':',text(),':')))]"
-        ")]/../..";
     }
 
     /* make sure that the side-length of the matrix is set correctly. */
@@ -162,30 +264,499 @@ namespace chimp {
 
     /* Get all LHS  related interaction contexts. */
     LHSRelatedInteractionCtx lhs_ctxs =
-      findAllLHSRelatedInteractionCtx( particles_output_filter );
+      findAllLHSRelatedInteractionCtx( particle_names );
+    typedef LHSRelatedInteractionCtx::const_iterator LHSCtxIter;
+
+    if ( options::lazy_sets ) {
+      deferSets( lhs_ctxs );
+      return;
+    }
+
+    std::vector< std::pair<int,int> > loaded;
+    std::vector< std::size_t > parsed;
+    {
+      /* The equations are parsed with our units calculator (which is not
+       * thread safe) and in the order of the filtered contexts, such that the
+       * order of each set.rhs is deterministic.  The cross sections are
+       * initialized afterwards by prepareSets. */
+      CalcContext::Scope scope( calculator );
+
+      for ( LHSCtxIter lhs_i  = lhs_ctxs.begin(),
+                       lhend  = lhs_ctxs.end();
+                       lhs_i != lhend; ++lhs_i ) {
+        interaction::Input const & in = lhs_i->first;
+
+        /* first instantiate the (A,B)th interactions */
+        Set & set = interactions( in.A.species, in.B.species );
+        set.lhs = in;
+
+        loaded.push_back( std::make_pair( in.A.species, in.B.species ) );
+        parsed.push_back( set.rhs.size() );
+
+        xml::Context::set const & xs = lhs_i->second;
+        /* add each of the allowed interactions to the new set. */
+        for ( xml::Context::set::const_iterator k = xs.begin(),
+                                       kend = xs.end();
+                                         k != kend; ++k ) {
+          /* Finally parse the Equation and push it into the Output stack. */
+          set.rhs.push_back(Set::Equation::parse(*k,*this));
+        }
+      }
+    }
+
+    prepareSets( loaded, parsed );
+
+    if (options::auto_create_missing_elastic)
+      createMissingElasticCrossSections();
+
+    /* only keep the pairs of species that can interact. */
+    interactions.compact();
+  }
+
+
+  template < typename T >
+  int RuntimeDB<T>::extendBinaryInteractions() {
+    const unsigned int n_old = interactions.side_length();
+    const unsigned int n = props.size();
+    if ( n <= n_old )
+      return n;
+
+    using property::name;
+    std::set<std::string> previous, particle_names;
+    for ( unsigned int i = 0u; i < n; ++i ) {
+      particle_names.insert( props[i].name::value );
+      if ( i < n_old )
+        previous.insert( props[i].name::value );
+    }
+
+    interactions.extend( n );
+
+    typedef interaction::detail::InteractionIndex Index;
+    const Index index( xmlDb.root_context );
+
+    /* equations to load into each set, in the order of the filtered
+     * contexts. */
+    typedef std::vector< xml::Context > CtxList;
+    std::vector< std::pair<int,int> > changed, reloaded;
+    std::vector< CtxList > to_load;
+
+    for ( unsigned int B = 0u; B < n; ++B ) {
+      for ( unsigned int A = 0u; A <= B; ++A ) {
+        const bool is_new = B >= n_old;
+        const xml::Context::set xs =
+          findLHSRelatedInteractionCtx( index, A, B, "", &particle_names,
+                                        is_new ? NULL : &previous );
+        if ( xs.empty() )
+          continue;
+
+        const std::pair<int,int> AB( A, B );
+        if ( options::lazy_sets &&
+             ( is_new || interactions.isPending( A, B ) ) ) {
+          /* the set has not been loaded yet. */
+          if ( is_new )
+            interactions( A, B ).lhs = interaction::Input( A, B );
+          interactions.setPending( A, B );
+          pending_ctxs[AB] = xs;
+          continue;
+        }
+
+        Set & set = interactions( A, B );
+        set.lhs = interaction::Input( A, B );
+
+        CtxList load( xs.begin(), xs.end() );
+        if ( !is_new ) {
+          /* only add the equations that the previous species did not allow,
+           * unless the filter now drops some of the previous equations. */
+          const xml::Context::set old_xs =
+            findLHSRelatedInteractionCtx( index, A, B, "", &previous );
+
+          if ( std::includes( xs.begin(), xs.end(),
+                              old_xs.begin(), old_xs.end() ) ) {
+            load.clear();
+            std::set_difference( xs.begin(), xs.end(),
+                                 old_xs.begin(), old_xs.end(),
+                                 std::back_inserter( load ) );
+          } else {
+            set.rhs.clear();
+            if ( A != B )
+              reloaded.push_back( AB );
+          }
+        }
+
+        changed.push_back( AB );
+        to_load.push_back( load );
+      }
+    }
+
+    if ( options::lazy_sets && options::auto_create_missing_elastic )
+      for ( unsigned int j = n_old; j < n; ++j ) {
+        if ( !interactions.contains( j, j ) )
+          continue;
+        for ( unsigned int i = 0u; i < j; ++i )
+          if ( interactions.contains( i, i ) )
+            interactions.setPending( i, j );
+      }
+
+    std::vector< std::size_t > parsed;
+    {
+      /* see initBinaryInteractions */
+      CalcContext::Scope scope( calculator );
+
+      for ( unsigned int k = 0u; k < changed.size(); ++k ) {
+        Set & set = interactions( changed[k].first, changed[k].second );
+        parsed.push_back( set.rhs.size() );
+        for ( CtxList::const_iterator i = to_load[k].begin(),
+                                    end = to_load[k].end();
+                                      i != end; ++i )
+          set.rhs.push_back(Set::Equation::parse(*i,*this));
+      }
+    }
+
+    prepareSets( changed, parsed );
+
+    if ( options::auto_create_missing_elastic ) {
+      if ( !options::lazy_sets )
+        for ( unsigned int j = n_old; j < n; ++j )
+          for ( unsigned int i = 0u; i < j; ++i )
+            createMissingElasticCrossSections( i, j );
+
+      /* previous sets that were reloaded have lost any elastic cross section
+       * that had been created for them. */
+      for ( unsigned int k = 0u; k < reloaded.size(); ++k )
+        createMissingElasticCrossSections( reloaded[k].first,
+                                           reloaded[k].second );
+    }
+
+    if ( options::lazy_sets )
+      interactions.setLoader( &set_loader );
+    else
+      /* only keep the pairs of species that can interact. */
+      interactions.compact();
+
+    return n_old;
+  }
+
+
+  template < typename T >
+  void RuntimeDB<T>::deferSets( const LHSRelatedInteractionCtx & lhs_ctxs ) {
     typedef LHSRelatedInteractionCtx::const_iterator LHSCtxIter;
 
+    pending_ctxs.clear();
     for ( LHSCtxIter lhs_i  = lhs_ctxs.begin(),
                      lhend  = lhs_ctxs.end();
                      lhs_i != lhend; ++lhs_i ) {
+      if ( lhs_i->second.empty() )
+        continue;
+
       interaction::Input const & in = lhs_i->first;
+      const int & A = in.A.species;
+      const int & B = in.B.species;
 
-      /* first instantiate the (A,B)th interactions */
-      Set & set = interactions( in.A.species, in.B.species );
-      set.lhs = in;
+      interactions( A, B ).lhs = in;
+      interactions.setPending( A, B );
+      pending_ctxs[ std::make_pair( std::min(A,B), std::max(A,B) ) ]
+        = lhs_i->second;
+    }
 
-      xml::Context::set const & xs = lhs_i->second;
-      /* add each of the allowed interactions to the new set. */
-      for ( xml::Context::set::const_iterator k = xs.begin(),
-                                     kend = xs.end();
-                                       k != kend; ++k ) {
-        /* Finally load the Equation fully and push it into the Output stack. */
-        set.rhs.push_back(Set::Equation::load(*k,*this));
+    if ( options::auto_create_missing_elastic ) {
+      /* whether an elastic cross section can be created for a pair is only
+       * known once the sets of both species have been loaded. */
+      for ( unsigned int j = 0u; j < props.size(); ++j ) {
+        if ( !interactions.contains( j, j ) )
+          continue;
+        for ( unsigned int i = 0u; i < j; ++i )
+          if ( interactions.contains( i, i ) )
+            interactions.setPending( i, j );
       }
     }
 
-    if (options::auto_create_missing_elastic)
-      createMissingElasticCrossSections();
+    interactions.setLoader( &set_loader );
+  }
+
+
+  template < typename T >
+  void RuntimeDB<T>::loadPendingSet( Set & set, const int & i, const int & j ) {
+    typedef std::map< std::pair<int,int>, xml::Context::set > PendingCtxs;
+    typename PendingCtxs::iterator c = pending_ctxs.find( std::make_pair(i,j) );
+
+    typedef std::map<
+      std::pair<int,int>,
+      std::pair<unsigned int, BinaryReader>
+    > PendingRecords;
+    typename PendingRecords::iterator r =
+      pending_records.find( std::make_pair(i,j) );
+
+    if ( r != pending_records.end() ) {
+      /* sets of a binary cache already include any missing elastic cross
+       * section.  The reader is copied such that a failed load can be
+       * repeated. */
+      BinaryReader eqs = r->second.second;
+      try {
+        for ( unsigned int k = 0u; k < r->second.first; ++k )
+          set.rhs.push_back( Set::Equation::load( eqs, *this ) );
+
+        if ( !eqs.eof() )
+          throw std::runtime_error( "corrupt equations in binary cache" );
+
+        set.updateRecord();
+        precomputeSet( set );
+      } catch ( ... ) {
+        set.rhs.clear();
+        throw;
+      }
+
+      pending_records.erase( r );
+      if ( pending_records.empty() )
+        pending_cache.reset();
+      return;
+    }
+
+    /* see initBinaryInteractions.  Sets of a binary cache (above) are loaded
+     * without the calculator. */
+    CalcContext::Scope scope( calculator );
+
+    try {
+      if ( c != pending_ctxs.end() ) {
+        xml::Context::set const & xs = c->second;
+        for ( xml::Context::set::const_iterator k = xs.begin(),
+                                       kend = xs.end();
+                                         k != kend; ++k )
+          set.rhs.push_back(Set::Equation::load(*k,*this));
+      }
+
+      /* createMissingElasticCrossSections prepares the sets it changes. */
+      if ( !options::auto_create_missing_elastic || i == j ||
+           createMissingElasticCrossSections( i, j ) == 0 ) {
+        set.updateRecord();
+        precomputeSet( set );
+      }
+    } catch ( ... ) {
+      /* the set remains pending and is loaded again on next access. */
+      set.rhs.clear();
+      throw;
+    }
+
+    if ( c != pending_ctxs.end() )
+      pending_ctxs.erase( c );
+  }
+
+
+  template < typename T >
+  inline void RuntimeDB<T>::prepareSet( const int & i, const int & j ) {
+    interactions(i,j).updateRecord();
+    precomputeSet( i, j );
+  }
+
+
+  template < typename T >
+  void RuntimeDB<T>::prepareSets(
+    const std::vector< std::pair<int,int> > & pairs,
+    const std::vector< std::size_t > & parsed ) {
+    /* look up all sets before starting any threads. */
+    std::vector< Set * > sets( pairs.size() );
+    for ( unsigned int k = 0u; k < pairs.size(); ++k )
+      sets[k] = &interactions( pairs[k].first, pairs[k].second );
+
+    /* exceptions may not leave the parallel region; the first is rethrown. */
+    std::string error;
+    const int n_sets = static_cast<int>( sets.size() );
+
+    #pragma omp parallel for schedule(dynamic,1)
+    for ( int k = 0; k < n_sets; ++k ) {
+      try {
+        Set & set = *sets[k];
+        if ( !parsed.empty() )
+          for ( std::size_t i = parsed[k]; i < set.rhs.size(); ++i )
+            set.rhs[i].initialize();
+
+        set.updateRecord();
+        precomputeSet( set );
+      } catch ( const std::exception & e ) {
+        #pragma omp critical (chimp_RuntimeDB_prepareSets)
+        if ( error.empty() )
+          error = e.what();
+      } catch ( ... ) {
+        #pragma omp critical (chimp_RuntimeDB_prepareSets)
+        if ( error.empty() )
+          error = "unknown exception while preparing interaction sets";
+      }
+    }
+
+    if ( !error.empty() )
+      throw std::runtime_error( error );
+  }
+
+
+  template < typename T >
+  inline void RuntimeDB<T>::precomputeSet( const int & i, const int & j ) {
+    precomputeSet( interactions(i,j) );
+  }
+
+
+  template < typename T >
+  inline void RuntimeDB<T>::precomputeSet( Set & set ) const {
+    if ( !options::precomputed_sets )
+      return;
+
+    if ( set.rhs.empty() )
+      return;
+
+    /* all equations of the set share the same inputs and reduced mass. */
+    const double & mu = set.rhs.front().reducedMass.value;
+    interaction::precompute( set,
+                             std::sqrt( 2.0 * default_PreComputedSet_Emax / mu ),
+                             default_PreComputedSet_n );
+  }
+
+
+  template < typename T >
+  void RuntimeDB<T>::saveBinaryCache( const std::string & filename ) const {
+    std::ofstream fout( filename.c_str(), std::ios::out | std::ios::binary );
+    if ( !fout )
+      throw std::runtime_error( "could not open binary cache '" + filename +
+                                "' for writing" );
+
+    saveBinaryCache( fout );
+  }
+
+
+  template < typename T >
+  void RuntimeDB<T>::saveSharedCache( const std::string & name ) const {
+    std::ostringstream contents( std::ios::out | std::ios::binary );
+    saveBinaryCache( contents );
+    BinaryCache::publishShared( name, contents.str() );
+  }
+
+
+  template < typename T >
+  void RuntimeDB<T>::saveBinaryCache( std::ostream & fout ) const {
+    BinaryWriter out( fout );
+    BinaryCache::writeHeader( out, typeid(options).name() );
+
+    out.write( default_PreComputedSet_Emax );
+    out.write( default_PreComputedSet_n );
+
+    out.write( static_cast<unsigned int>( props.size() ) );
+    for ( typename PropertiesVector::const_iterator i = props.begin(),
+                                                  end = props.end();
+          i != end; ++i )
+      i->save( out );
+
+    for ( unsigned int A = 0u; A < props.size(); ++A ) {
+      for ( unsigned int B = A; B < props.size(); ++B ) {
+        const Set & set = interactions(A,B);
+        set.lhs.save( out );
+
+        /* the equations are preceded by their size such that they can be
+         * skipped (see options::lazy_sets). */
+        std::ostringstream eqs( std::ios::out | std::ios::binary );
+        BinaryWriter eq_out( eqs );
+        for ( typename Set::Equation::list::const_iterator
+                i = set.rhs.begin(), end = set.rhs.end(); i != end; ++i )
+          i->save( eq_out );
+
+        const std::string bytes = eqs.str();
+        out.write( static_cast<unsigned int>( set.rhs.size() ) );
+        out.write( static_cast<unsigned int>( bytes.size() ) );
+        out.write( bytes.data(), bytes.size() );
+      }
+    }
+  }
+
+
+  template < typename T >
+  void RuntimeDB<T>::loadBinaryCache( const BinaryCache & cache ) {
+    if ( cache.getSignature() != typeid(options).name() )
+      throw std::runtime_error(
+        "binary cache was written for a different RuntimeDB configuration" );
+
+    BinaryReader in = cache.reader();
+
+    in.read( default_PreComputedSet_Emax );
+    in.read( default_PreComputedSet_n );
+
+    /* nothing in the cache is evaluated with the calculator:  interaction
+     * 'ops' expressions are stored with all symbols already resolved. */
+    props.clear();
+    const unsigned int n_props = in.get<unsigned int>();
+    props.reserve( n_props );
+    for ( unsigned int i = 0u; i < n_props; ++i )
+      props.push_back( Properties::load( in ) );
+
+    interactions.resize( props.size() );
+    pending_ctxs.clear();
+    pending_records.clear();
+    pending_cache.reset();
+    std::vector< std::pair<int,int> > loaded;
+    for ( unsigned int A = 0u; A < props.size(); ++A ) {
+      for ( unsigned int B = A; B < props.size(); ++B ) {
+        const interaction::Input lhs = interaction::Input::load( in );
+
+        const unsigned int n_eqs = in.get<unsigned int>();
+        BinaryReader eqs = in.split( in.get<unsigned int>() );
+        if ( n_eqs == 0u )
+          /* pairs without interactions are not stored. */
+          continue;
+
+        Set & set = interactions(A,B);
+        set.lhs = lhs;
+        set.rhs.clear();
+
+        if ( options::lazy_sets ) {
+          interactions.setPending( A, B );
+          pending_records.insert(
+            std::make_pair( std::make_pair( int(A), int(B) ),
+                            std::make_pair( n_eqs, eqs ) ) );
+          continue;
+        }
+
+        for ( unsigned int i = 0u; i < n_eqs; ++i )
+          set.rhs.push_back( Set::Equation::load( eqs, *this ) );
+
+        if ( !eqs.eof() )
+          throw std::runtime_error( "corrupt equations in binary cache" );
+
+        loaded.push_back( std::make_pair( A, B ) );
+      }
+    }
+
+    if ( !in.eof() )
+      throw std::runtime_error( "unexpected data at end of binary cache" );
+
+    if ( options::lazy_sets ) {
+      if ( !pending_records.empty() )
+        pending_cache = cache.getContents();
+      interactions.setLoader( &set_loader );
+    }
+
+    prepareSets( loaded );
+  }
+
+
+  template < typename T >
+  shared_ptr< typename RuntimeDB<T>::CrossSection >
+  RuntimeDB<T>::loadCrossSection( BinaryReader & in,
+                                  const interaction::Equation<options> & eq )
+  const {
+    std::string label;
+    in.read( label );
+
+    typedef interaction::cross_section::detail::AvgEasy<options> AvgEasy;
+    if ( label == AvgEasy::label ) {
+      /* automatically averaged cross sections are not registered since they
+       * are not loaded from xml; recombine the two sub-cross-sections. */
+      const shared_ptr< CrossSection > cs0 = loadCrossSection( in, eq );
+      const shared_ptr< CrossSection > cs1 = loadCrossSection( in, eq );
+      return shared_ptr< CrossSection >( new AvgEasy( cs0, cs1 ) );
+    }
+
+    typename CrossSectionRegistry::const_iterator i
+      = cross_section_registry.find( label );
+    if ( i == cross_section_registry.end() )
+      throw std::runtime_error(
+        "cross section model '" + label + "' not registered" );
+
+    return shared_ptr< CrossSection >( i->second->new_load( in, eq, *this ) );
   }
 
 
@@ -247,6 +818,7 @@ namespace chimp {
 
   template < typename T >
   inline void RuntimeDB<T>::addParticleType(const xml::Context & x) {
+    CalcContext::Scope scope( calculator );
     Properties prop = Properties::load(x);
     addParticleType(prop);
   }
@@ -354,6 +926,7 @@ namespace chimp {
   template < typename T >
   inline void RuntimeDB<T>::addXMLData( const std::string & filename ) {
     xml::Doc otherDoc(filename);
+    calculator.exec( otherDoc );
     execCalcCommands( otherDoc );
     xmlDb.root_context.extend( otherDoc.root_context );
   }
@@ -396,10 +969,12 @@ namespace chimp {
     for ( unsigned int idx = max(i,0); idx < props.size(); ++idx ) {
       for ( unsigned int jdx = max(j,0); jdx < props.size(); ++ jdx ) {
 
-        /* first instantiate the (A,B)th interactions */
-        Set & setii = interactions( idx, idx );
-        Set & setjj = interactions( jdx, jdx );
-        Set & setij = interactions( idx, jdx );
+        /* only look up the sets here; the (idx,jdx)th set is not added to
+         * the table unless an equation is created for it. */
+        const InteractionTable & table = interactions;
+        const Set & setii = table( idx, idx );
+        const Set & setjj = table( jdx, jdx );
+        const Set & setij = table( idx, jdx );
 
         if ( (! hasElastic( setij ) ) &&
              hasElastic( setii ) && hasElastic(setjj) ) {
@@ -470,7 +1045,8 @@ namespace chimp {
             );
 
             // We've set all the members of Equation by hand, so now insert it
-            setij.rhs.push_back( eq );
+            interactions( idx, jdx ).rhs.push_back( eq );
+            prepareSet( idx, jdx );
 
             ++nNewCS;
           }
@@ -78,9 +78,13 @@
 #ifndef chimp_RuntimeDB_h
 #define chimp_RuntimeDB_h
 
+#  include <chimp/BinaryCache.h>
+#  include <chimp/physical_calc.h>
 #  include <chimp/default_data.h>
 #  include <chimp/make_options.h>
 #  include <chimp/interaction/Set.h>
+#  include <chimp/interaction/PreComputedSet.h>
+#  include <chimp/interaction/SparseInteractionTable.h>
 #  include <chimp/interaction/model/Base.h>
 #  include <chimp/interaction/cross_section/Base.h>
 #  include <chimp/interaction/filter/Base.h>
@@ -91,7 +95,6 @@
 #  include <xylose/logger.h>
 #  include <xylose/xml/Doc.h>
 #  include <xylose/compat/math.hpp>
-#  include <xylose/upper_triangle.h>
 
 #  include <ostream>
 #  include <fstream>
@@ -99,6 +102,7 @@
 #  include <set>
 #  include <string>
 #  include <vector>
+#  include <utility>
 #  include <algorithm>
 
 
@@ -108,6 +112,12 @@ namespace chimp {
   using boost::shared_ptr;
   namespace xml = xylose::xml;
 
+  namespace interaction {
+    namespace detail {
+      class InteractionIndex;
+    }
+  }
+
 
   /** Runtime database of properties pertinent to the current simulation.
    * @param _options
@@ -130,8 +140,10 @@ namespace chimp {
     /** Particle Properties that are loaded from the xml file. */
     typedef typename options::Properties Properties;
 
-    /** Set of interactions equations that share the same inputs. */
-    typedef interaction::Set<options> Set;
+    /** Set of interactions equations that share the same inputs.  This is
+     * either interaction::Set or interaction::PreComputedSet, depending on
+     * options::precomputed_sets. */
+    typedef typename interaction::SetType<options>::type Set;
 
     /** Cross section Base type. */
     typedef interaction::cross_section::Base<options> CrossSection;
@@ -151,13 +163,11 @@ namespace chimp {
       shared_ptr< Interaction >
     > InteractionRegistry;
 
-    /** Data type for the Interaction table.  This is really just a wrapper
-     * around the std::vector class such that using operator()(i,j) works easily
-     * and correctly. */
-    typedef xylose::upper_triangle<
-      Set,
-      xylose::SymmetryFix
-    > InteractionTable;
+    /** Data type for the Interaction table.  Only the pairs of species that
+     * have interactions are stored; operator()(i,j) yields a blank Set for
+     * all other pairs.  The active partners of each species are listed by
+     * InteractionTable::partners(A). */
+    typedef interaction::SparseInteractionTable<Set> InteractionTable;
 
     /** Vector type used to store all loaded particle properties. */
     typedef std::vector<Properties> PropertiesVector;
@@ -171,6 +181,20 @@ namespace chimp {
       xml::Context::set
     > LHSRelatedInteractionCtx;
 
+    /** Callback that is notified when initBinaryInteractions() changes the
+     * indices of the particle species by sorting them by mass and name (see
+     * species_remap). */
+    struct SpeciesRemap {
+      virtual ~SpeciesRemap() { }
+
+      /** Remap the species indices that are stored by the simulation (for
+       * example in the particle arrays).
+       * @param new_index
+       *    The new index of each previous species index.
+       */
+      virtual void operator() ( const std::vector<int> & new_index ) = 0;
+    };
+
 
 
     /* MEMBER STORAGE */
@@ -178,6 +202,11 @@ namespace chimp {
     /** XML document from which data is extracted.  */
     xml::Doc xmlDb;
 
+    /** Units calculator context of this database.  All quantities of the xml
+     * data set are evaluated within this context, such that the calc-commands
+     * of one database do not affect any other database in the process.  */
+    CalcContext calculator;
+
     /** Registry for cross section functor classes. */
     CrossSectionRegistry cross_section_registry;
 
@@ -192,6 +221,14 @@ namespace chimp {
      * collisions. */
     shared_ptr<interaction::filter::Base> filter;
 
+    /** Optional hook that is called whenever initBinaryInteractions()
+     * renumbers previously added particle species.  This allows species to
+     * be added with extendBinaryInteractions() (which never renumbers species)
+     * and to be sorted by mass later, if mass ordering is really required.
+     * [Default: NULL]
+     */
+    shared_ptr<SpeciesRemap> species_remap;
+
     /** Specifies the maximum range overwhich to sum the diameters of the
      * auto-combined non vhs-vhs cross section pairs.  Extrapolation beyond this
      * range will follow the normal procedure.  IF <=0, only vhs-vhs cross
@@ -207,15 +244,65 @@ namespace chimp {
      */
     double default_ElasticCreator_dv;
 
+    /** Specifies the maximum relative kinetic energy (in Joules) tabulated by
+     * each interaction::PreComputedSet.  The maximum relative speed of each
+     * table is determined from this energy and the reduced mass of the
+     * inputs.  Only used if options::precomputed_sets is true.
+     * [Default: 100 eV]
+     */
+    double default_PreComputedSet_Emax;
+
+    /** Specifies the number of grid points of each interaction::PreComputedSet
+     * table.  Only used if options::precomputed_sets is true.
+     * [Default: 1000]
+     */
+    unsigned int default_PreComputedSet_n;
+
   private:
     /** Vector of particle properties.
      * Note that the order of the entries in the properties vector is NOT well
      * determined, until AFTER initBinaryInteractions() has been called.  */
     PropertiesVector props;
 
-    /** Initialized at time of initBinaryInteractions() call. */
+    /** Initialized at time of initBinaryInteractions() call.  Pairs without
+     * equations are removed at the end of initBinaryInteractions() and
+     * loadBinaryCache() (unless options::lazy_sets is true). */
     InteractionTable interactions;
 
+    /** Loads the pending sets of the interaction table on first access
+     * (see options::lazy_sets). */
+    struct SetLoader : InteractionTable::Loader {
+      RuntimeDB * db;
+
+      SetLoader( RuntimeDB * db ) : db( db ) { }
+
+      void load( Set & set,
+                 const unsigned int & i,
+                 const unsigned int & j ) const {
+        db->loadPendingSet( set, i, j );
+      }
+    };
+
+    /** The loader of the pending sets of the interaction table.  Copies of a
+     * RuntimeDB with pending sets load them through the original RuntimeDB
+     * (see loadPendingSets()). */
+    SetLoader set_loader;
+
+    /** The equation contexts of each pending set of the interaction table,
+     * indexed by the (ordered) pair of species. */
+    std::map< std::pair<int,int>, xml::Context::set > pending_ctxs;
+
+    /** The number of equations and the binary cache data of each pending set
+     * of the interaction table that is loaded from a binary cache. */
+    std::map<
+      std::pair<int,int>,
+      std::pair<unsigned int, BinaryReader>
+    > pending_records;
+
+    /** The contents of the binary cache into which pending_records point.  The
+     * contents are kept (mapped) until the last of these sets is loaded. */
+    shared_ptr<const BinaryCache::Contents> pending_cache;
+
 
 
 
@@ -227,6 +314,77 @@ namespace chimp {
      */
     RuntimeDB( const std::string & xml_doc = default_data::particledb() );
 
+    /** Constructor loads a fully initialized database from a binary cache
+     * previously written by saveBinaryCache().  Neither the xml data set nor
+     * the units calculator are used for the properties, cross sections, or
+     * the interaction table (interaction 'ops' expressions are cached with
+     * their symbols already resolved).
+     * The registries and the default filter are set up as for the xml
+     * constructor such that further equations may still be added by hand.
+     *
+     * If options::lazy_sets is true, only the particle properties are loaded
+     * here; the equations of each pair of species are read from the cache
+     * when the set of the pair is first accessed.  The contents of the cache
+     * are kept until all sets have been loaded (see loadPendingSets()), such
+     * that the BinaryCache may also be a temporary.  Together
+     * with a cache in shared memory (see saveSharedCache), no process parses
+     * the XML data set and each process only decodes the sets it uses.  The
+     * decoded sets (cross section tables and models) are private to each
+     * process; only the serialized cache is shared.
+     *
+     * @see saveBinaryCache
+     */
+    explicit RuntimeDB( const BinaryCache & cache );
+
+    /** Write the particle properties and the complete interaction table
+     * (after initBinaryInteractions() and createMissingElasticCrossSections())
+     * to a binary cache file.  The interaction filter is not saved since the
+     * table is written after the filter has already been applied.
+     *
+     * @throws std::runtime_error if the file cannot be written or if any of
+     * the cross sections or interaction models does not support the binary
+     * cache.
+     *
+     * @see RuntimeDB( const BinaryCache & )
+     */
+    void saveBinaryCache( const std::string & filename ) const;
+
+    /** Write the binary cache (see saveBinaryCache) to the given stream. */
+    void saveBinaryCache( std::ostream & out ) const;
+
+    /** Publish the binary cache (see saveBinaryCache) as a POSIX shared memory
+     * object with the given name (of the form "/name").  This is meant to be
+     * called by one process per node; all processes of the node (including
+     * this one) may then attach to the object by
+     * <code>RuntimeDB( BinaryCache( name, BinaryCache::SHARED_MEMORY ) )</code>
+     * once this call has returned (e.g. after a barrier).  The object
+     * persists until BinaryCache::removeShared( name ) is called.  Only the
+     * serialized cache is shared; each attached process decodes the sets it
+     * uses into its own memory (see RuntimeDB( const BinaryCache & )).
+     *
+     * @throws std::runtime_error if the object already exists or if the cache
+     * cannot be written.
+     */
+    void saveSharedCache( const std::string & name ) const;
+
+    /** Replace the particle properties and interaction table with those
+     * stored in the given binary cache.  The tables of all
+     * interaction::PreComputedSet instances are rebuilt after loading.  If
+     * options::lazy_sets is true, the sets are loaded on first access (see
+     * RuntimeDB( const BinaryCache & )).
+     *
+     * @throws std::runtime_error if the cache was written for a different
+     * options class.
+     */
+    void loadBinaryCache( const BinaryCache & cache );
+
+    /** Load a cross section that was saved to a binary cache, using the
+     * cross_section_registry to find the implementation that matches the
+     * stored label.  */
+    shared_ptr< CrossSection >
+    loadCrossSection( BinaryReader & in,
+                      const interaction::Equation<options> & eq ) const;
+
     /** Add XML section data into the already loaded CHIMP XML data set. */
     inline void addXMLData( const std::string & filename );
 
@@ -294,7 +452,8 @@ namespace chimp {
     /** return the set of cross-species properties for the two given species. */
     inline const Set & operator()(const int & i, const int & j) const;
 
-    /** return the set of cross-species properties for the two given species. */
+    /** return the set of cross-species properties for the two given species.
+     * The set is added to the interaction table if it does not yet exist.  */
     inline       Set & operator()(const int & i, const int & j);
 
     /** return the set of cross-species properties for the two given species. */
@@ -328,9 +487,41 @@ namespace chimp {
      */
     inline int findParticleIndx(const std::string & name) const;
 
-    /** Set up the table for interactions with binary inputs. */
+    /** Set up the table for interactions with binary inputs.  If
+     * options::lazy_sets is true, only the pairs of species that interact are
+     * determined; the equations of each pair are loaded (and missing elastic
+     * cross sections are created) when the set of the pair is first accessed.
+     */
     void initBinaryInteractions();
 
+    /** Load all sets of the interaction table that have not yet been
+     * accessed (see options::lazy_sets).  This should be called before a
+     * RuntimeDB with pending sets is copied, since the copy otherwise loads
+     * the sets through this RuntimeDB. */
+    void loadPendingSets() const { interactions.loadAll(); }
+
+    /** Extend the table of binary interactions with the particle species that
+     * have been added (see addParticleType) since the table was set up.
+     * Unlike initBinaryInteractions(), the species are not sorted by mass, so
+     * the indices of all previous species remain unchanged and the new
+     * species are appended in the order in which they were added.  Only the
+     * sets of the new pairs of species are loaded, as well as the new
+     * equations of previous pairs that produce any of the new species.  (A
+     * previous set is only reloaded completely if the filter drops any of its
+     * equations in light of the new species.)  Missing elastic cross sections
+     * of the new pairs are created if options::auto_create_missing_elastic is
+     * true, and with options::lazy_sets the new sets are loaded on first
+     * access.
+     *
+     * This must not be called while the interaction table is in use by other
+     * threads.
+     *
+     * @return The index of the first new species.
+     *
+     * @see species_remap for sorting the species by mass afterwards.
+     */
+    int extendBinaryInteractions();
+
     /** Create the set of all interaction equations that match the left hand
      * side given the current set of load particles.
      *
@@ -342,6 +533,52 @@ namespace chimp {
     LHSRelatedInteractionCtx
     findAllLHSRelatedInteractionCtx( const std::string & xpath_extra = "" );
 
+    /** Create the set of all interaction equations that match the left hand
+     * side given the current set of load particles and that only produce
+     * particles from the given set of names.
+     *
+     * @param products
+     *    The names of the particles that may be produced.
+     */
+    LHSRelatedInteractionCtx
+    findAllLHSRelatedInteractionCtx( const std::set<std::string> & products );
+
+    /** Prepare the interaction::Set of the given pair of species for use after
+     * its equations have been changed:  rebuild the packed record of
+     * interaction::Set::updateRecord and the lookup table of
+     * precomputeSet.
+     */
+    inline void prepareSet( const int & i, const int & j );
+
+    /** Initialize the newly parsed equations (see Equation::initialize) and
+     * then prepare the interaction::Set of each of the given pairs of species
+     * (see prepareSet).  The sets are independent of each other and of the
+     * units calculator and are therefore prepared concurrently if OpenMP is
+     * enabled.
+     *
+     * @param pairs
+     *    The pairs of species of the sets to prepare.
+     * @param parsed
+     *    For each pair, the index of the first equation of set.rhs that has
+     *    only been parsed (Equation::parse).  If empty, all equations are
+     *    already initialized.
+     */
+    void prepareSets( const std::vector< std::pair<int,int> > & pairs,
+                      const std::vector< std::size_t > & parsed
+                        = std::vector< std::size_t >() );
+
+    /** (Re)build the lookup table of the interaction::PreComputedSet for the
+     * given pair of species.  This is a no-op unless options::precomputed_sets
+     * is true.
+     * @see default_PreComputedSet_Emax
+     * @see default_PreComputedSet_n
+     */
+    inline void precomputeSet( const int & i, const int & j );
+
+    /** (Re)build the lookup table of the interaction::PreComputedSet of the
+     * given set (see precomputeSet). */
+    inline void precomputeSet( Set & set ) const;
+
     /** Add in missing elastic cross-species cross sections, assuming that the
      * single-species cross section exists and is already loaded.
      *
@@ -389,6 +626,48 @@ namespace chimp {
                                            const double & vmax = 0.0,
                                            const double & dv = 0.0 );
 
+  private:
+    /** Implementation of findAllLHSRelatedInteractionCtx using a single pass
+     * index of all Interaction nodes.
+     * @param products
+     *    If not NULL, only interactions that produce particles of this set are
+     *    returned.
+     */
+    LHSRelatedInteractionCtx
+    findAllLHSRelatedInteractionCtx( const std::string & xpath_extra,
+                                     const std::set<std::string> * products );
+
+    /** Filtered Interaction contexts with inputs (A,B) (see
+     * findAllLHSRelatedInteractionCtx).
+     * @param previous
+     *    If not NULL, an empty set is returned unless at least one of the
+     *    interactions produces only particles of products but not only
+     *    particles of previous (i.e. the interactions of (A,B) have changed
+     *    by adding the remaining products to previous).
+     */
+    xml::Context::set
+    findLHSRelatedInteractionCtx( const interaction::detail::InteractionIndex &,
+                                  const unsigned int & A,
+                                  const unsigned int & B,
+                                  const std::string & xpath_extra,
+                                  const std::set<std::string> * products,
+                                  const std::set<std::string> * previous
+                                    = NULL );
+
+    /** Register the library-provided cross section and interaction models
+     * and set up the default filter. */
+    void registerDefaults();
+
+    /** Mark the set of each pair of species that has equations (and, if
+     * options::auto_create_missing_elastic is true, of each pair that may
+     * need a missing elastic cross section) as pending, such that it is
+     * loaded by loadPendingSet on first access. */
+    void deferSets( const LHSRelatedInteractionCtx & lhs_ctxs );
+
+    /** Load the equations of the pending set of species i and j, create its
+     * missing elastic cross section, and prepare the set (see prepareSet). */
+    void loadPendingSet( Set & set, const int & i, const int & j );
+
   };/* RuntimeDB */
 
 
@@ -0,0 +1,323 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Structure-of-arrays (SoA) particle storage adaptor:  proxy particle,
+ * iterator, and accessor overloads that allow interaction::Driver,
+ * interaction::Set::interact, and the interaction models to operate directly
+ * on separate position/velocity/species/weight arrays.
+ */
+
+#ifndef chimp_SoAParticles_h
+#define chimp_SoAParticles_h
+
+#include <chimp/accessors.h>
+
+#include <xylose/Vector.h>
+
+#include <iterator>
+#include <cstddef>
+
+namespace chimp {
+  using xylose::Vector;
+
+  class SoAParticles;
+
+  /** Particle proxy for chimp::SoAParticles.
+   *
+   * An SoAParticle is either <em>attached</em> to one element of the arrays
+   * of an SoAParticles instance (as obtained by dereferencing an
+   * SoAParticles::iterator) or it is a <em>detached</em> particle which
+   * carries its own values (as created by copying a particle or by default
+   * construction).  Copies are always detached, such that an SoAParticle can
+   * be used as a value type (e.g. for the products of an interaction), while
+   * assignment to an attached particle writes directly into the arrays.
+   *
+   * Use as the Particle type of chimp::make_options (via setParticle).
+   */
+  class SoAParticle {
+    /* MEMBER STORAGE */
+  private:
+    Vector<double,3u> * px;
+    Vector<double,3u> * pv;
+    int * ps;
+    float * pw;
+
+    /** Storage of a detached particle. */
+    Vector<double,3u> x_;
+    Vector<double,3u> v_;
+    int species_;
+    float weight_;
+
+
+    /* MEMBER FUNCTIONS */
+  public:
+    /** Constructor of a detached particle. */
+    SoAParticle( const Vector<double,3u> & x = 0.0,
+                 const Vector<double,3u> & v = 0.0,
+                 const int & species = 0,
+                 const float & weight = 1.0f )
+      : x_(x), v_(v), species_(species), weight_(weight) {
+      detach();
+    }
+
+    /** Copy constructor.  The copy is always detached. */
+    SoAParticle( const SoAParticle & that )
+      : x_( *that.px ), v_( *that.pv ),
+        species_( *that.ps ), weight_( *that.pw ) {
+      detach();
+    }
+
+    /** Assign the values of another particle (into the arrays if this
+     * particle is attached). */
+    SoAParticle & operator= ( const SoAParticle & that ) {
+      *px = *that.px;
+      *pv = *that.pv;
+      *ps = *that.ps;
+      *pw = *that.pw;
+      return *this;
+    }
+
+    /** Whether this particle refers to an element of an SoAParticles
+     * instance. */
+    bool isAttached() const { return px != &x_; }
+
+    Vector<double,3u> & x() const { return *px; }
+    Vector<double,3u> & v() const { return *pv; }
+    int & species() const { return *ps; }
+    float & weight() const { return *pw; }
+
+  private:
+    void detach() {
+      px = &x_;
+      pv = &v_;
+      ps = &species_;
+      pw = &weight_;
+    }
+
+    inline void attach( const SoAParticles & soa, const std::size_t & i );
+
+    friend class SoAParticles;
+  };
+
+
+  /** Non-owning view of particles that are stored in separate arrays.
+   *
+   * The simulation keeps ownership of the arrays; no particle data is copied
+   * when SoAParticles::iterator ranges are passed to interaction::Driver (e.g.
+   * as <code>xylose::IteratorRange< SoAParticles::iterator ></code> species
+   * ranges).  The weight array is optional:  if it is NULL, all particles have
+   * unit weight (and setWeight on attached particles has no lasting effect).
+   *
+   * Note that the iterator stores the proxy particle that it refers to, such
+   * that a reference obtained by dereferencing an iterator is only valid
+   * while that iterator exists and is not modified.
+   */
+  class SoAParticles {
+    /* TYPEDEFS */
+  public:
+    typedef SoAParticle value_type;
+    typedef SoAParticle & reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    class iterator;
+    typedef iterator const_iterator;
+
+
+    /* MEMBER STORAGE */
+  public:
+    Vector<double,3u> * x;
+    /** Velocities; may be passed directly to the batched
+     * model::Elastic::interactPairs and model::VSSElastic::interactPairs. */
+    Vector<double,3u> * v;
+    int * species;
+    float * weight;
+    std::size_t n;
+
+
+    /* MEMBER FUNCTIONS */
+  public:
+    SoAParticles( Vector<double,3u> * x,
+                  Vector<double,3u> * v,
+                  int * species,
+                  float * weight,
+                  const std::size_t & n )
+      : x(x), v(v), species(species), weight(weight), n(n) { }
+
+    std::size_t size() const { return n; }
+    bool empty() const { return n == 0u; }
+
+    inline iterator begin() const;
+    inline iterator end() const;
+
+    /** Random access iterator over the particles of an SoAParticles
+     * instance. */
+    class iterator {
+      /* TYPEDEFS */
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef SoAParticle value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef SoAParticle * pointer;
+      typedef SoAParticle & reference;
+
+
+      /* MEMBER STORAGE */
+    private:
+      const SoAParticles * soa;
+      difference_type i;
+      mutable SoAParticle proxy;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      iterator() : soa(0), i(0) { }
+
+      iterator( const SoAParticles & soa, const difference_type & i )
+        : soa(&soa), i(i) { }
+
+      /** Copying an iterator does not copy the particle it refers to. */
+      iterator( const iterator & that ) : soa(that.soa), i(that.i) { }
+
+      iterator & operator= ( const iterator & that ) {
+        soa = that.soa;
+        i = that.i;
+        return *this;
+      }
+
+      reference operator* () const {
+        proxy.attach( *soa, static_cast<std::size_t>(i) );
+        return proxy;
+      }
+
+      pointer operator-> () const { return &operator*(); }
+
+      /** Index of the particle in the arrays. */
+      const difference_type & index() const { return i; }
+
+      iterator & operator++ () { ++i; return *this; }
+      iterator & operator-- () { --i; return *this; }
+      iterator operator++ (int) { iterator r(*this); ++i; return r; }
+      iterator operator-- (int) { iterator r(*this); --i; return r; }
+      iterator & operator+= ( const difference_type & d ) {
+        i += d;
+        return *this;
+      }
+      iterator & operator-= ( const difference_type & d ) {
+        i -= d;
+        return *this;
+      }
+      iterator operator+ ( const difference_type & d ) const {
+        return iterator( *soa, i + d );
+      }
+      iterator operator- ( const difference_type & d ) const {
+        return iterator( *soa, i - d );
+      }
+      difference_type operator- ( const iterator & that ) const {
+        return i - that.i;
+      }
+
+      bool operator== ( const iterator & that ) const { return i == that.i; }
+      bool operator!= ( const iterator & that ) const { return i != that.i; }
+      bool operator<  ( const iterator & that ) const { return i <  that.i; }
+      bool operator>  ( const iterator & that ) const { return i >  that.i; }
+      bool operator<= ( const iterator & that ) const { return i <= that.i; }
+      bool operator>= ( const iterator & that ) const { return i >= that.i; }
+    };
+  };
+
+
+  inline void SoAParticle::attach( const SoAParticles & soa,
+                                   const std::size_t & i ) {
+    px = soa.x + i;
+    pv = soa.v + i;
+    ps = soa.species + i;
+    weight_ = 1.0f;
+    pw = soa.weight ? soa.weight + i : &weight_;
+  }
+
+  inline SoAParticles::iterator SoAParticles::begin() const {
+    return iterator( *this, 0 );
+  }
+
+  inline SoAParticles::iterator SoAParticles::end() const {
+    return iterator( *this, static_cast<std::ptrdiff_t>(n) );
+  }
+
+
+  /* Accessor overloads (found by ADL) for chimp::SoAParticle.  See
+   * chimp::accessors::particle for the generic versions. */
+
+  inline Vector<double,3u> & velocity( SoAParticle & p ) {
+    return p.v();
+  }
+
+  inline const Vector<double,3u> & velocity( const SoAParticle & p ) {
+    return p.v();
+  }
+
+  template < typename Tv >
+  inline void setVelocity( SoAParticle & p, const Vector<Tv,3u> & v ) {
+    p.v() = v;
+  }
+
+  inline Vector<double,3u> & position( SoAParticle & p ) {
+    return p.x();
+  }
+
+  inline const Vector<double,3u> & position( const SoAParticle & p ) {
+    return p.x();
+  }
+
+  template < typename Tx >
+  inline void setPosition( SoAParticle & p, const Vector<Tx,3u> & x ) {
+    p.x() = x;
+  }
+
+  inline int & species( SoAParticle & p ) {
+    return p.species();
+  }
+
+  inline const int & species( const SoAParticle & p ) {
+    return p.species();
+  }
+
+  template < typename Ts >
+  inline void setSpecies( SoAParticle & p, const Ts & s ) {
+    p.species() = s;
+  }
+
+  inline float & weight( SoAParticle & p ) {
+    return p.weight();
+  }
+
+  inline const float & weight( const SoAParticle & p ) {
+    return p.weight();
+  }
+
+  template < typename Tw >
+  inline void setWeight( SoAParticle & p, const Tw & w ) {
+    p.weight() = w;
+  }
+
+}/* namespace chimp */
+
+#endif // chimp_SoAParticles_h
@@ -23,7 +23,8 @@
 
 /** \file
  * Declaration of generic particle accessor functions such as velocity,
- * position, and species.
+ * position, and species, and of generic cell accessor functions such as
+ * temperature.
  */
 
 #ifndef chimp_accessors_h
@@ -121,6 +122,24 @@ namespace chimp {
       }
 
     } /* namespace chimp::accessors::particle */
+
+
+    /** Argument-Dependent-Lookup (ADL) selectable functions for accessing
+     * properties of the cells (CellInfo/CrossSpeciesInfo classes) that are
+     * passed to the collision drivers. */
+    namespace cell {
+
+      /** Generic accessor for the temperature of a cell.  Since a generic
+       * cell does not track a temperature, this returns zero (unknown).
+       * Cell classes that do track a temperature should provide an overload
+       * <code>double temperature( const CellT & )</code> in their own
+       * namespace. */
+      template < typename CellT >
+      inline double temperature( const CellT & /* cell */ ) {
+        return 0.0;
+      }
+
+    } /* namespace chimp::accessors::cell */
   } /* namespace chimp::accessors */
 } /* namespace chimp */
 
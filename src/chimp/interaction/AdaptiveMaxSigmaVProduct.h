@@ -0,0 +1,220 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Persistent, self-adjusting generator and updater of (sigma*v)_max for the
+ * chimp::interaction::Driver class.
+ */
+
+#ifndef chimp_interaction_AdaptiveMaxSigmaVProduct_h
+#define chimp_interaction_AdaptiveMaxSigmaVProduct_h
+
+#include <chimp/interaction/Driver.h>
+#include <chimp/interaction/v_rel_fnc.h>
+#include <chimp/accessors.h>
+
+#include <vector>
+#include <algorithm>
+
+namespace chimp {
+  namespace interaction {
+
+    /** Per-cell storage of (sigma*v)_max for each pair of species as used by
+     * AdaptiveMaxSigmaVProduct.  Entries are created (unseeded) on demand,
+     * such that the number of species does not need to be known beforehand.
+     */
+    struct MaxSigmaVCache {
+      /* TYPEDEFS */
+      /** Cached data of a single pair of species. */
+      struct Entry {
+        /** The current value of (sigma*v)_max (zero if not yet seeded). */
+        double m_s_v;
+
+        /** The largest sigma*v observed since the last adjustment. */
+        double max_sigma_relspeed;
+
+        /** The number of pairs tested since the last adjustment. */
+        unsigned int number_tests;
+
+        /** The number of pairs accepted since the last adjustment. */
+        unsigned int number_accepted;
+
+        Entry()
+          : m_s_v( 0.0 ), max_sigma_relspeed( 0.0 ),
+            number_tests( 0u ), number_accepted( 0u ) { }
+
+        /** Forget the accumulated statistics. */
+        void resetStats() {
+          max_sigma_relspeed = 0.0;
+          number_tests = number_accepted = 0u;
+        }
+      };
+
+
+      /* MEMBER STORAGE */
+      /** Entries of the upper triangle, packed by column. */
+      std::vector<Entry> entries;
+
+
+      /* MEMBER FUNCTIONS */
+      /** Obtain the entry for species A and B (A and B may be swapped). */
+      Entry & operator() ( unsigned int A, unsigned int B ) {
+        if ( A > B )
+          std::swap( A, B );
+
+        const std::size_t i = std::size_t(B) * (B + 1u) / 2u + A;
+        if ( i >= entries.size() )
+          entries.resize( i + 1u );
+        return entries[i];
+      }
+
+      /** Forget all cached values (e.g. after a large change of the cell
+       * contents). */
+      void clear() { entries.clear(); }
+    };
+
+
+    /** Persistent, self-adjusting generator and updater of
+     * \f$ \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} \f$ for the
+     * chimp::interaction::Driver class.
+     *
+     * Instead of searching the cross section data for each pair of species of
+     * each cell on every step (as DefaultMaxSigmaVProduct does), the value of
+     * (sigma*v)_max is kept in the cell between time steps:
+     *  - The value is seeded once by a search of the cross section data up to
+     *    the thermal estimate of the maximum relative speed (see
+     *    estMaxVFromT) at the temperature of the cell (see
+     *    chimp::accessors::cell::temperature), or at seed_temperature if the
+     *    cell does not provide a temperature.  If neither is known, the
+     *    search goes up to CrossSpeciesInfo::maxRelativeVelocity(A,B).
+     *  - The value is raised to the largest sigma*v that is observed in the
+     *    collision tests (the number of tests of the current step has already
+     *    been determined, so the new value applies to the next step).
+     *  - Once at least min_samples tests have been collected, the value is
+     *    decreased by decay_factor (but not below the largest sigma*v observed
+     *    during those tests) if the fraction of accepted tests is below
+     *    min_accept_ratio.
+     *  .
+     *
+     * Requirements:  In addition to the requirements of
+     * DefaultMaxSigmaVProduct, the CrossSpeciesInfo class must provide
+     * <code>MaxSigmaVCache & maxSigmaVCache()</code>.
+     */
+    struct AdaptiveMaxSigmaVProduct {
+      /* MEMBER STORAGE */
+      /** Multiplicative factor by which (sigma*v)_max is decreased when too
+       * few tests are accepted.  [Default:  0.9] */
+      double decay_factor;
+
+      /** Fraction of accepted tests below which (sigma*v)_max is decreased.
+       * [Default:  0.05] */
+      double min_accept_ratio;
+
+      /** Number of tests to collect before the accepted fraction is evaluated.
+       * [Default:  100] */
+      unsigned int min_samples;
+
+      /** Temperature (in K) of the thermal estimate of the maximum relative
+       * speed with which the cache is seeded for cells that do not provide a
+       * temperature of their own (see chimp::accessors::cell::temperature).
+       * If neither is positive, CrossSpeciesInfo::maxRelativeVelocity(A,B)
+       * is used instead.  [Default:  0] */
+      double seed_temperature;
+
+
+      /* MEMBER FUNCTIONS */
+      AdaptiveMaxSigmaVProduct( const double & decay_factor = 0.9,
+                                const double & min_accept_ratio = 0.05,
+                                const unsigned int & min_samples = 100u,
+                                const double & seed_temperature = 0.0 )
+        : decay_factor( decay_factor ),
+          min_accept_ratio( min_accept_ratio ),
+          min_samples( min_samples ),
+          seed_temperature( seed_temperature ) { }
+
+      /** Obtain the cached value of
+       * \f$ \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} \f$, seeding
+       * it if necessary.
+       */
+      template < typename ChimpDBInteractionSet,
+                 typename CrossSpeciesInfo >
+      double get( const ChimpDBInteractionSet & eqset,
+                  CrossSpeciesInfo & info,
+                  const int & A,
+                  const int & B ) const {
+        MaxSigmaVCache::Entry & e = info.maxSigmaVCache()(A,B);
+        if ( e.m_s_v <= 0.0 ) {
+          using chimp::accessors::cell::temperature;
+          const double T_cell = temperature( info );
+          const double T = T_cell > 0.0 ? T_cell : seed_temperature;
+
+          /* all equations of the set share the reduced mass of the inputs. */
+          const double v_max =
+            ( T > 0.0 && !eqset.rhs.empty() )
+            ? estMaxVFromT( T, eqset.rhs.front().reducedMass.value )
+            : info.maxRelativeVelocity(A,B);
+          e.m_s_v = eqset.findMaxSigmaVProduct( v_max );
+          e.resetStats();
+        }
+        return e.m_s_v;
+      }
+
+      /** Raise or decay the cached value of
+       * \f$ \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} \f$ according
+       * to the statistics of the collision tests just performed.
+       */
+      template < typename ChimpDBInteractionSet,
+                 typename CrossSpeciesInfo >
+      void update( const ChimpDBInteractionSet & /* eqset */,
+                   CrossSpeciesInfo & info,
+                   const int & A,
+                   const int & B,
+                   const MaxSigmaVStats & stats ) const {
+        MaxSigmaVCache::Entry & e = info.maxSigmaVCache()(A,B);
+
+        if ( stats.max_sigma_relspeed > e.m_s_v ) {
+          /* the acceptance probability was clipped:  upgrade. */
+          e.m_s_v = stats.max_sigma_relspeed;
+          e.resetStats();
+          return;
+        }
+
+        e.number_tests    += stats.number_tests;
+        e.number_accepted += stats.number_accepted;
+        e.max_sigma_relspeed =
+          std::max( e.max_sigma_relspeed, stats.max_sigma_relspeed );
+
+        if ( e.number_tests < min_samples )
+          return;
+
+        if ( e.number_accepted < min_accept_ratio * e.number_tests )
+          e.m_s_v = std::max( e.m_s_v * decay_factor, e.max_sigma_relspeed );
+
+        e.resetStats();
+      }
+    };
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_AdaptiveMaxSigmaVProduct_h
@@ -0,0 +1,184 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Packed per-pair record of the data that is needed to test and execute the
+ * interactions of a Set.
+ * */
+
+#ifndef chimp_interaction_CollisionRecord_h
+#define chimp_interaction_CollisionRecord_h
+
+#include <chimp/interaction/Equation.h>
+#include <chimp/interaction/detail/VariantDispatch.h>
+
+#include <new>
+#include <cstddef>
+#include <algorithm>
+
+namespace chimp {
+  namespace interaction {
+
+    /** Hot data of one output channel (Equation) of a Set.  On LP64 systems,
+     * a channel is smaller than one 64-byte cache line. */
+    template < typename options >
+    struct CollisionChannel {
+      /* TYPEDEFS */
+      typedef detail::CrossSectionVariant<options> CrossSection;
+      typedef detail::ModelVariant<options> Model;
+
+
+      /* MEMBER STORAGE */
+      /** The cross section.  This is only tagged with its concrete type if
+       * options::variant_dispatch is true. */
+      CrossSection cs;
+
+      /** The interaction model.  This is only tagged with its concrete type
+       * if options::variant_dispatch is true. */
+      Model interaction;
+
+      /** The relative speed below which the cross section is exactly zero
+       * (zero if not known). */
+      double threshold_v;
+
+      /** The species of the first input (Equation::A) of the equation, which
+       * determines the order of the particles passed to the model. */
+      int species_A;
+
+
+      /* MEMBER FUNCTIONS */
+      /** Constructor extracts the hot data of the given equation. */
+      CollisionChannel( const Equation<options> & eq )
+        : cs( eq.cs.get() ),
+          interaction( eq.interaction.get() ),
+          threshold_v( cs.thresholdVelocity() ),
+          species_A( eq.A.species ) {
+        if ( !options::variant_dispatch ) {
+          cs.kind = CrossSection::VIRTUAL;
+          interaction.kind = Model::VIRTUAL;
+        }
+      }
+
+      /** Evaluate the cross section at the given relative speed. */
+      inline double crossSection( const double & v_relative ) const {
+        if ( v_relative < threshold_v )
+          return 0.0;
+        return cs( v_relative );
+      }
+    };
+
+
+    /** Packed, cache-line aligned array of the CollisionChannel of each
+     * equation of a Set.  The record refers to (but does not own) the cross
+     * sections and models of the equations and thus must be rebuilt when any
+     * of these are replaced.
+     */
+    template < typename options >
+    class CollisionRecord {
+      /* TYPEDEFS */
+    public:
+      typedef CollisionChannel<options> Channel;
+      typedef const Channel * const_iterator;
+
+      /** Alignment of the channel array. */
+      static const std::size_t cache_line = 64u;
+
+
+      /* MEMBER STORAGE */
+    private:
+      /** The (aligned) array of channels within raw. */
+      Channel * channels;
+
+      /** The number of channels. */
+      unsigned int n;
+
+      /** The allocated storage. */
+      void * raw;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** Constructor creates an empty record. */
+      CollisionRecord() : channels( NULL ), n( 0u ), raw( NULL ) { }
+
+      /** Constructor creates the record of the given list of equations. */
+      CollisionRecord( const typename Equation<options>::list & eqs )
+        : channels( NULL ), n( 0u ), raw( NULL ) {
+        allocate( eqs.size() );
+        for ( ; n < eqs.size(); ++n )
+          new ( channels + n ) Channel( eqs[n] );
+      }
+
+      CollisionRecord( const CollisionRecord & that )
+        : channels( NULL ), n( 0u ), raw( NULL ) {
+        allocate( that.n );
+        for ( ; n < that.n; ++n )
+          new ( channels + n ) Channel( that.channels[n] );
+      }
+
+      ~CollisionRecord() {
+        /* Channel is trivially destructible. */
+        ::operator delete( raw );
+      }
+
+      CollisionRecord & operator= ( const CollisionRecord & that ) {
+        CollisionRecord tmp( that );
+        swap( tmp );
+        return *this;
+      }
+
+      void swap( CollisionRecord & that ) {
+        std::swap( channels, that.channels );
+        std::swap( n, that.n );
+        std::swap( raw, that.raw );
+      }
+
+      /** The number of channels. */
+      unsigned int size() const { return n; }
+
+      const Channel & operator[] ( const unsigned int & j ) const {
+        return channels[j];
+      }
+
+      const_iterator begin() const { return channels; }
+      const_iterator end() const { return channels + n; }
+
+    private:
+      void allocate( const std::size_t & count ) {
+        if ( count == 0u )
+          return;
+
+        raw = ::operator new( count * sizeof(Channel) + cache_line - 1u );
+        const std::size_t addr = reinterpret_cast<std::size_t>( raw );
+        channels = reinterpret_cast<Channel *>(
+          ( addr + cache_line - 1u ) & ~( cache_line - 1u )
+        );
+      }
+    };
+
+    template < typename options >
+    const std::size_t CollisionRecord<options>::cache_line;
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_CollisionRecord_h
@@ -31,18 +31,44 @@
 #include <chimp/interaction/selectRandomPair.h>
 #include <chimp/interaction/detail/DriverRetval.h>
 #include <chimp/accessors.h>
+#include <chimp/random/Philox.h>
 
 #include <xylose/Vector.h>
 #include <xylose/IteratorRange.h>
-#include <xylose/upper_triangle.h>
+#include <xylose/logger.h>
 #include <xylose/compat/math.hpp>
 
 #include <iterator>
+#include <algorithm>
+#include <vector>
 #include <set>
 
 namespace chimp {
   namespace interaction {
 
+    /** Statistics of the collision tests of one pair of species (within one
+     * cell and one time step) that are passed to
+     * <code>MaxSigmaVProduct::update</code> by the
+     * chimp::interaction::Driver class.
+     */
+    struct MaxSigmaVStats {
+      /** The value of (sigma*v)_max that was used for the tests. */
+      double m_s_v;
+
+      /** The largest (total) sigma*v of all tested pairs. */
+      double max_sigma_relspeed;
+
+      /** The number of pairs that were tested. */
+      unsigned int number_tests;
+
+      /** The number of tested pairs that were accepted (interacted). */
+      unsigned int number_accepted;
+
+      MaxSigmaVStats( const double & m_s_v = 0.0 )
+        : m_s_v( m_s_v ), max_sigma_relspeed( 0.0 ),
+          number_tests( 0u ), number_accepted( 0u ) { }
+    };
+
     /** Default generator and updater of
      * \f$ \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} \f$ for the
      * chimp::interaction::Driver class.
@@ -52,6 +78,9 @@ namespace chimp {
      * parameters) and returns the maximum relative velocity of species A and B.
      * This value as provided by the CrossSpeciesInfo class can be from a
      * tracked quantity, an estimated quantity, or whatever.
+     *
+     * @see AdaptiveMaxSigmaVProduct for a policy that keeps (sigma*v)_max
+     * between time steps.
      */
     struct DefaultMaxSigmaVProduct {
 
@@ -61,23 +90,101 @@ namespace chimp {
       template < typename ChimpDBInteractionSet,
                  typename CrossSpeciesInfo >
       double get( const ChimpDBInteractionSet & eqset,
-                  const CrossSpeciesInfo & info,
+                  CrossSpeciesInfo & info,
                   const int & A,
                   const int & B ) const {
         return eqset.findMaxSigmaVProduct( info.maxRelativeVelocity(A,B) );
       }
 
       /** Updates the maximum value of 
-       * \f$ \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} \f$.
+       * \f$ \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} \f$
+       * after the collision tests of species A and B are finished.
        * This implemenation does nothing.
        */
-      template < typename ChimpDB,
+      template < typename ChimpDBInteractionSet,
                  typename CrossSpeciesInfo >
-      void update( const ChimpDB & db,
-                   const CrossSpeciesInfo & info,
+      void update( const ChimpDBInteractionSet & eqset,
+                   CrossSpeciesInfo & info,
                    const int & A,
                    const int & B,
-                   const double & m_s_v ) const { }
+                   const MaxSigmaVStats & stats ) const { }
+    };
+
+    /** Default (uniform weight) no-time-counter weighting policy for the
+     * chimp::interaction::Driver class.
+     *
+     * This implementation assumes that all particles of a species share the
+     * same weight and uses the weight of the first particle of each species
+     * range.
+     *
+     * @see VariableWeightNTC for variable per-particle weights.
+     */
+    struct UniformWeightNTC {
+
+      /** Calculate the weight factor W of the number of collision tests:
+       * \f$ N_{\rm test} = W N_a N_b \Delta t
+       *    \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} / V \f$.
+       * For species weights Fa and Fb, this is W = Fa Fb / min(Fa,Fb).
+       */
+      template < typename SpeciesRange >
+      double weightFactor( const SpeciesRange & aRange,
+                           const SpeciesRange & bRange ) const {
+        if ( aRange.size() == 0u || bRange.size() == 0u )
+          return 0.0;
+
+        using chimp::accessors::particle::weight;
+        const double wA = weight(*aRange.begin()),
+                     wB = weight(*bRange.begin());
+        return wA * wB / std::min( wA, wB );
+      }
+
+      /** Test (and possibly execute) an interaction of the given pair.  The
+       * total sigma*v of the pair is returned in sigma_relspeed. */
+      template < typename ChimpDBInteractionSet,
+                 typename PIter,
+                 typename BackInsertionSequence,
+                 typename RNG >
+      std::pair<int,double>
+      interact( const ChimpDBInteractionSet & eqset,
+                const double & m_s_v,
+                const double & /* weight_factor */,
+                const std::pair<PIter, PIter> & pair,
+                BackInsertionSequence & result_list,
+                RNG & rng,
+                double & sigma_relspeed ) const {
+        return eqset.interact( m_s_v, pair, result_list, rng, sigma_relspeed );
+      }
+    };
+
+    /** Default sub-cycling policy for the chimp::interaction::Driver class:
+     * every pair of species is tested once per time step.
+     *
+     * @see FixedSubCycling and AutoSubCycling for policies that split the
+     * time step of fast pairs (e.g. electron-neutral) into several sub-cycles.
+     */
+    struct NoSubCycling {
+      /** Return the number of sub-cycles into which the time step of species
+       * A and B is divided.
+       *
+       * @param number_tests
+       *    The number of collision tests of the whole time step (before the
+       *    remaining fraction is promoted).
+       * @param nA
+       *    The number of particles of species A.
+       * @param nB
+       *    The number of particles of species B.
+       */
+      template < typename ChimpDBInteractionSet,
+                 typename CrossSpeciesInfo >
+      unsigned int get( const ChimpDBInteractionSet & eqset,
+                        CrossSpeciesInfo & info,
+                        const int & A,
+                        const int & B,
+                        const double & number_tests,
+                        const std::size_t & nA,
+                        const std::size_t & nB ) const {
+        return 1u;
+      }
     };
 
     /** The default collision monitor does nothing. */
@@ -91,6 +198,10 @@ namespace chimp {
                          const BackInsertionSequence & result_list ) const { }
 
       void pairtests( const double & number_of_pairtests ) const { }
+
+      /** Merge the data of another monitor into this one (used by
+       * ParallelDriver to aggregate the per-cell monitors). */
+      void merge( const NullMonitor & ) const { }
     };
 
 
@@ -99,16 +210,54 @@ namespace chimp {
      * will likely want to use this class as a template.  Your own version may
      * need to be tuned and molded to suit the rest of the mechanics of your
      * simulation software in order to get the best performance.
+     *
+     * Only the pairs of species that are listed as partners in
+     * <code>ChimpDB::getInteractions()</code> (see
+     * interaction::SparseInteractionTable) and that both have particles in the
+     * cell are visited.
+     *
+     * @tparam Monitor
+     *    Collision monitor.  [Default:  NullMonitor]
+     * @tparam MaxSigmaVProduct
+     *    Generator/updater of (sigma*v)_max.
+     *    [Default:  DefaultMaxSigmaVProduct]
+     * @tparam WeightPolicy
+     *    No-time-counter weighting policy.  Use VariableWeightNTC to support
+     *    variable per-particle weights.  [Default:  UniformWeightNTC]
+     * @tparam SubCyclePolicy
+     *    Number of sub-cycles of the time step per pair of species.  The
+     *    sub-cycles of all pairs are interleaved:  sub-cycle s of every pair
+     *    that has more than s sub-cycles is executed before sub-cycle s+1 of
+     *    any pair.  Each sub-cycle after the first re-estimates the weight
+     *    factor, (sigma*v)_max, and the number of collision tests from the
+     *    populations left by the previous sub-cycle of all pairs, such that
+     *    fast pairs collide at their own cadence without forcing all other
+     *    pairs to do the same.  [Default:  NoSubCycling]
      */
     template < typename Monitor = NullMonitor,
-               typename MaxSigmaVProduct = DefaultMaxSigmaVProduct >
+               typename MaxSigmaVProduct = DefaultMaxSigmaVProduct,
+               typename WeightPolicy = UniformWeightNTC,
+               typename SubCyclePolicy = NoSubCycling >
     struct Driver {
       /* TYPEDEFS */
     private:
       /** Information to start the collisions per pair type. */
       struct CollisionTestData {
+        unsigned int A, B;
+        /** Index of the interaction set of A and B within the table. */
+        unsigned int index;
         double number_tests;
         double m_s_v;
+        double weight_factor;
+        unsigned int n_sub;
+        /** Statistics of the tests of all sub-cycles of A and B. */
+        MaxSigmaVStats stats;
+
+        CollisionTestData( const unsigned int & A,
+                           const unsigned int & B,
+                           const unsigned int & index )
+          : A( A ), B( B ), index( index ), number_tests( 0.0 ),
+            m_s_v( 0.0 ), weight_factor( 0.0 ), n_sub( 1u ) { }
       };
 
 
@@ -116,6 +265,12 @@ namespace chimp {
     public:
       Monitor & monitor;
 
+      /** Generator/updater of (sigma*v)_max. */
+      MaxSigmaVProduct maxSigmaVProduct;
+
+      /** Number of sub-cycles of the time step per pair of species. */
+      SubCyclePolicy subCycling;
+
 
       /* STATIC STORAGE */
     public:
@@ -124,9 +279,13 @@ namespace chimp {
 
       /* MEMBER FUNCTIONS */
     public:
-      /** Constructor initializes the collisions monitor.  */
-      Driver( Monitor & monitor = Driver::global_monitor )
-        : monitor( monitor ) { }
+      /** Constructor initializes the collisions monitor, the (sigma*v)_max
+       * generator/updater, and the sub-cycling policy.  */
+      Driver( Monitor & monitor = Driver::global_monitor,
+              const MaxSigmaVProduct & maxSigmaVProduct = MaxSigmaVProduct(),
+              const SubCyclePolicy & subCycling = SubCyclePolicy() )
+        : monitor( monitor ), maxSigmaVProduct( maxSigmaVProduct ),
+          subCycling( subCycling ) { }
 
       /** Collision driver interface that MUST ONLY be used with
        * ChimpDB::inplace_interactions == false.
@@ -163,59 +322,76 @@ namespace chimp {
 
         typedef typename CellInfo::SpeciesRange SpeciesRange;
         typedef typename SpeciesRange::iterator PIter;
-        MaxSigmaVProduct maxSigmaVProduct;
+        typedef typename ChimpDB::InteractionTable InteractionTable;
+        typedef typename InteractionTable::Partner Partner;
+        typedef typename InteractionTable::PartnerList PartnerList;
+        typedef typename PartnerList::const_iterator PartnerIter;
+        WeightPolicy weighting;
 
 
         const unsigned int n_species =
           std::min( cell.getNumberOfSpecies(), db.getProps().size() );
 
-        xylose::upper_triangle<CollisionTestData> ctData(n_species);
+        const InteractionTable & table = db.getInteractions();
+
+        /* only the pairs of species that can interact and that both have
+         * particles in this cell are tested. */
+        std::vector<CollisionTestData> ctData;
+        unsigned int n_sub_max = 1u;
+
+        /* For generators that are keyed by pair (e.g. chimp::random::Philox),
+         * the estimates and each collision test use their own pair stream.
+         * The (cell, step) part of the counter is left to the caller, and the
+         * pair streams continue from one call to the next so that a generator
+         * that is shared by several cells or steps never repeats itself.
+         * Other generators are unaffected.
+         */
+        random::nextPair( rng );
 
         /* before we modify any ranges, calculate the estimate for the number of
          * collisions to test. */
         for ( unsigned int A = 0u; A < n_species; ++A ) {
           SpeciesRange & aRange = cell.getSpecies(A);
-          for ( unsigned int B = A; B < n_species; ++B ) {
+          if ( aRange.size() == 0u )
+            continue;
+
+          const PartnerList & partners = table.partners(A);
+          for ( PartnerIter p = std::lower_bound( partners.begin(),
+                                                  partners.end(),
+                                                  Partner(A) ),
+                          pend = partners.end();
+                p != pend && p->species < n_species; ++p ) {
+            const unsigned int B = p->species;
             SpeciesRange & bRange = cell.getSpecies(B);
+            if ( bRange.size() == 0u )
+              continue;
 
-            CollisionTestData & ctd = ctData(A,B);
-            const typename ChimpDB::Set & eqset = db(A,B);
+            const typename ChimpDB::Set & eqset = table[p->index];
 
             if (eqset.rhs.size() == 0)
               /* no interactions for these inputs. */
               continue;
 
-            ctd.m_s_v = maxSigmaVProduct.get( eqset, cell, A,B );
+            ctData.push_back( CollisionTestData( A, B, p->index ) );
+            CollisionTestData & ctd = ctData.back();
 
-            /* Start by determining the number of collisions to use.
-             * N_test = Fa Fb Na Nb dt MAX(s v) / ( 2 V min(Fa,Fb) )
-             */
-            {/* FIXME:  support variable weights per particles.
-              * Implement Schmidt and Rutlands variable weight NTC. */
-              using chimp::accessors::particle::weight;
-              register double wA = weight(*aRange.begin()),
-                              wB = weight(*bRange.begin());
+            ctd.m_s_v = maxSigmaVProduct.get( eqset, cell, A,B );
+            ctd.stats.m_s_v = ctd.m_s_v;
 
-              ctd.number_tests =
-                 wA * wB * aRange.size() * bRange.size() * dt * ctd.m_s_v
-                / ( cell.volume() * std::min( wA, wB ) )
-              ;
-
-              if ( A == B )
-                /* For identical species, we have to divide by two because of
-                 * symmetry in the summation of number of collisions.  See
-                 * Schmidt and Rutland, J. Comp. Phys. 164, 62-80, 2000.
-                 */
-                ctd.number_tests *= 0.5;
-            }
+            /* Start by determining the number of collisions to use. */
+            ctd.weight_factor = weighting.weightFactor( aRange, bRange );
+            ctd.number_tests =
+              numberOfTests( ctd, dt, aRange, bRange, cell.volume(), A == B );
 
-            {/* Promote the remaining selection probablity to either 0 or 1 */
-              register double number_of__fraction =
-                ctd.number_tests - std::floor(ctd.number_tests);
+            /* The first sub-cycle is estimated here with the rest; later
+             * sub-cycles are estimated just before they are executed. */
+            ctd.n_sub = std::max( 1u,
+              subCycling.get( eqset, cell, A, B, ctd.number_tests,
+                              aRange.size(), bRange.size() ) );
+            ctd.number_tests /= ctd.n_sub;
+            n_sub_max = std::max( n_sub_max, ctd.n_sub );
 
-              if ( rng.rand() < number_of__fraction )
-                ctd.number_tests += 1.0;
-            }
+            promoteFraction( ctd.number_tests, rng );
 
             monitor.pairtests( ctd.number_tests );
           }/* for */
@@ -226,18 +402,38 @@ namespace chimp {
          * to test, we are ready to select pairs, test then, and allow them to
          * collide... */
 
-        for ( unsigned int A = 0u; A < n_species; ++A ) {
-          SpeciesRange & aRange = cell.getSpecies(A);
-
-          for ( unsigned int B = A; B < n_species; ++B ) {
-            const typename ChimpDB::Set & eqset = db(A,B);
-
-            if (eqset.rhs.size() == 0)
-              /* no interactions for these inputs. */
+        for ( unsigned int sub = 0u; sub < n_sub_max; ++sub ) {
+          for ( typename std::vector<CollisionTestData>::iterator
+                  ctd_i = ctData.begin(), ctd_end = ctData.end();
+                ctd_i != ctd_end; ++ctd_i ) {
+            CollisionTestData & ctd = *ctd_i;
+            if ( sub >= ctd.n_sub )
               continue;
 
+            const unsigned int A = ctd.A, B = ctd.B;
+            SpeciesRange & aRange = cell.getSpecies(A);
             SpeciesRange & bRange = cell.getSpecies(B);
-            CollisionTestData & ctd = ctData(A,B);
+            const typename ChimpDB::Set & eqset = table[ctd.index];
+
+            if ( sub > 0u ) {
+              /* the particles of A and B may have been changed by the
+               * previous sub-cycle of any pair.  (sigma*v)_max is not allowed
+               * to fall below the largest sigma*v already observed. */
+              ctd.m_s_v = std::max( maxSigmaVProduct.get( eqset, cell, A,B ),
+                                    ctd.stats.max_sigma_relspeed );
+              ctd.stats.m_s_v = ctd.m_s_v;
+              ctd.weight_factor = weighting.weightFactor( aRange, bRange );
+              ctd.number_tests =
+                numberOfTests( ctd, dt / ctd.n_sub, aRange, bRange,
+                               cell.volume(), A == B );
+
+              random::nextPair( rng );
+              promoteFraction( ctd.number_tests, rng );
+
+              monitor.pairtests( ctd.number_tests );
+            }
+
+            MaxSigmaVStats & stats = ctd.stats;
 
             while ( ctd.number_tests > 1.0 ) {
               typedef std::pair<PIter, PIter> CollisionPair;
@@ -251,19 +447,33 @@ namespace chimp {
                 break;
               }
 
+              random::nextPair( rng );
+
               using chimp::interaction::selectRandomPair;
               CollisionPair pair = selectRandomPair( aRange, bRange, rng );
 
               // Picks the correct output equation and uses it...
               const size_t result_list_sz_i = result_list.size();
+              double sigma_relspeed = 0.0;
               std::pair<int,double>
-                path = eqset.interact( ctd.m_s_v, pair, result_list, rng );
+                path = weighting.interact( eqset, ctd.m_s_v,
+                                           ctd.weight_factor,
+                                           pair, result_list, rng,
+                                           sigma_relspeed );
 
               monitor.interactions( db, pair, path, result_list );
 
+              ++stats.number_tests;
+              if ( path.first >= 0 )
+                ++stats.number_accepted;
+              if ( sigma_relspeed > stats.max_sigma_relspeed )
+                stats.max_sigma_relspeed = sigma_relspeed;
+
               /* we work with A completely and then B so that if A == B things
                * work still. */
-              detail::DriverRetval< ChimpDB::options::inplace_interactions >()(
+              typedef detail::DriverRetval<
+                ChimpDB::options::inplace_interactions > Retval;
+              Retval()(
                 path, pair,
                 result_list, result_list_sz_i, eq,
                 A, B, aRange, bRange
@@ -272,14 +482,63 @@ namespace chimp {
               /* one down, ... more to go. */
               ctd.number_tests -= 1.0;
             }/* while doing colllision tests */
-          }/* for */
-        }/* for */
+          }/* for each pair */
+        }/* for each sub-cycle */
+
+        for ( typename std::vector<CollisionTestData>::iterator
+                ctd_i = ctData.begin(), ctd_end = ctData.end();
+              ctd_i != ctd_end; ++ctd_i )
+          maxSigmaVProduct.update( table[ctd_i->index], cell,
+                                   ctd_i->A, ctd_i->B, ctd_i->stats );
       }/* operator() */
+
+    private:
+      /** Determine the number of collisions to test for the time dt.
+       * N_test = W Na Nb dt MAX(s v) / ( 2 V )
+       * where W = Fa Fb / min(Fa,Fb) for uniform species weights (see
+       * WeightPolicy).
+       */
+      template < typename SpeciesRange >
+      static double numberOfTests( const CollisionTestData & ctd,
+                                   const double & dt,
+                                   const SpeciesRange & aRange,
+                                   const SpeciesRange & bRange,
+                                   const double & volume,
+                                   const bool & same_species ) {
+        double number_tests =
+           ctd.weight_factor * aRange.size() * bRange.size()
+          * dt * ctd.m_s_v / volume
+        ;
+
+        if ( same_species )
+          /* For identical species, we have to divide by two because of
+           * symmetry in the summation of number of collisions.  See
+           * Schmidt and Rutland, J. Comp. Phys. 164, 62-80, 2000.
+           */
+          number_tests *= 0.5;
+
+        return number_tests;
+      }
+
+      /** Promote the remaining selection probablity to either 0 or 1 */
+      template < typename RNG >
+      static void promoteFraction( double & number_tests, RNG & rng ) {
+        register double number_of__fraction =
+          number_tests - std::floor(number_tests);
+
+        if ( rng.rand() < number_of__fraction )
+          number_tests += 1.0;
+      }
     };
 
 
-    template < typename Monitor, typename MaxSigmaVProduct>
-    Monitor Driver<Monitor, MaxSigmaVProduct>::global_monitor;
+    template < typename Monitor,
+               typename MaxSigmaVProduct,
+               typename WeightPolicy,
+               typename SubCyclePolicy >
+    Monitor
+    Driver<Monitor, MaxSigmaVProduct, WeightPolicy, SubCyclePolicy>
+      ::global_monitor;
 
   }/* namespace chimp::interaction */
 }/* namespace chimp */
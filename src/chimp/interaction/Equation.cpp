@@ -29,6 +29,7 @@
 #include <chimp/interaction/model/Elastic.h>
 #include <chimp/interaction/model/InElastic.h>
 #include <chimp/interaction/detail/sort_terms.h>
+#include <chimp/physical_calc.h>
 #include <chimp/property/name.h>
 
 
@@ -61,8 +62,21 @@ namespace chimp {
     template < typename RnDB >
     Equation<options>
     Equation<options>::load( const xml::Context & x, const RnDB & db ) {
+      Equation retval = parse( x, db );
+      retval.initialize();
+      return retval;
+    }
+
+
+    template < typename options >
+    template < typename RnDB >
+    Equation<options>
+    Equation<options>::parse( const xml::Context & x, const RnDB & db ) {
       using property::name;
 
+      /* all quantities are evaluated with the calculator of the database. */
+      CalcContext::Scope scope( db.calculator );
+
       typedef typename detail::makeSortedTermMap<RnDB>::type SortedElements;
       typedef typename SortedElements::iterator SEIter;
 
@@ -165,6 +179,55 @@ namespace chimp {
     }
 
 
+    template < typename options >
+    template < typename RnDB >
+    Equation<options>
+    Equation<options>::load( BinaryReader & in, const RnDB & db ) {
+      Equation retval;
+      retval.Input::operator=( Input::load(in) );
+
+      const unsigned int n_products = in.get<unsigned int>();
+      for ( unsigned int i = 0u; i < n_products; ++i )
+        retval.products.push_back( Term::load(in) );
+
+      /* cache the reduced mass */
+      retval.reducedMass = ReducedMass( retval, db );
+
+      /* the cross section must be loaded before the interaction model. */
+      retval.cs = db.loadCrossSection( in, retval );
+
+      {
+        std::string i_model;
+        in.read( i_model );
+
+        typedef typename RnDB::InteractionRegistry::const_iterator IRIter;
+        IRIter i = db.interaction_registry.find(i_model);
+
+        if ( i == db.interaction_registry.end() )
+          throw std::runtime_error(
+            "interaction model '" + i_model + "' not registered" );
+
+        retval.interaction.reset( i->second->new_load( in, retval, db ) );
+      }
+
+      return retval;
+    }
+
+
+    template < typename options >
+    void Equation<options>::save( BinaryWriter & out ) const {
+      Input::save( out );
+
+      out.write( static_cast<unsigned int>( products.size() ) );
+      for ( TermList::const_iterator i = products.begin(),
+                                   end = products.end(); i != end; ++i )
+        i->save( out );
+
+      cs->save( out );
+      interaction->save( out );
+    }
+
+
     template < typename options >
     inline const Term & Equation<options>::
     getTermForProduct( const unsigned int & i ) const {
@@ -136,10 +136,33 @@ namespace chimp {
                                    const RnDB & db );
 
       /** Attempt to load an equation from the (assumed) appropriate XML node in
-       * an XML document. */
+       * an XML document.  This is parse(x,db) followed by initialize().  */
       template < typename RnDB >
       static Equation load( const xml::Context & x, const RnDB & db );
 
+      /** Parse an equation from the (assumed) appropriate XML node in an XML
+       * document within the units calculator context of the database.  The
+       * cross section must still be initialized (see initialize()). */
+      template < typename RnDB >
+      static Equation parse( const xml::Context & x, const RnDB & db );
+
+      /** Complete the construction of an equation that was parsed by
+       * parse(x,db) (see cross_section::Base::initialize).  This does not use
+       * the units calculator and can thus be done concurrently for different
+       * equations. */
+      void initialize() { cs->initialize(); }
+
+      /** Load an equation (including cross section and interaction model) that
+       * was previously written to a binary cache by save(BinaryWriter&).
+       * @see RuntimeDB::RuntimeDB( const BinaryCache & )
+       */
+      template < typename RnDB >
+      static Equation load( BinaryReader & in, const RnDB & db );
+
+      /** Save the fully loaded equation (including cross section and
+       * interaction model) to a binary cache. */
+      void save( BinaryWriter & out ) const;
+
 
       /** Return whether the Equation represents and elastic collision.  Note that
        * currently, the only indication we have of whether something is elastic or
@@ -64,6 +64,18 @@ namespace chimp {
              const Term & B = Term() )
         : A(A), B(B) { }
 
+      /** Save the Input to a binary cache. */
+      void save( BinaryWriter & out ) const {
+        A.save( out );
+        B.save( out );
+      }
+
+      /** Load an Input from a binary cache. */
+      static Input load( BinaryReader & in ) {
+        const Term A = Term::load( in );
+        return Input( A, Term::load( in ) );
+      }
+
       /** The stream printer for the Equation Input class.
        * @param out
        *    The stream to which to print.
@@ -0,0 +1,357 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Monte Carlo Collision (MCC) driver for interactions of particles with a
+ * fixed background gas using the null-collision method.
+ */
+
+#ifndef chimp_interaction_MCCDriver_h
+#define chimp_interaction_MCCDriver_h
+
+#include <chimp/accessors.h>
+#include <chimp/property/mass.h>
+
+#include <xylose/Vector.h>
+#include <xylose/logger.h>
+#include <xylose/compat/math.hpp>
+
+#include <physical/physical.h>
+
+#include <vector>
+#include <cmath>
+
+namespace chimp {
+  namespace interaction {
+
+    /** A background gas species for chimp::interaction::MCCDriver. */
+    struct BackgroundGas {
+      /* MEMBER STORAGE */
+      /** The species index of the background gas (in the RuntimeDB). */
+      unsigned int species;
+
+      /** The temperature of the background gas. */
+      double temperature;
+
+      /** The mean (drift) velocity of the background gas. */
+      xylose::Vector<double,3u> drift;
+
+
+      /* MEMBER FUNCTIONS */
+      BackgroundGas( const unsigned int & species = 0u,
+                     const double & temperature = 0.0,
+                     const xylose::Vector<double,3u> & drift = 0.0 )
+        : species( species ), temperature( temperature ), drift( drift ) { }
+    };
+
+    /** Statistics of one call of MCCDriver. */
+    struct MCCStats {
+      /** The number of collision candidates (real plus null collisions). */
+      unsigned int number_candidates;
+
+      /** The number of real collisions. */
+      unsigned int number_collisions;
+
+      /** The number of candidates whose (total) sigma*v exceeded the
+       * \f$ \left( \sigma_{\rm T} v \right)_{\rm max} \f$ that was used for
+       * them (the bound was raised for all following candidates). */
+      unsigned int number_bound_exceeded;
+
+      /** The largest (total) sigma*v of all candidates. */
+      double max_sigma_relspeed;
+
+      MCCStats()
+        : number_candidates( 0u ), number_collisions( 0u ),
+          number_bound_exceeded( 0u ), max_sigma_relspeed( 0.0 ) { }
+    };
+
+    /** Driver class for Monte Carlo Collisions (MCC) of the particles of a
+     * cell with a fixed background gas (a density field rather than
+     * particles), using the null-collision method.
+     *
+     * For each species A of the cell, a constant total collision frequency
+     * \f$ \nu_{\rm max} = \sum_B n_B \left( \sigma_{\rm T} v \right)_{\rm max}
+     * \f$ is built from the interaction Set of (A,B) of the RuntimeDB for all
+     * background species B, where the maximum of \f$ \sigma_{\rm T} v \f$ is
+     * found (via Set::findMaxSigmaVProduct) up to
+     * <code>cell.maxRelativeVelocity(A,B)</code>.  Each particle of species A
+     * is then a collision candidate with probability
+     * \f$ P = 1 - \exp( -\nu_{\rm max} \Delta t ) \f$ (one random number per
+     * particle, which is also reused to choose the background species).  For
+     * each candidate, a background partner is sampled from the (drifting)
+     * Maxwellian of the background gas and Set::calculateOutPath is used to
+     * either reject the candidate as a null collision or select the
+     * interaction (a single evaluation of the cross sections per candidate).
+     * Accepted collisions are executed with Set::applyOutPath using the
+     * interaction models of the RuntimeDB.
+     *
+     * Since the background partner is drawn from an unbounded Maxwellian,
+     * \f$ \sigma_{\rm T} v \f$ of a candidate may exceed the maximum that
+     * was found up to <code>cell.maxRelativeVelocity(A,B)</code>, which would
+     * clip the acceptance probability.  In this case, the maximum is raised to
+     * \f$ \sigma_{\rm T} v \f$ of the candidate (and \f$ \nu_{\rm max} \f$
+     * and \f$ P \f$ are updated) for all following candidates, a warning is
+     * issued once per call, and the event is counted in
+     * MCCStats::number_bound_exceeded.  The rate is thus only biased for the
+     * candidates up to the one that exceeded the bound;
+     * <code>cell.maxRelativeVelocity(A,B)</code> should cover the tail of the
+     * background distribution to avoid this.
+     *
+     * The background partner is a copy of the test particle (hence it has the
+     * same position and weight) with the species and velocity of the
+     * background gas; it is discarded after the collision, as are all
+     * products that are of a background species.  All other products are
+     * appended to result_list.  For in-place interactions, the test particle
+     * is removed in the same way as chimp::interaction::Driver removes
+     * particles (by shortening the species range of the cell and inserting
+     * the iterator of the particle to delete into the erasure queue).
+     *
+     * CellInfo requirements (in addition to those of Driver, except for
+     * volume):
+     *  - <code>double backgroundDensity(const unsigned int & B)</code>
+     *    returns the density of background species B in the cell.
+     *  .
+     */
+    struct MCCDriver {
+      /* MEMBER STORAGE */
+      /** The background gas species. */
+      std::vector< BackgroundGas > background;
+
+
+      /* MEMBER FUNCTIONS */
+      /** Add a background gas species. */
+      void addBackground( const unsigned int & species,
+                          const double & temperature,
+                          const xylose::Vector<double,3u> & drift = 0.0 ) {
+        background.push_back( BackgroundGas( species, temperature, drift ) );
+      }
+
+      /** MCC interface that MUST ONLY be used with
+       * ChimpDB::inplace_interactions == false.
+       */
+      template < typename CellInfo,
+                 typename ChimpDB,
+                 typename BackInsertionSequence,
+                 typename RNG >
+      MCCStats operator() ( const double & dt,
+                            CellInfo & cell,
+                            const ChimpDB & db,
+                            BackInsertionSequence & result_list,
+                            RNG & rng ) const {
+        bool dummy = false;
+        return this->operator() ( dt, cell, db, result_list, dummy, rng );
+      }
+
+      /** MCC interface that can be used with any value of
+       * ChimpDB::inplace_interactions.  In the case that
+       * ChimpDB::inplace_interactions == false, the type and value of
+       * ErasureQueue is ignored.
+       */
+      template < typename CellInfo,
+                 typename ChimpDB,
+                 typename BackInsertionSequence,
+                 typename ErasureQueue,
+                 typename RNG >
+      MCCStats operator() ( const double & dt,
+                            CellInfo & cell,
+                            const ChimpDB & db,
+                            BackInsertionSequence & result_list,
+                            ErasureQueue & eq,
+                            RNG & rng ) const {
+        typedef typename CellInfo::SpeciesRange SpeciesRange;
+        typedef typename SpeciesRange::iterator PIter;
+        typedef typename ChimpDB::options::Particle Particle;
+        typedef typename ChimpDB::Set Set;
+        using chimp::accessors::particle::velocity;
+        using chimp::accessors::particle::setVelocity;
+        using chimp::accessors::particle::species;
+        using chimp::accessors::particle::setSpecies;
+
+        MCCStats stats;
+
+        const unsigned int n_species =
+          std::min( cell.getNumberOfSpecies(), db.getProps().size() );
+        const unsigned int n_bg = background.size();
+
+        std::vector<bool> is_background( db.getProps().size(), false );
+        for ( unsigned int b = 0u; b < n_bg; ++b )
+          if ( background[b].species < is_background.size() )
+            is_background[ background[b].species ] = true;
+
+        /* thermal speed of each background species. */
+        std::vector<double> v_th( n_bg, 0.0 );
+        for ( unsigned int b = 0u; b < n_bg; ++b ) {
+          using physical::constant::si::K_B;
+          v_th[b] = std::sqrt( K_B * background[b].temperature
+                               / db[ background[b].species ]
+                                   .property::mass::value );
+        }
+
+        std::vector<double> m_s_v( n_bg ), nu_cumulative( n_bg );
+        std::vector<Particle> products;
+
+        for ( unsigned int A = 0u; A < n_species; ++A ) {
+          SpeciesRange & range = cell.getSpecies(A);
+          if ( range.size() == 0u || is_background[A] )
+            continue;
+
+          /* the constant total collision frequency of species A. */
+          for ( unsigned int b = 0u; b < n_bg; ++b ) {
+            const unsigned int B = background[b].species;
+            const Set & eqset = db(A,B);
+            m_s_v[b] = 0.0;
+            if ( eqset.rhs.size() > 0u )
+              m_s_v[b] = eqset.findMaxSigmaVProduct(
+                           cell.maxRelativeVelocity(A,B) );
+          }
+
+          double nu_max = cumulate( cell, m_s_v, nu_cumulative );
+          if ( !( nu_max > 0.0 ) )
+            continue;
+
+          double P = 1.0 - std::exp( -nu_max * dt );
+
+          /* backwards, such that particles moved into the place of removed
+           * particles have already been processed. */
+          for ( unsigned int i = range.size(); i-- > 0u; ) {
+            const double u = rng.rand();
+            if ( u >= P )
+              continue;
+
+            ++stats.number_candidates;
+
+            /* reuse u to choose the background species. */
+            const double nu_u = ( u / P ) * nu_max;
+            unsigned int b = 0u;
+            while ( b + 1u < n_bg && nu_u >= nu_cumulative[b] )
+              ++b;
+            if ( !( m_s_v[b] > 0.0 ) )
+              continue;
+
+            const unsigned int B = background[b].species;
+            const Set & eqset = db(A,B);
+            const PIter p = range.begin() + i;
+
+            /* the background partner. */
+            Particle partner = *p;
+            setSpecies( partner, B );
+            setVelocity( partner, background[b].drift
+                                  + v_th[b] * gaussian( rng ) );
+
+            const double v_rel = ( velocity(*p) - velocity(partner) ).abs();
+            double sigma_relspeed = 0.0;
+            const std::pair<int,double> path =
+              eqset.calculateOutPath( m_s_v[b], v_rel, rng, sigma_relspeed );
+
+            if ( sigma_relspeed > stats.max_sigma_relspeed )
+              stats.max_sigma_relspeed = sigma_relspeed;
+
+            if ( sigma_relspeed > m_s_v[b] ) {
+              /* the acceptance of this candidate was clipped; raise the bound
+               * for all following candidates. */
+              if ( stats.number_bound_exceeded++ == 0u ) {
+                using xylose::logger::log_warning;
+                log_warning( "MCC:  sigma*v exceeds (sigma*v)_max of %d:%d; "
+                             "raising (sigma*v)_max (warning only issued once "
+                             "per call)", A, B );
+              }
+              m_s_v[b] = sigma_relspeed;
+              nu_max = cumulate( cell, m_s_v, nu_cumulative );
+              P = 1.0 - std::exp( -nu_max * dt );
+            }
+
+            if ( path.first < 0 )
+              continue; /* null collision */
+
+            ++stats.number_collisions;
+
+            products.clear();
+            eqset.applyOutPath( path, *p, partner, products, rng );
+
+            for ( typename std::vector<Particle>::const_iterator
+                    j = products.begin(), end = products.end();
+                  j != end; ++j )
+              if ( !is_background[ species(*j) ] )
+                result_list.push_back( *j );
+
+            if ( ChimpDB::options::inplace_interactions &&
+                 products.size() > 0u )
+              remove( range, p, eq );
+          }
+        }
+
+        return stats;
+      }
+
+    private:
+      /** Compute the cumulative collision frequencies (over the background
+       * species) of the given maxima of sigma*v.
+       * @return The total collision frequency \f$ \nu_{\rm max} \f$.
+       */
+      template < typename CellInfo >
+      double cumulate( CellInfo & cell,
+                       const std::vector<double> & m_s_v,
+                       std::vector<double> & nu_cumulative ) const {
+        double nu = 0.0;
+        for ( unsigned int b = 0u; b < background.size(); ++b ) {
+          nu += cell.backgroundDensity( background[b].species ) * m_s_v[b];
+          nu_cumulative[b] = nu;
+        }
+        return nu;
+      }
+
+      /** Remove the particle p from the range (see DriverRetval). */
+      template < typename SpeciesRange,
+                 typename PIter,
+                 typename ErasureQueue >
+      static void remove( SpeciesRange & range,
+                          const PIter & p,
+                          ErasureQueue & eq ) {
+        const PIter last = range.end() - 1;
+        if ( p != last )
+          *p = *last;
+        eq.insert( last );
+        range = SpeciesRange( range.begin(), last );
+      }
+
+      /** The erasure queue is ignored for out-of-place interactions. */
+      template < typename SpeciesRange,
+                 typename PIter >
+      static void remove( SpeciesRange &, const PIter &, bool & ) { }
+
+      /** A vector of three normally distributed random numbers (Box-Muller).
+       */
+      template < typename RNG >
+      static xylose::Vector<double,3u> gaussian( RNG & rng ) {
+        const double r0 = std::sqrt( -2.0 * std::log( 1.0 - rng.randExc() ) );
+        const double r1 = std::sqrt( -2.0 * std::log( 1.0 - rng.randExc() ) );
+        const double phi0 = 2.0 * M_PI * rng.rand();
+        const double phi1 = 2.0 * M_PI * rng.rand();
+        return xylose::V3( r0 * std::cos( phi0 ),
+                           r0 * std::sin( phi0 ),
+                           r1 * std::cos( phi1 ) );
+      }
+    };
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_MCCDriver_h
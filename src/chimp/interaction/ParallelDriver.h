@@ -0,0 +1,356 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Multi-cell (threaded) driver for performing all interactions necessary for
+ * a range of cells.
+ */
+
+#ifndef chimp_interaction_ParallelDriver_h
+#define chimp_interaction_ParallelDriver_h
+
+#include <chimp/interaction/Driver.h>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+namespace chimp {
+  namespace interaction {
+
+    /** Default per-cell random number generator streams for the
+     * chimp::interaction::ParallelDriver class.
+     *
+     * Each cell is given its own generator, seeded from a hash of (seed, step,
+     * cell index).  The stream of random numbers used for a cell is thus
+     * independent of which thread executes the cell and of the number of
+     * threads used.  nextStep() should be called once per time step such
+     * that subsequent steps do not reuse the same streams.
+     *
+     * @tparam RNG
+     *    The type of random number generator.  RNG must be default
+     *    constructible and must provide a seed(unsigned int) member function.
+     */
+    template < typename RNG >
+    struct SeededRNGStreams {
+      /* TYPEDEFS */
+      typedef RNG result_type;
+
+
+      /* MEMBER STORAGE */
+      /** The base seed of all streams. */
+      unsigned int seed;
+
+      /** The current time step (mixed into the seed of each stream). */
+      unsigned int step;
+
+
+      /* MEMBER FUNCTIONS */
+      SeededRNGStreams( const unsigned int & seed = 1u,
+                        const unsigned int & step = 0u )
+        : seed(seed), step(step) { }
+
+      /** Advance to the streams of the next time step. */
+      void nextStep() { ++step; }
+
+      /** Return the generator for the given cell index. */
+      RNG operator() ( const std::size_t & cell_index ) const {
+        RNG rng;
+        rng.seed( hash( hash( hash(seed) ^ step ) ^ cell_index ) );
+        return rng;
+      }
+
+      /** 32-bit integer finalizer (from MurmurHash3) used to decorrelate the
+       * seeds of neighboring streams. */
+      static unsigned int hash( unsigned int h ) {
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        /* avoid the zero seed, which some generators do not tolerate. */
+        return h ? h : 0x9e3779b9u;
+      }
+    };
+
+
+    /** Per-cell random number generator streams for counter-based generators
+     * such as chimp::random::Philox.
+     *
+     * Instead of hashing (seed, step, cell index) into a seed, the cell index
+     * and time step are given directly to the generator as part of its
+     * counter; chimp::interaction::Driver then selects a separate stream for
+     * each pair test.  The random numbers of each pair test are thus given by
+     * (seed, cell, step, pair) alone.
+     *
+     * @tparam RNG
+     *    The type of counter-based random number generator.  RNG must be
+     *    constructible from an unsigned int seed and must provide a
+     *    setStream(cell, step) member function.
+     */
+    template < typename RNG = random::Philox >
+    struct CounterRNGStreams {
+      /* TYPEDEFS */
+      typedef RNG result_type;
+
+
+      /* MEMBER STORAGE */
+      /** The seed (key) of all streams. */
+      unsigned int seed;
+
+      /** The current time step. */
+      unsigned int step;
+
+
+      /* MEMBER FUNCTIONS */
+      CounterRNGStreams( const unsigned int & seed = 1u,
+                         const unsigned int & step = 0u )
+        : seed(seed), step(step) { }
+
+      /** Advance to the streams of the next time step. */
+      void nextStep() { ++step; }
+
+      /** Return the generator for the given cell index. */
+      RNG operator() ( const std::size_t & cell_index ) const {
+        RNG rng( seed );
+        rng.setStream( static_cast<unsigned int>(cell_index), step );
+        return rng;
+      }
+    };
+
+
+    namespace detail {
+
+      /** Merge a per-cell erasure queue into the global erasure queue. */
+      template < typename ErasureQueue >
+      inline void mergeErasureQueue( ErasureQueue & eq,
+                                     const ErasureQueue & local ) {
+        for ( typename ErasureQueue::const_iterator i = local.begin(),
+                                                  end = local.end();
+              i != end; ++i )
+          eq.insert( *i );
+      }
+
+      /** The erasure queue is ignored for out-of-place interactions. */
+      inline void mergeErasureQueue( bool &, const bool & ) { }
+
+      /** Per-cell storage of the ParallelDriver. */
+      template < typename BackInsertionSequence,
+                 typename ErasureQueue,
+                 typename Monitor >
+      struct CellBuffers {
+        BackInsertionSequence result_list;
+        ErasureQueue eq;
+        Monitor monitor;
+
+        CellBuffers() : result_list(), eq(), monitor() { }
+      };
+
+    }/* namespace chimp::interaction::detail */
+
+
+    /** Driver for performing all interactions necessary for a range of cells,
+     * where the cells are distributed over a set of threads.
+     *
+     * Each cell is executed by chimp::interaction::Driver with its own random
+     * number generator stream, its own product list, its own erasure queue,
+     * and its own Monitor.  After all cells are finished, the per-cell
+     * products, erasures, and monitors are merged (in the order of the cells)
+     * into the caller's result_list, erasure queue, and monitor.  Because
+     * neither the random numbers nor the order of the results depend on the
+     * thread that executed a cell, the results do not depend on the number of
+     * threads for a fixed set of RNG streams.
+     *
+     * Threading is provided by OpenMP when it is enabled at compile time;
+     * otherwise the cells are executed serially (with identical results).  The
+     * cells are handed out to threads one at a time from a shared queue that
+     * is ordered by decreasing (estimated) cost so that idle threads pick up
+     * remaining work while a few expensive cells are still being processed.
+     *
+     * Requirements:
+     *  - CellIterator must be a random access iterator to CellInfo instances
+     *    (see chimp::interaction::Driver for CellInfo requirements).
+     *  - Cells must not share particle storage.
+     *  - BackInsertionSequence and ErasureQueue must be default constructible.
+     *  - Monitor must be default constructible and provide
+     *    <code>merge(const Monitor &)</code>.
+     *  - MaxSigmaVProduct::update must only modify the given cell (e.g.
+     *    AdaptiveMaxSigmaVProduct).
+     *  - RNGStreams must provide a <code>result_type</code> typedef and
+     *    <code>result_type operator()(const std::size_t & cell_index)
+     *    const</code> (see SeededRNGStreams and CounterRNGStreams).
+     */
+    template < typename Monitor = NullMonitor,
+               typename MaxSigmaVProduct = DefaultMaxSigmaVProduct,
+               typename WeightPolicy = UniformWeightNTC,
+               typename SubCyclePolicy = NoSubCycling >
+    struct ParallelDriver {
+      /* TYPEDEFS */
+    public:
+      typedef interaction::Driver< Monitor,
+                                   MaxSigmaVProduct,
+                                   WeightPolicy,
+                                   SubCyclePolicy > CellDriver;
+
+
+      /* MEMBER STORAGE */
+    public:
+      Monitor & monitor;
+
+      /** Generator/updater of (sigma*v)_max (copied to each cell Driver). */
+      MaxSigmaVProduct maxSigmaVProduct;
+
+      /** Sub-cycling policy (copied to each cell Driver). */
+      SubCyclePolicy subCycling;
+
+
+      /* STATIC STORAGE */
+    public:
+      static Monitor global_monitor;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** Constructor initializes the collisions monitor, the (sigma*v)_max
+       * generator/updater, and the sub-cycling policy.  */
+      ParallelDriver( Monitor & monitor = ParallelDriver::global_monitor,
+                      const MaxSigmaVProduct & maxSigmaVProduct
+                        = MaxSigmaVProduct(),
+                      const SubCyclePolicy & subCycling = SubCyclePolicy() )
+        : monitor( monitor ), maxSigmaVProduct( maxSigmaVProduct ),
+          subCycling( subCycling ) { }
+
+      /** Collision driver interface that MUST ONLY be used with
+       * ChimpDB::inplace_interactions == false.
+       */
+      template < typename CellIterator,
+                 typename ChimpDB,
+                 typename BackInsertionSequence,
+                 typename RNGStreams >
+      void operator() ( const double & dt,
+                        const CellIterator & first,
+                        const CellIterator & last,
+                        const ChimpDB & db,
+                        BackInsertionSequence & result_list,
+                        const RNGStreams & rngs ) {
+        bool dummy = false;
+        this->operator() ( dt, first, last, db, result_list, dummy, rngs );
+      }
+
+      /** Collision driver interface that can be used with any value of
+       * ChimpDB::inplace_interactions.  In the case that
+       * ChimpDB::inplace_interactions == false, the type and value of
+       * ErasureQueue is ignored.
+       */
+      template < typename CellIterator,
+                 typename ChimpDB,
+                 typename BackInsertionSequence,
+                 typename ErasureQueue,
+                 typename RNGStreams >
+      void operator() ( const double & dt,
+                        const CellIterator & first,
+                        const CellIterator & last,
+                        const ChimpDB & db,
+                        BackInsertionSequence & result_list,
+                        ErasureQueue & eq,
+                        const RNGStreams & rngs ) {
+        typedef typename RNGStreams::result_type RNG;
+
+        const int n_cells = static_cast<int>( std::distance( first, last ) );
+        if ( n_cells <= 0 )
+          return;
+
+        /* order the cells by decreasing estimated cost. */
+        std::vector< std::pair<double,int> > order( n_cells );
+        for ( int i = 0; i < n_cells; ++i )
+          order[i] = std::make_pair( -estimateCost( first[i], db ), i );
+        std::sort( order.begin(), order.end() );
+
+        typedef detail::CellBuffers< BackInsertionSequence,
+                                     ErasureQueue,
+                                     Monitor > Buffers;
+        std::vector< Buffers > buffers( n_cells );
+
+        #pragma omp parallel for schedule(dynamic,1)
+        for ( int k = 0; k < n_cells; ++k ) {
+          const int i = order[k].second;
+          Buffers & b = buffers[i];
+          RNG rng = rngs( static_cast<std::size_t>(i) );
+          CellDriver driver( b.monitor, maxSigmaVProduct, subCycling );
+          driver( dt, first[i], db, b.result_list, b.eq, rng );
+        }
+
+        /* merge the per-cell data in the order of the cells. */
+        for ( int i = 0; i < n_cells; ++i ) {
+          const Buffers & b = buffers[i];
+          result_list.insert( result_list.end(),
+                              b.result_list.begin(), b.result_list.end() );
+          detail::mergeErasureQueue( eq, b.eq );
+          monitor.merge( b.monitor );
+        }
+      }
+
+    private:
+      /** Estimate the relative cost of a cell as the number of possible
+       * interacting pairs. */
+      template < typename CellInfo,
+                 typename ChimpDB >
+      static double estimateCost( CellInfo & cell, const ChimpDB & db ) {
+        const unsigned int n_species =
+          std::min( cell.getNumberOfSpecies(), db.getProps().size() );
+
+        typedef typename ChimpDB::InteractionTable::PartnerList PartnerList;
+        typedef typename PartnerList::const_iterator PartnerIter;
+
+        double cost = 0.0;
+        for ( unsigned int A = 0u; A < n_species; ++A ) {
+          const double nA = cell.getSpecies(A).size();
+          if ( nA == 0.0 )
+            continue;
+
+          const PartnerList & partners = db.getInteractions().partners(A);
+          for ( PartnerIter p = partners.begin(), pend = partners.end();
+                p != pend && p->species < n_species; ++p ) {
+            if ( p->species < A ||
+                 db.getInteractions()[p->index].rhs.size() == 0 )
+              continue;
+            cost += nA * cell.getSpecies(p->species).size();
+          }
+        }
+
+        return cost;
+      }
+    };
+
+
+    template < typename Monitor,
+               typename MaxSigmaVProduct,
+               typename WeightPolicy,
+               typename SubCyclePolicy >
+    Monitor
+    ParallelDriver<Monitor, MaxSigmaVProduct, WeightPolicy, SubCyclePolicy>
+      ::global_monitor;
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_ParallelDriver_h
@@ -0,0 +1,316 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Per-cell particle population control (merging and splitting of weighted
+ * particles).
+ */
+
+#ifndef chimp_interaction_PopulationControl_h
+#define chimp_interaction_PopulationControl_h
+
+#include <chimp/accessors.h>
+
+#include <xylose/Vector.h>
+#include <xylose/compat/math.hpp>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+namespace chimp {
+  namespace interaction {
+
+    /** Statistics of one call of PopulationControl. */
+    struct PopulationControlStats {
+      /** The number of particles that were removed by merging. */
+      unsigned int number_removed;
+
+      /** The number of particles that were created by splitting. */
+      unsigned int number_created;
+
+      PopulationControlStats()
+        : number_removed( 0u ), number_created( 0u ) { }
+    };
+
+    /** Per-cell population control of the particles of each species towards
+     * a target number of (computational) particles, e.g. to keep the cost
+     * per time step of ionizing (InElastic_2X3) chemistry fixed.
+     *
+     * This stage is intended to be run for each cell after (or alongside)
+     * chimp::interaction::Driver.  For each species with a non-zero target
+     * count Nt and a current count N:
+     *  - If N > Nt ( 1 + tolerance ), groups of k >= 3 particles of similar
+     *    kinetic energy are each merged into two particles.  The two new
+     *    particles share the total weight W of the group equally, are placed
+     *    at the (weighted) center of mass of the group, and have velocities
+     *    \f$ \vec{V} \pm \vec{\delta} \f$, where \f$ \vec{V} \f$ is the mean
+     *    velocity of the group and \f$ \vec{\delta} \f$ has a random
+     *    direction and a magnitude given by the velocity variance of the
+     *    group.  Weight, momentum, and kinetic energy are thus conserved
+     *    exactly.
+     *  - If N < Nt ( 1 - tolerance ), the heaviest particles are split into
+     *    equal-weight copies (conserving weight, momentum, and energy).
+     *  .
+     * Particle weights are accessed through
+     * chimp::accessors::particle::weight and setWeight.  Because the weights
+     * of a species will in general no longer be uniform, this stage should be
+     * used with chimp::interaction::VariableWeightNTC.
+     *
+     * Particles are removed in the same manner as
+     * chimp::interaction::Driver removes particles of in-place interactions:
+     * the species range of the cell is shortened and the iterators of the
+     * particles that must be deleted from storage are inserted into the
+     * erasure queue.  New particles are appended to result_list.
+     */
+    struct PopulationControl {
+      /* MEMBER STORAGE */
+      /** Target number of particles per species (zero:  no control). */
+      std::vector<unsigned int> target;
+
+      /** Relative deviation from the target that is tolerated before
+       * particles are merged or split. */
+      double tolerance;
+
+
+      /* MEMBER FUNCTIONS */
+      PopulationControl( const double & tolerance = 0.1 )
+        : target(), tolerance( tolerance ) { }
+
+      /** Set the target number of particles of species A (zero disables
+       * population control of species A). */
+      void setTarget( const unsigned int & A, const unsigned int & n ) {
+        if ( target.size() <= A )
+          target.resize( A + 1u, 0u );
+        target[A] = n;
+      }
+
+      /** Merge/split the particles of all species of the given cell.
+       *
+       * @param cell
+       *    Cell information (see chimp::interaction::Driver for the CellInfo
+       *    requirements).
+       * @param result_list
+       *    Back insertion sequence to which particles created by splitting are
+       *    appended.
+       * @param eq
+       *    Erasure queue into which the iterators of particles that must be
+       *    removed from storage are inserted.
+       * @param rng
+       *    Random number generator (for the directions of merged velocities).
+       */
+      template < typename CellInfo,
+                 typename BackInsertionSequence,
+                 typename ErasureQueue,
+                 typename RNG >
+      PopulationControlStats operator() ( CellInfo & cell,
+                                          BackInsertionSequence & result_list,
+                                          ErasureQueue & eq,
+                                          RNG & rng ) const {
+        PopulationControlStats stats;
+
+        const unsigned int n_species =
+          std::min( cell.getNumberOfSpecies(), target.size() );
+
+        for ( unsigned int A = 0u; A < n_species; ++A ) {
+          if ( target[A] == 0u )
+            continue;
+
+          typename CellInfo::SpeciesRange & range = cell.getSpecies(A);
+          const double N = range.size();
+
+          if ( N > target[A] * ( 1.0 + tolerance ) )
+            stats.number_removed += merge( range, target[A], eq, rng );
+          else if ( N < target[A] * ( 1.0 - tolerance ) )
+            stats.number_created += split( range, target[A], result_list );
+        }
+
+        return stats;
+      }
+
+      /** Merge groups of particles of the given range until at most n
+       * particles (approximately) remain.  Since each group is merged into two
+       * particles, at least two particles always remain (targets of n < 2
+       * are treated as n = 2).
+       * @return The number of particles removed.
+       */
+      template < typename SpeciesRange,
+                 typename ErasureQueue,
+                 typename RNG >
+      static unsigned int merge( SpeciesRange & range,
+                                 const unsigned int & n,
+                                 ErasureQueue & eq,
+                                 RNG & rng ) {
+        typedef typename SpeciesRange::iterator PIter;
+        typedef xylose::Vector<double,3u> Vec;
+        using chimp::accessors::particle::velocity;
+        using chimp::accessors::particle::setVelocity;
+        using chimp::accessors::particle::position;
+        using chimp::accessors::particle::setPosition;
+        using chimp::accessors::particle::weight;
+        using chimp::accessors::particle::setWeight;
+
+        const unsigned int N = range.size();
+        const unsigned int n_min = std::max( n, 2u );
+        if ( N < 3u || N <= n_min )
+          return 0u;
+
+        /* group size k:  each group of k particles removes k - 2 (a single
+         * group of all N particles removes the maximum of N - 2). */
+        const unsigned int excess = N - n_min;
+        unsigned int k = 3u;
+        while ( k < N && ( N / k ) * ( k - 2u ) < excess )
+          ++k;
+        const unsigned int n_groups =
+          std::min( N / k, ( excess + k - 3u ) / ( k - 2u ) );
+
+        /* order the particles by kinetic energy such that similar particles
+         * are merged. */
+        std::vector< std::pair<double,unsigned int> > order( N );
+        {
+          PIter p = range.begin();
+          for ( unsigned int i = 0u; i < N; ++i, ++p ) {
+            const Vec & v = velocity(*p);
+            order[i] = std::make_pair( v * v, i );
+          }
+        }
+        std::sort( order.begin(), order.end() );
+
+        /* spread the groups evenly over the energy distribution. */
+        std::vector<unsigned int> removed;
+        removed.reserve( n_groups * ( k - 2u ) );
+        const unsigned int stride = N / n_groups;
+
+        for ( unsigned int g = 0u; g < n_groups; ++g ) {
+          const unsigned int first = g * stride;
+
+          double W = 0.0, E = 0.0;
+          Vec P( 0.0 ), X( 0.0 );
+          for ( unsigned int j = 0u; j < k; ++j ) {
+            const PIter p = range.begin() + order[first + j].second;
+            const double w = weight(*p);
+            const Vec & v = velocity(*p);
+            W += w;
+            P += w * v;
+            X += w * position(*p);
+            E += w * v * v;
+          }
+
+          if ( !( W > 0.0 ) )
+            continue;
+
+          const Vec V = P / W;
+          X /= W;
+          const double var = std::max( 0.0, E / W - V * V );
+          const Vec delta = std::sqrt( var ) * isotropic( rng );
+
+          const PIter p0 = range.begin() + order[first].second;
+          const PIter p1 = range.begin() + order[first + 1u].second;
+          setVelocity( *p0, V + delta );
+          setVelocity( *p1, V - delta );
+          setPosition( *p0, X );
+          setPosition( *p1, X );
+          setWeight( *p0, 0.5 * W );
+          setWeight( *p1, 0.5 * W );
+
+          for ( unsigned int j = 2u; j < k; ++j )
+            removed.push_back( order[first + j].second );
+        }
+
+        /* remove (in decreasing order such that the particle that is moved
+         * into each hole is never itself one to be removed). */
+        std::sort( removed.begin(), removed.end() );
+        for ( std::vector<unsigned int>::reverse_iterator i = removed.rbegin();
+              i != removed.rend(); ++i ) {
+          const PIter last = range.end() - 1;
+          const PIter p = range.begin() + *i;
+          if ( p != last )
+            *p = *last;
+          eq.insert( last );
+          range = SpeciesRange( range.begin(), last );
+        }
+
+        return removed.size();
+      }
+
+      /** Split the heaviest particles of the given range into equal-weight
+       * copies such that n particles result.
+       * @return The number of particles created.
+       */
+      template < typename SpeciesRange,
+                 typename BackInsertionSequence >
+      static unsigned int split( SpeciesRange & range,
+                                 const unsigned int & n,
+                                 BackInsertionSequence & result_list ) {
+        typedef typename SpeciesRange::iterator PIter;
+        typedef typename std::iterator_traits<PIter>::value_type Particle;
+        using chimp::accessors::particle::weight;
+        using chimp::accessors::particle::setWeight;
+
+        const unsigned int N = range.size();
+        if ( N == 0u || N >= n )
+          return 0u;
+
+        const unsigned int deficit = n - N;
+
+        std::vector< std::pair<double,unsigned int> > order( N );
+        {
+          PIter p = range.begin();
+          for ( unsigned int i = 0u; i < N; ++i, ++p )
+            order[i] = std::make_pair( -weight(*p), i );
+        }
+        std::sort( order.begin(), order.end() );
+
+        /* the i'th heaviest particle is split into c_i pieces. */
+        for ( unsigned int i = 0u; i < N; ++i ) {
+          const unsigned int c = 1u + deficit / N + ( i < deficit % N );
+          if ( c == 1u )
+            break;
+
+          const PIter p = range.begin() + order[i].second;
+          setWeight( *p, weight(*p) / c );
+          const Particle piece = *p;
+          for ( unsigned int j = 1u; j < c; ++j )
+            result_list.push_back( piece );
+        }
+
+        return deficit;
+      }
+
+    private:
+      /** A random isotropic unit vector. */
+      template < typename RNG >
+      static xylose::Vector<double,3u> isotropic( RNG & rng ) {
+        const double cos_theta = 2.0 * rng.rand() - 1.0;
+        const double sin_theta = std::sqrt( 1.0 - cos_theta * cos_theta );
+        const double phi = 2.0 * M_PI * rng.rand();
+        return xylose::V3( sin_theta * std::cos(phi),
+                           sin_theta * std::sin(phi),
+                           cos_theta );
+      }
+    };
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_PopulationControl_h
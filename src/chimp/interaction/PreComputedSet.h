@@ -0,0 +1,380 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Definition of the equation set that tabulates the total cross section and
+ * the output-path probabilities on a relative-velocity grid.
+ * */
+
+#ifndef chimp_interaction_PreComputedSet_h
+#define chimp_interaction_PreComputedSet_h
+
+#include <chimp/interaction/Set.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace chimp {
+  namespace interaction {
+
+    /** This set implementation pre-calculates the total cross section and the
+     * output path probabilities at a uniform grid of relative speeds and
+     * stores the associated lookup-table for later use.
+     *
+     * For each grid point, the output path probabilities are stored as a
+     * Walker/Vose alias table such that the rejection test is a grid index
+     * (with linear interpolation of the total cross section) and the choice of
+     * output path is a single random number and a single comparison.  Relative
+     * speeds beyond the range of the table, as well as grid segments in which
+     * any of the output paths opens or closes (thresholds), fall back to the
+     * runtime calculation of Set.
+     *
+     * The table must be (re)built by calling precompute() after the set of
+     * equations (rhs) has been changed.  RuntimeDB does this automatically for
+     * each set in the interaction table when it is configured to use this
+     * class.
+     *
+     * @see make_options::type::setPreComputedSets
+     * */
+    template < typename options >
+    struct PreComputedSet : Set<options> {
+      /* TYPEDEFS */
+      typedef interaction::Set<options> super;
+      typedef typename super::Equation Equation;
+      typedef typename super::eq_list eq_list;
+      typedef typename super::OutPath OutPath;
+
+
+
+      /* MEMBER STORAGE */
+      /** The grid spacing of the relative speed. */
+      double dv;
+
+      /** The inverse of the grid spacing of the relative speed. */
+      double inv_dv;
+
+      /** The largest relative speed for which the table is valid. */
+      double v_max;
+
+      /** Total cross section at each of the grid points. */
+      std::vector<double> cs_total;
+
+      /** Upper bound of (sigma*v)_max in the range [0, v_(i+1)] for each of the
+       * grid segments i. */
+      std::vector<double> max_sigma_v;
+
+      /** Alias table probabilities (n_grid * rhs.size()). */
+      std::vector<double> alias_prob;
+
+      /** Alias table alternative output paths (n_grid * rhs.size()). */
+      std::vector<int> alias_index;
+
+      /** Whether any output path opens or closes within each of the grid
+       * segments i.  The table is not used in these segments. */
+      std::vector<bool> threshold;
+
+
+
+      /* MEMBER FUNCTIONS */
+      /** Constructor.  A blank set of equations are created if constructor
+       * arguments are omitted.  The lookup table is empty until precompute()
+       * is called. */
+      PreComputedSet(const Input & lhs = Input(), const eq_list & rhs = eq_list())
+        : super(lhs, rhs), dv(0.0), inv_dv(0.0), v_max(0.0) {}
+
+      /** Whether the lookup table has been built. */
+      bool isPrecomputed() const { return !cs_total.empty(); }
+
+      /** Build the lookup table for relative speeds in [0, v_max] using n grid
+       * points.  An empty set of equations or an invalid range will clear the
+       * table such that all calls fall back to the Set implementation.
+       * */
+      void precompute( const double & v_max, const unsigned int & n ) {
+        cs_total.clear();
+        max_sigma_v.clear();
+        alias_prob.clear();
+        alias_index.clear();
+        threshold.clear();
+        this->v_max = dv = inv_dv = 0.0;
+
+        const unsigned int n_eq = this->rhs.size();
+        if ( n_eq == 0u || n < 2u || !(v_max > 0.0) )
+          return;
+
+        this->v_max = v_max;
+        dv = v_max / (n - 1);
+        inv_dv = 1.0 / dv;
+
+        cs_total.resize( n, 0.0 );
+        max_sigma_v.resize( n - 1, 0.0 );
+        alias_prob.resize( n * n_eq, 1.0 );
+        alias_index.resize( n * n_eq, 0 );
+        threshold.resize( n - 1, false );
+
+        std::vector<double> cs( n_eq ), cs_prev( n_eq );
+        std::vector<int> small, large;
+        small.reserve( n_eq );
+        large.reserve( n_eq );
+
+        for ( unsigned int i = 0; i < n; ++i ) {
+          const double v = i * dv;
+
+          double tot = 0.0;
+          for ( unsigned int j = 0; j < n_eq; ++j ) {
+            cs[j] = this->rhs[j].cs->operator()(v);
+            tot += cs[j];
+
+            if ( i > 0u && ( cs[j] > 0.0 ) != ( cs_prev[j] > 0.0 ) )
+              threshold[i-1] = true;
+            cs_prev[j] = cs[j];
+          }
+          cs_total[i] = tot;
+
+          double * prob = & alias_prob [ i * n_eq ];
+          int    * alias= & alias_index[ i * n_eq ];
+          for ( unsigned int j = 0; j < n_eq; ++j )
+            alias[j] = j;
+
+          if ( tot <= 0.0 )
+            continue;
+
+          /* Vose's construction of the alias table. */
+          small.clear();
+          large.clear();
+          for ( unsigned int j = 0; j < n_eq; ++j ) {
+            cs[j] *= n_eq / tot;
+            if ( cs[j] < 1.0 )
+              small.push_back(j);
+            else
+              large.push_back(j);
+          }
+
+          while ( !small.empty() && !large.empty() ) {
+            int s = small.back(); small.pop_back();
+            int l = large.back(); large.pop_back();
+
+            prob[s]  = cs[s];
+            alias[s] = l;
+            cs[l] = ( cs[l] + cs[s] ) - 1.0;
+
+            if ( cs[l] < 1.0 )
+              small.push_back(l);
+            else
+              large.push_back(l);
+          }
+
+          /* anything left over (possibly due to round-off) is kept. */
+          for ( ; !large.empty(); large.pop_back() ) prob[large.back()] = 1.0;
+          for ( ; !small.empty(); small.pop_back() ) prob[small.back()] = 1.0;
+        }
+
+        /* The total cross section is linearly interpolated between grid
+         * points, so max(sigma_i, sigma_(i+1)) * v_(i+1) bounds sigma*v within
+         * each segment. */
+        double running_max = 0.0;
+        for ( unsigned int i = 0; i < (n - 1); ++i ) {
+          running_max = std::max( running_max,
+            std::max( cs_total[i], cs_total[i+1] ) * ( (i+1) * dv )
+          );
+          max_sigma_v[i] = running_max;
+        }
+      }
+
+      /** Total cross section (linearly interpolated from the table) at the
+       * given relative speed.  Falls back to summing each of the cross sections
+       * if v_relative lies outside of the table or within a threshold segment.
+       * */
+      double crossSectionTotal( const double & v_relative ) const {
+        const double x = v_relative * inv_dv;
+        const unsigned int i = static_cast<unsigned int>(x);
+
+        if ( !isPrecomputed() || !( v_relative < v_max ) || threshold[i] ) {
+          double cs_tot = 0.0;
+          for ( unsigned int j = 0u; j < this->rhs.size(); ++j )
+            cs_tot += this->crossSection( j, v_relative );
+          return cs_tot;
+        }
+
+        return cs_total[i] + ( x - i ) * ( cs_total[i+1] - cs_total[i] );
+      }
+
+      /** Find the local maximum of cross-section*velocity (within a given
+       * range of velocity space).  Within the range of the table, this is a
+       * single lookup of a (conservative) upper bound of the total
+       * cross-section*velocity.  Outside of the table, the Set implementation
+       * is used.
+       * */
+      inline double findMaxSigmaVProduct(const double & v_rel_max) const {
+        if ( !isPrecomputed() || !( v_rel_max < v_max ) )
+          return super::findMaxSigmaVProduct( v_rel_max );
+
+        return max_sigma_v[ static_cast<unsigned int>( v_rel_max * inv_dv ) ];
+      }
+
+      /** Chooses an interaction path to traverse dependent on the incident
+       * relative speed and the current value of (sigma*relspeed)_max.
+       *
+       * The implementation here uses the lookup table if v_relative is in
+       * range.  The output path is drawn from the alias table of either of the
+       * two neighboring grid points, chosen such that the cross section of
+       * each path is linearly interpolated just as the total cross section.
+       * Grid segments that contain a threshold of any of the paths use the
+       * exact calculation of Set instead, such that thresholds are honored
+       * exactly and the rates near thresholds are not biased.
+       *
+       * @return The index of the right-hand-side of the interaction
+       * equation is returned, unless no interaction can be performed.  In
+       * this latter case, a value of -1 will be returned.
+       * */
+      template < typename RNG >
+      std::pair<int,double>
+      calculateOutPath( const double & max_sigma_relspeed,
+                        const double & v_relative,
+                        RNG & rng ) const {
+        double sigma_relspeed = 0.0;
+        return calculateOutPath( max_sigma_relspeed, v_relative, rng,
+                                 sigma_relspeed );
+      }
+
+      /** Chooses an interaction path to traverse and returns the (tabulated)
+       * total cross-section*relspeed of the incident pair in sigma_relspeed.
+       * @see Set::calculateOutPath.
+       * */
+      template < typename RNG >
+      std::pair<int,double>
+      calculateOutPath( const double & max_sigma_relspeed,
+                        const double & v_relative,
+                        RNG & rng,
+                        double & sigma_relspeed ) const {
+        const double x = v_relative * inv_dv;
+        const unsigned int i = static_cast<unsigned int>(x);
+
+        if ( !isPrecomputed() || !( v_relative < v_max ) || threshold[i] )
+          return super::calculateOutPath( max_sigma_relspeed, v_relative, rng,
+                                          sigma_relspeed );
+
+        const double f = x - i;
+        const double cs_tot = cs_total[i] + f * ( cs_total[i+1] - cs_total[i] );
+        sigma_relspeed = cs_tot * v_relative;
+
+        /* now evaluate whether any of these interactions should even
+         * happen. */
+        if ( (rng.rand() * max_sigma_relspeed) > sigma_relspeed ||
+             cs_tot <= 0.0 )
+          return std::make_pair(-1,0.0); /* no interaction!!! */
+
+        /* choose grid point i+1 with probability f*cs_total[i+1] / cs_tot,
+         * such that the mixture of both alias tables yields the linearly
+         * interpolated cross section of each path. */
+        const unsigned int k =
+          ( rng.rand() * cs_tot < f * cs_total[i+1] ) ? (i+1) : i;
+
+        /* now, we finally pick our output state.  */
+        const unsigned int n_eq = this->rhs.size();
+        const double u = rng.randExc() * n_eq;
+        unsigned int j = static_cast<unsigned int>(u);
+        if ( j >= n_eq )
+          j = n_eq - 1u;
+
+        const unsigned int kj = k * n_eq + j;
+        const int path = ( ( u - j ) < alias_prob[kj] ) ? j : alias_index[kj];
+
+        const double csj = this->crossSection( path, v_relative );
+        if ( csj <= 0.0 )
+          return std::make_pair(-1,0.0); /* path closed between grid points. */
+
+        return std::make_pair(path, csj);
+      }
+
+      template < typename PIter,
+                 typename BackInsertionSequence,
+                 typename RNG >
+      std::pair<int,double>
+      interact( const double & max_sigma_relspeed,
+                const std::pair<PIter, PIter> & pair,
+                BackInsertionSequence & result_list,
+                RNG & rng ) const {
+        double sigma_relspeed = 0.0;
+        return interact( max_sigma_relspeed, pair, result_list, rng,
+                         sigma_relspeed );
+      }
+
+      template < typename PIter,
+                 typename BackInsertionSequence,
+                 typename RNG >
+      std::pair<int,double>
+      interact( const double & max_sigma_relspeed,
+                const std::pair<PIter, PIter> & pair,
+                BackInsertionSequence & result_list,
+                RNG & rng,
+                double & sigma_relspeed ) const {
+        typename options::Particle & pA = *pair.first;
+        typename options::Particle & pB = *pair.second;
+
+        using chimp::accessors::particle::velocity;
+
+        /* Relative velocity of the the two particles. */
+        double v_rel = ( velocity(pA) - velocity(pB) ).abs();
+
+        std::pair<int,double> path =
+          calculateOutPath( max_sigma_relspeed, v_rel, rng, sigma_relspeed );
+
+        return this->applyOutPath( path, pA, pB, result_list, rng );
+      }
+    };
+
+
+    /** Build the lookup table of a PreComputedSet.
+     * @see PreComputedSet::precompute
+     * */
+    template < typename options >
+    inline void precompute( PreComputedSet<options> & set,
+                            const double & v_max,
+                            const unsigned int & n ) {
+      set.precompute( v_max, n );
+    }
+
+    /** No-op overload for the Set class that does not use a lookup table. */
+    template < typename options >
+    inline void precompute( Set<options> & /* set */,
+                            const double & /* v_max */,
+                            const unsigned int & /* n */ ) { }
+
+
+    /** Metafunction to select the equation Set implementation according to
+     * options::precomputed_sets.  */
+    template < typename options,
+               bool precomputed = options::precomputed_sets >
+    struct SetType {
+      typedef interaction::Set<options> type;
+    };
+
+    template < typename options >
+    struct SetType< options, true > {
+      typedef interaction::PreComputedSet<options> type;
+    };
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_PreComputedSet_h
@@ -0,0 +1,231 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Declaration of the product sink interface through which interaction models
+ * store the particles that they create.
+ */
+
+#ifndef chimp_interaction_ProductSink_h
+#define chimp_interaction_ProductSink_h
+
+#include <boost/type_traits/is_base_of.hpp>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+
+namespace chimp {
+  namespace interaction {
+
+    /** Destination of the products of interaction models (see
+     * model::Base::interact).
+     *
+     * Implementations may store products in a growable sequence (see
+     * SequenceSink), in a preallocated per-thread arena (see ArenaSink), in a
+     * ring buffer, or directly in the storage of the destination cell.
+     * References returned by append must remain valid at least until the
+     * next call to reserve such that models can call reserve once and then
+     * modify the products in place.
+     */
+    template < typename Particle >
+    class ProductSink {
+      /* TYPEDEFS */
+    public:
+      typedef Particle value_type;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** Virtual NO-OP destructor. */
+      virtual ~ProductSink() { }
+
+      /** Prepare for n more products.  This may invalidate references to
+       * products returned previously. */
+      virtual void reserve( const std::size_t & n ) = 0;
+
+      /** Append a copy of p and return a reference to the stored product. */
+      virtual Particle & append( const Particle & p ) = 0;
+
+      /** The number of products in the sink. */
+      virtual std::size_t size() const = 0;
+
+      /** Access the i'th product in the sink. */
+      virtual Particle & operator[] ( const std::size_t & i ) = 0;
+
+      /** Same as append; allows a sink to be used as the product list of
+       * chimp::interaction::Driver. */
+      void push_back( const Particle & p ) { append( p ); }
+    };
+
+
+    namespace detail {
+
+      /** Make room for n more elements (only std::vector needs this to keep
+       * references valid). */
+      template < typename BackInsertionSequence >
+      inline void reserveMore( BackInsertionSequence &,
+                               const std::size_t & ) { }
+
+      template < typename T, typename Alloc >
+      inline void reserveMore( std::vector<T,Alloc> & v,
+                               const std::size_t & n ) {
+        v.reserve( v.size() + n );
+      }
+
+    }/* namespace chimp::interaction::detail */
+
+
+    /** Product sink adaptor for a back insertion sequence such as std::vector
+     * or std::deque. */
+    template < typename BackInsertionSequence >
+    class SequenceSink
+      : public ProductSink< typename BackInsertionSequence::value_type > {
+      /* TYPEDEFS */
+    public:
+      typedef typename BackInsertionSequence::value_type Particle;
+
+
+      /* MEMBER STORAGE */
+    public:
+      BackInsertionSequence & sequence;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      explicit SequenceSink( BackInsertionSequence & sequence )
+        : sequence( sequence ) { }
+
+      virtual void reserve( const std::size_t & n ) {
+        detail::reserveMore( sequence, n );
+      }
+
+      virtual Particle & append( const Particle & p ) {
+        sequence.push_back( p );
+        return sequence.back();
+      }
+
+      virtual std::size_t size() const { return sequence.size(); }
+
+      virtual Particle & operator[] ( const std::size_t & i ) {
+        typename BackInsertionSequence::iterator it = sequence.begin();
+        std::advance( it, i );
+        return *it;
+      }
+    };
+
+
+    /** Product sink that reuses its storage between calls of clear().
+     *
+     * The arena grows (only within reserve) until it is large enough for the
+     * largest number of products between calls of clear; after this, no
+     * memory is allocated and no particles are constructed or destroyed:
+     * products are simply assigned into the existing storage.  An ArenaSink
+     * is intended to be used as a per-thread (or per-cell) product list that
+     * is emptied by the simulation after the products have been moved into
+     * their destination cells.
+     */
+    template < typename Particle >
+    class ArenaSink : public ProductSink< Particle > {
+      /* TYPEDEFS */
+    public:
+      typedef Particle * iterator;
+      typedef const Particle * const_iterator;
+
+
+      /* MEMBER STORAGE */
+    private:
+      std::vector< Particle > storage;
+      std::size_t n;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      explicit ArenaSink( const std::size_t & capacity = 0u )
+        : storage( capacity ), n( 0u ) { }
+
+      virtual void reserve( const std::size_t & m ) {
+        if ( n + m > storage.size() )
+          storage.resize( std::max( n + m, 2u * storage.size() ) );
+      }
+
+      virtual Particle & append( const Particle & p ) {
+        if ( n == storage.size() )
+          reserve( 1u );
+        Particle & r = storage[n++];
+        r = p;
+        return r;
+      }
+
+      virtual std::size_t size() const { return n; }
+
+      virtual Particle & operator[] ( const std::size_t & i ) {
+        return storage[i];
+      }
+
+      /** Remove all products (the storage is retained). */
+      void clear() { n = 0u; }
+
+      /** The number of products that can be stored without growing. */
+      std::size_t capacity() const { return storage.size(); }
+
+      iterator begin() { return storage.empty() ? 0 : &storage[0]; }
+      iterator end() { return begin() + n; }
+      const_iterator begin() const { return storage.empty() ? 0 : &storage[0]; }
+      const_iterator end() const { return begin() + n; }
+    };
+
+
+    namespace detail {
+
+      /** Present a product list as a ProductSink:  either the list is already
+       * a ProductSink, or it is wrapped into a SequenceSink. */
+      template < typename Particle,
+                 typename BackInsertionSequence,
+                 bool is_sink = boost::is_base_of<
+                   ProductSink<Particle>, BackInsertionSequence
+                 >::value >
+      struct AsProductSink {
+        SequenceSink< BackInsertionSequence > sink;
+
+        explicit AsProductSink( BackInsertionSequence & list )
+          : sink( list ) { }
+
+        ProductSink<Particle> & operator() () { return sink; }
+      };
+
+      template < typename Particle, typename BackInsertionSequence >
+      struct AsProductSink< Particle, BackInsertionSequence, true > {
+        BackInsertionSequence & sink;
+
+        explicit AsProductSink( BackInsertionSequence & list )
+          : sink( list ) { }
+
+        ProductSink<Particle> & operator() () { return sink; }
+      };
+
+    }/* namespace chimp::interaction::detail */
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_ProductSink_h
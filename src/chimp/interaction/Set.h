@@ -29,6 +29,8 @@
 #define chimp_interaction_Set_h
 
 #include <chimp/interaction/Equation.h>
+#include <chimp/interaction/ProductSink.h>
+#include <chimp/interaction/CollisionRecord.h>
 
 #include <xylose/logger.h>
 #include <xylose/compat/math.hpp>
@@ -54,6 +56,10 @@ namespace chimp {
        * */
       typedef std::pair<int, double> OutPath;
 
+      /** Number of equations up to which calculateOutPath keeps the cross
+       * sections on the stack. */
+      enum { max_local_equations = 16 };
+
 
 
       /* MEMBER STORAGE */
@@ -63,6 +69,19 @@ namespace chimp {
       /** A set of right hand sides of the several equations. */
       eq_list rhs;
 
+      /** Packed hot data (cross section, model, threshold, and the species of
+       * the first input) of each equation in rhs.  The collision routines only read this record (and
+       * not rhs) once it has been built.  The record refers to (but does not
+       * own) the cross sections and models of rhs and must be rebuilt by
+       * calling updateRecord() whenever rhs has been changed (including
+       * replacing the cross section or model of an equation).  RuntimeDB does
+       * this automatically for each set in the interaction table.  The cross
+       * sections and models of the record are tagged with their concrete
+       * types if options::variant_dispatch is true.
+       * @see make_options::type::setVariantDispatch
+       */
+      CollisionRecord<options> record;
+
 
 
       /* MEMBER FUNCTIONS */
@@ -85,12 +104,29 @@ namespace chimp {
         return out << '}';
       }
 
+      /** Rebuild the packed record of the hot data of rhs. */
+      void updateRecord() {
+        CollisionRecord<options>( rhs ).swap( record );
+      }
+
+      /** Whether the record has been built for rhs (see updateRecord()). */
+      inline bool hasRecord() const { return record.size() == rhs.size(); }
+
+      /** Evaluate the cross section of the jth equation in rhs.  This uses
+       * the record of updateRecord() when it is available. */
+      inline double crossSection( const unsigned int & j,
+                                  const double & v_relative ) const {
+        if ( hasRecord() )
+          return record[j].crossSection( v_relative );
+        return rhs[j].cs->operator()( v_relative );
+      }
+
       /** Find the local maximum of cross-section*velocity (within a given
        * range of velocity space).  This version of the Set class returns the
        * sum of the maxima of each cross section contained in the set.  For null
        * collision methods, this will resort to more collisions than necessary.
        * For a more performance sensitive implementation, use the precomputed
-       * Set implementation.
+       * Set implementation (PreComputedSet).
        * */
       inline double findMaxSigmaVProduct(const double & v_rel_max) const {
         double sum = 0.0;
@@ -117,47 +153,53 @@ namespace chimp {
       calculateOutPath( const double & max_sigma_relspeed,
                         const double & v_relative,
                         RNG & rng ) const {
+        double sigma_relspeed = 0.0;
+        return calculateOutPath( max_sigma_relspeed, v_relative, rng,
+                                 sigma_relspeed );
+      }
+
+      /** Chooses an interaction path to traverse (see above) and also returns
+       * the total cross-section*relspeed of the incident pair in
+       * sigma_relspeed.  The returned sigma_relspeed can be compared to
+       * max_sigma_relspeed by the caller in order to upgrade the value of
+       * (sigma*relspeed)_max.
+       * */
+      template < typename RNG >
+      std::pair<int,double>
+      calculateOutPath( const double & max_sigma_relspeed,
+                        const double & v_relative,
+                        RNG & rng,
+                        double & sigma_relspeed ) const {
         /* first find the normalization factor for the sum of
-         * cross-section values at this velocity. */
+         * cross-section values at this velocity.  The values are kept on the
+         * stack for the usual (small) number of equations. */
+        const unsigned int n_eq = rhs.size();
+        double cs_local[ max_local_equations ];
+        std::vector<double> cs_heap;
+        double * cs = cs_local;
+        if ( n_eq > max_local_equations ) {
+          cs_heap.resize( n_eq );
+          cs = &cs_heap[0];
+        }
+
         double cs_tot = 0;
-        double cs_max = 0;
-        std::vector<double> cs;
-        cs.reserve(rhs.size());
-        for ( typename eq_list::const_iterator i = rhs.begin(),
-                                             end = rhs.end();
-              i != end; ++i ) {
-          double csi = i->cs->operator()(v_relative);
-          cs_tot += csi;
-          cs.push_back(csi);
+        for ( unsigned int j = 0u; j < n_eq; ++j )
+          cs_tot += ( cs[j] = crossSection( j, v_relative ) );
 
-          if (csi > cs_max)
-            cs_max = csi;
-        }
+        sigma_relspeed = cs_tot * v_relative;
 
         /* now evaluate whether any of these interactions should even
          * happen. */
-        if ( (rng.rand() * max_sigma_relspeed) > (cs_tot*v_relative) )
+        if ( (rng.rand() * max_sigma_relspeed) > sigma_relspeed )
           return std::make_pair(-1,0.0); /* no interaction!!! */
 
-        #if UPGRADE_MAX_SIGMA_V
-        /* upgrade max_sigma_relspeed? */
-        {
-          register double cs_max_relspeed = cs_max * v_relative;
-          if (cs_max_relspeed > max_sigma_relspeed)
-            max_sigma_relspeed = cs_max_relspeed;
-        }
-        #endif
-
         /* now, we finally pick our output state.  */
         double r = rng.randExc() * cs_tot;
         cs_tot = 0;
-        int j = 0;
-        for ( std::vector<double>::iterator i = cs.begin(),
-                                          end = cs.end();
-              i < end; ++i, ++j) {
-          cs_tot += (*i);
+        for ( unsigned int j = 0u; j < n_eq; ++j ) {
+          cs_tot += cs[j];
           if (cs_tot > r)
-            return std::make_pair(j,(*i));
+            return std::make_pair(int(j),cs[j]);
         }
 
         /* we actually better never get here. */
@@ -173,54 +215,81 @@ namespace chimp {
                 const std::pair<PIter, PIter> & pair,
                 BackInsertionSequence & result_list,
                 RNG & rng ) const {
+        double sigma_relspeed = 0.0;
+        return interact( max_sigma_relspeed, pair, result_list, rng,
+                         sigma_relspeed );
+      }
+
+      /** Test (and possibly execute) an interaction of the given pair and
+       * return the total cross-section*relspeed of the pair in
+       * sigma_relspeed.
+       * @see calculateOutPath.
+       * */
+      template < typename PIter,
+                 typename BackInsertionSequence,
+                 typename RNG >
+      std::pair<int,double>
+      interact( const double & max_sigma_relspeed,
+                const std::pair<PIter, PIter> & pair,
+                BackInsertionSequence & result_list,
+                RNG & rng,
+                double & sigma_relspeed ) const {
         typename options::Particle & pA = *pair.first;
         typename options::Particle & pB = *pair.second;
 
         using chimp::accessors::particle::velocity;
-        using chimp::accessors::particle::species;
 
         /* Relative velocity of the the two particles. */
         double v_rel = ( velocity(pA) - velocity(pB) ).abs();
 
         std::pair<int,double> path =
-          calculateOutPath( max_sigma_relspeed, v_rel, rng );
+          calculateOutPath( max_sigma_relspeed, v_rel, rng, sigma_relspeed );
+
+        return applyOutPath( path, pA, pB, result_list, rng );
+      }
+
+      /** Execute the interaction model of the output path chosen by
+       * calculateOutPath (or an equivalent routine of a derived Set).  Nothing
+       * is done if path.first < 0.
+       *
+       * @return path is returned unmodified.
+       * */
+      template < typename BackInsertionSequence,
+                 typename RNG >
+      const std::pair<int,double> &
+      applyOutPath( const std::pair<int,double> & path,
+                    typename options::Particle & pA,
+                    typename options::Particle & pB,
+                    BackInsertionSequence & result_list,
+                    RNG & rng ) const {
+        using chimp::accessors::particle::species;
 
         if ( path.first >= 0 ) {
-          /* help make sure that the order of the particles is correct--sorted
-           * by increasing mass. */
-          if ( species(pA) > species(pB) )
-            rhs[path.first].interaction->interact( pB, pA, result_list, rng );
+          /* help make sure that the order of the particles is correct--the
+           * order of the (mass-sorted) inputs of the equation, which need not
+           * be the order of the species indices (see
+           * RuntimeDB::extendBinaryInteractions). */
+          const int species_A = hasRecord() ? record[path.first].species_A
+                                            : rhs[path.first].A.species;
+          const bool swap = species(pA) != species_A;
+          typename options::Particle & p1 = swap ? pB : pA;
+          typename options::Particle & p2 = swap ? pA : pB;
+
+          detail::AsProductSink< typename options::Particle,
+                                 BackInsertionSequence >
+            products( result_list );
+
+          if ( hasRecord() )
+            record[path.first].interaction.interact( p1, p2,
+                                                     products(), rng );
           else
-            rhs[path.first].interaction->interact( pA, pB, result_list, rng );
+            rhs[path.first].interaction->interact( p1, p2, products(), rng );
         }
 
         return path;
       }
     };
 
-#if 0
-    /** This set implementation pre-calculates the cross-section and
-     * probabilities at various pre-determined energies and stores the
-     * associated lookup-table for later use. */
-    struct PreComputedSet : Set {
-
-      struct elt {
-        double cross_section_total;
-        std::vector<double> cross_sections;
-        xylose::Distribution distrib;
-      };
-
-
-      std::pair<int,double>
-      calculateOutPath( const double & max_sigma_relspeed,
-                        const double & v_relative ) const {
-        if (rhs.empty())
-          return std::make_pair(-1,0.0);
-        return 1;
-      }
-    };
-#endif
-
     template < typename options >
     inline bool hasElastic( const Set<options> & set ) {
       return hasElastic(set.rhs);
@@ -0,0 +1,372 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Sparse table of the interaction::Set instances of each pair of species.
+ * */
+
+#ifndef chimp_interaction_SparseInteractionTable_h
+#define chimp_interaction_SparseInteractionTable_h
+
+#include <chimp/interaction/detail/NestLock.h>
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+namespace chimp {
+  namespace interaction {
+
+    /** Table of interaction sets that only stores the pairs of species for
+     * which a set has been created (normally the pairs that have at least one
+     * equation).  A per-species list of the partners with stored sets allows
+     * iterating over only the active pairs.
+     *
+     * Const access to a pair that has not been created yields a blank set.
+     * Non-const access creates the set of the pair if necessary; references
+     * to stored sets remain valid until resize(), clear(), or compact() is
+     * called.
+     *
+     * Sets may also be marked pending (see setPending()).  The contents of a
+     * pending set are loaded by the Loader (see setLoader()) when the set is
+     * first accessed through operator() or operator[].  Loading happens
+     * exactly once, even if several threads access the set concurrently;
+     * loaded sets are accessed without locking.  The iterators of the stored
+     * sets do not load pending sets (see loadAll()).
+     *
+     * @tparam Set
+     *    The type of the interaction set (interaction::Set or
+     *    interaction::PreComputedSet).
+     */
+    template < typename Set >
+    class SparseInteractionTable {
+      /* TYPEDEFS */
+    public:
+      /** Entry of the list of partners of a species. */
+      struct Partner {
+        /** The index of the partner species. */
+        unsigned int species;
+
+        /** The index of the set of this pair within the stored sets. */
+        unsigned int index;
+
+        Partner( const unsigned int & species = 0u,
+                 const unsigned int & index = 0u )
+          : species( species ), index( index ) { }
+
+        bool operator< ( const Partner & that ) const {
+          return species < that.species;
+        }
+      };
+
+      /** List of partners of a species, ordered by species index. */
+      typedef std::vector<Partner> PartnerList;
+
+      /** Interface of the object that loads the contents of pending sets. */
+      struct Loader {
+        virtual ~Loader() { }
+
+        /** Load the contents of the (pending) set of species i and j.  The
+         * table may be accessed from within load(); accessing the set that
+         * is being loaded then yields the partially loaded set. */
+        virtual void load( Set & set,
+                           const unsigned int & i,
+                           const unsigned int & j ) const = 0;
+      };
+
+      typedef std::deque<Set> SetStorage;
+      typedef typename SetStorage::iterator iterator;
+      typedef typename SetStorage::const_iterator const_iterator;
+
+
+      /* MEMBER STORAGE */
+    private:
+      /** Number of species (side length of the full table). */
+      unsigned int n;
+
+      /** Index of the stored set of each pair, packed by column (-1 if the
+       * set of the pair has not been created). */
+      std::vector<int> indices;
+
+      /** The stored sets (pending sets are loaded on const access). */
+      mutable SetStorage sets;
+
+      /** The partners of each species that have a stored set. */
+      std::vector<PartnerList> partner_lists;
+
+      /** Blank set that is returned for pairs without a stored set. */
+      Set blank;
+
+      /** Loading state of a stored set. */
+      enum State { LOADED = 0, PENDING, LOADING };
+
+      /** Loading state and species (i <= j) of a stored set. */
+      struct Status {
+        int state;
+        unsigned int i, j;
+
+        Status( const unsigned int & i = 0u, const unsigned int & j = 0u )
+          : state( LOADED ), i( i ), j( j ) { }
+      };
+
+      /** The status of each stored set (empty if no set has ever been marked
+       * pending). */
+      mutable std::vector<Status> status;
+
+      /** The loader of pending sets. */
+      const Loader * loader;
+
+      /** Serializes the loading of pending sets. */
+      mutable detail::NestLock load_lock;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** Constructor creates an empty table for n species. */
+      SparseInteractionTable( const unsigned int & n = 0u ) : loader( NULL ) {
+        resize( n );
+      }
+
+      /** Remove all sets and change the number of species. */
+      void resize( const unsigned int & n ) {
+        this->n = n;
+        indices.assign( std::size_t(n) * (n + 1u) / 2u, -1 );
+        sets.clear();
+        partner_lists.assign( n, PartnerList() );
+        status.clear();
+      }
+
+      /** Remove all sets. */
+      void clear() { resize( n ); }
+
+      /** Increase the number of species to n, keeping all stored sets and
+       * their indices.  Since the sets are stored by column, the pairs of
+       * the previous species keep their place in the table. */
+      void extend( const unsigned int & n ) {
+        if ( n <= this->n )
+          return;
+
+        this->n = n;
+        indices.resize( std::size_t(n) * (n + 1u) / 2u, -1 );
+        partner_lists.resize( n );
+      }
+
+      /** The number of species of the table. */
+      unsigned int side_length() const { return n; }
+
+      /** The number of stored sets. */
+      std::size_t size() const { return sets.size(); }
+
+      iterator begin() { return sets.begin(); }
+      iterator end() { return sets.end(); }
+      const_iterator begin() const { return sets.begin(); }
+      const_iterator end() const { return sets.end(); }
+
+      /** Return whether a set has been created for species i and j. */
+      bool contains( const unsigned int & i, const unsigned int & j ) const {
+        return indices[ packed(i,j) ] >= 0;
+      }
+
+      /** Return the set of species i and j or a blank set if none has been
+       * created. */
+      const Set & operator() ( const unsigned int & i,
+                               const unsigned int & j ) const {
+        const int & k = indices[ packed(i,j) ];
+        if ( k < 0 )
+          return blank;
+        load( k );
+        return sets[k];
+      }
+
+      /** Return the set of species i and j, creating it if necessary. */
+      Set & operator() ( const unsigned int & i, const unsigned int & j ) {
+        int & k = indices[ packed(i,j) ];
+        if ( k < 0 ) {
+          k = static_cast<int>( sets.size() );
+          sets.push_back( Set() );
+          if ( !status.empty() )
+            status.push_back( Status( std::min(i,j), std::max(i,j) ) );
+          addPartner( i, j, k );
+          if ( i != j )
+            addPartner( j, i, k );
+        } else
+          load( k );
+        return sets[k];
+      }
+
+      /** Return the stored set with the given index (see Partner::index). */
+      const Set & operator[] ( const unsigned int & index ) const {
+        load( index );
+        return sets[index];
+      }
+
+      /** Return the stored set with the given index (see Partner::index). */
+      Set & operator[] ( const unsigned int & index ) {
+        load( index );
+        return sets[index];
+      }
+
+      /** The partners of species A that have a stored set. */
+      const PartnerList & partners( const unsigned int & A ) const {
+        return partner_lists[A];
+      }
+
+      /** Mark the set of species i and j (created if necessary) as pending
+       * such that its contents are loaded on first access.  The set is not
+       * loaded if no loader has been set. */
+      void setPending( const unsigned int & i, const unsigned int & j ) {
+        const int & k = indices[ packed(i,j) ];
+        if ( k < 0 )
+          operator()( i, j );
+
+        if ( status.size() != sets.size() ) {
+          /* first pending set:  record the species of all stored sets */
+          status.assign( sets.size(), Status() );
+          for ( unsigned int B = 0u; B < n; ++B )
+            for ( unsigned int A = 0u; A <= B; ++A ) {
+              const int & l = indices[ packed(A,B) ];
+              if ( l >= 0 )
+                status[l] = Status( A, B );
+            }
+        }
+
+        setState( k, PENDING );
+      }
+
+      /** Set the loader of pending sets (NULL to disable loading).  The
+       * loader must remain valid for as long as sets are pending. */
+      void setLoader( const Loader * loader ) { this->loader = loader; }
+
+      /** Return whether the set of species i and j is created and still
+       * pending. */
+      bool isPending( const unsigned int & i, const unsigned int & j ) const {
+        const int & k = indices[ packed(i,j) ];
+        return k >= 0 && !status.empty() && state( k ) != LOADED;
+      }
+
+      /** Load all pending sets. */
+      void loadAll() const {
+        for ( unsigned int k = 0u; k < status.size(); ++k )
+          load( k );
+      }
+
+      /** Remove all stored sets that have no equations.  Pending sets are
+       * kept. */
+      void compact() {
+        SetStorage kept;
+        std::vector<Status> kept_status;
+        std::vector<int> new_indices( indices.size(), -1 );
+        std::vector<PartnerList> new_partners( n );
+
+        for ( unsigned int B = 0u; B < n; ++B ) {
+          for ( unsigned int A = 0u; A <= B; ++A ) {
+            const std::size_t p = packed( A, B );
+            if ( indices[p] < 0 ||
+                 ( sets[ indices[p] ].rhs.empty() &&
+                   ( status.empty() || state( indices[p] ) == LOADED ) ) )
+              continue;
+
+            const unsigned int k = kept.size();
+            kept.push_back( sets[ indices[p] ] );
+            if ( !status.empty() )
+              kept_status.push_back( status[ indices[p] ] );
+            new_indices[p] = k;
+            new_partners[A].push_back( Partner( B, k ) );
+            if ( A != B )
+              new_partners[B].push_back( Partner( A, k ) );
+          }
+        }
+
+        for ( unsigned int A = 0u; A < n; ++A )
+          std::sort( new_partners[A].begin(), new_partners[A].end() );
+
+        sets.swap( kept );
+        indices.swap( new_indices );
+        partner_lists.swap( new_partners );
+        if ( !status.empty() )
+          status.swap( kept_status );
+      }
+
+    private:
+      /** Atomically read the loading state of stored set k.  If the set is
+       * LOADED, the flush makes the contents written by the loading thread
+       * visible to this thread. */
+      int state( const unsigned int & k ) const {
+        int s;
+        #pragma omp atomic read
+        s = status[k].state;
+        if ( s == LOADED ) {
+          #pragma omp flush
+        }
+        return s;
+      }
+
+      /** Atomically write the loading state of stored set k.  The flush
+       * before the write publishes all prior writes (such as the contents of
+       * a loaded set) before the new state can be seen. */
+      void setState( const unsigned int & k, const int & s ) const {
+        #pragma omp flush
+        #pragma omp atomic write
+        status[k].state = s;
+      }
+
+      /** Load stored set k if it is pending.  The loader is called by only
+       * one thread; concurrent accesses wait for it to finish. */
+      void load( const unsigned int & k ) const {
+        if ( status.empty() || state( k ) == LOADED || !loader )
+          return;
+
+        detail::NestLock::Guard guard( load_lock );
+        /* a set that is LOADING here is being loaded by this same thread
+         * (from within Loader::load) and is returned as it is. */
+        if ( state( k ) != PENDING )
+          return;
+
+        setState( k, LOADING );
+        try {
+          loader->load( sets[k], status[k].i, status[k].j );
+        } catch (...) {
+          setState( k, PENDING );
+          throw;
+        }
+        setState( k, LOADED );
+      }
+
+      static std::size_t packed( unsigned int i, unsigned int j ) {
+        if ( i > j )
+          std::swap( i, j );
+        return std::size_t(j) * (j + 1u) / 2u + i;
+      }
+
+      void addPartner( const unsigned int & A,
+                       const unsigned int & B,
+                       const unsigned int & k ) {
+        PartnerList & l = partner_lists[A];
+        l.insert( std::upper_bound( l.begin(), l.end(), Partner( B ) ),
+                  Partner( B, k ) );
+      }
+    };
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_SparseInteractionTable_h
@@ -0,0 +1,174 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Sub-cycling policies for the chimp::interaction::Driver class.
+ */
+
+#ifndef chimp_interaction_SubCycling_h
+#define chimp_interaction_SubCycling_h
+
+#include <chimp/interaction/Driver.h>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+namespace chimp {
+  namespace interaction {
+
+    /** User-specified number of sub-cycles of the time step for the
+     * chimp::interaction::Driver class.
+     *
+     * The number of sub-cycles can be given per species (the number of a pair
+     * is then the larger of the two species values) or per pair of species
+     * (which overrides the species values).  Pairs and species that are not
+     * given are tested once per time step.
+     */
+    struct FixedSubCycling {
+      /* MEMBER STORAGE */
+      /** Number of sub-cycles per species (zero if not given). */
+      std::vector<unsigned int> species_sub;
+
+      /** Number of sub-cycles per pair, packed by column (zero if not
+       * given). */
+      std::vector<unsigned int> pair_sub;
+
+
+      /* MEMBER FUNCTIONS */
+      /** Set the number of sub-cycles of all pairs that include species A. */
+      void setSpecies( const unsigned int & A, const unsigned int & n ) {
+        if ( A >= species_sub.size() )
+          species_sub.resize( A + 1u, 0u );
+        species_sub[A] = n;
+      }
+
+      /** Set the number of sub-cycles of species A and B (A and B may be
+       * swapped). */
+      void setPair( const unsigned int & A,
+                    const unsigned int & B,
+                    const unsigned int & n ) {
+        const std::size_t i = index( A, B );
+        if ( i >= pair_sub.size() )
+          pair_sub.resize( i + 1u, 0u );
+        pair_sub[i] = n;
+      }
+
+      /** Return the user-specified number of sub-cycles of species A and B. */
+      template < typename ChimpDBInteractionSet,
+                 typename CrossSpeciesInfo >
+      unsigned int get( const ChimpDBInteractionSet & /* eqset */,
+                        CrossSpeciesInfo & /* info */,
+                        const int & A,
+                        const int & B,
+                        const double & /* number_tests */,
+                        const std::size_t & /* nA */,
+                        const std::size_t & /* nB */ ) const {
+        return fixed( A, B );
+      }
+
+      /** Return the user-specified number of sub-cycles of species A and B
+       * (at least one). */
+      unsigned int fixed( const unsigned int & A,
+                          const unsigned int & B ) const {
+        const std::size_t i = index( A, B );
+        if ( i < pair_sub.size() && pair_sub[i] > 0u )
+          return pair_sub[i];
+
+        return std::max( 1u, std::max( speciesSub(A), speciesSub(B) ) );
+      }
+
+    private:
+      unsigned int speciesSub( const unsigned int & A ) const {
+        return A < species_sub.size() ? species_sub[A] : 0u;
+      }
+
+      static std::size_t index( unsigned int A, unsigned int B ) {
+        if ( A > B )
+          std::swap( A, B );
+        return std::size_t(B) * (B + 1u) / 2u + A;
+      }
+    };
+
+
+    /** Automatic selection of the number of sub-cycles of the time step for
+     * the chimp::interaction::Driver class.
+     *
+     * The number of sub-cycles of a pair of species is chosen such that the
+     * expected number of collision tests per particle of either species,
+     * \f$ n \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} \Delta t \f$,
+     * does not exceed max_tests_per_particle within one sub-cycle.  Pairs with
+     * a small collision frequency (e.g. neutral-neutral) are thus tested once
+     * per time step while pairs with a large collision frequency (e.g.
+     * electron-neutral) are tested in several sub-cycles, each with the
+     * populations that result from the previous sub-cycle.
+     *
+     * The values given by the FixedSubCycling interface act as lower bounds.
+     */
+    struct AutoSubCycling : FixedSubCycling {
+      /* MEMBER STORAGE */
+      /** Largest expected number of collision tests per particle and
+       * sub-cycle.  [Default:  0.2] */
+      double max_tests_per_particle;
+
+      /** Largest number of sub-cycles per time step.  [Default:  1000] */
+      unsigned int max_sub_cycles;
+
+
+      /* MEMBER FUNCTIONS */
+      AutoSubCycling( const double & max_tests_per_particle = 0.2,
+                      const unsigned int & max_sub_cycles = 1000u )
+        : max_tests_per_particle( max_tests_per_particle ),
+          max_sub_cycles( max_sub_cycles ) { }
+
+      /** Return the number of sub-cycles of species A and B. */
+      template < typename ChimpDBInteractionSet,
+                 typename CrossSpeciesInfo >
+      unsigned int get( const ChimpDBInteractionSet & /* eqset */,
+                        CrossSpeciesInfo & /* info */,
+                        const int & A,
+                        const int & B,
+                        const double & number_tests,
+                        const std::size_t & nA,
+                        const std::size_t & nB ) const {
+        const unsigned int n_fixed = fixed( A, B );
+
+        const std::size_t n_min = std::min( nA, nB );
+        if ( n_min == 0u || max_tests_per_particle <= 0.0 )
+          return n_fixed;
+
+        /* each test of identical species involves two particles. */
+        const double tests_per_particle =
+          number_tests * ( A == B ? 2.0 : 1.0 ) / n_min;
+
+        const double n_auto =
+          std::ceil( tests_per_particle / max_tests_per_particle );
+        if ( n_auto >= max_sub_cycles )
+          return std::max( n_fixed, max_sub_cycles );
+
+        return std::max( n_fixed, static_cast<unsigned int>( n_auto ) );
+      }
+    };
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_SubCycling_h
@@ -28,6 +28,7 @@
 #ifndef chimp_interaction_Term_h
 #define chimp_interaction_Term_h
 
+#include <chimp/BinaryCache.h>
 #include <chimp/property/name.h>
 #include <chimp/property/mass.h>
 
@@ -155,6 +156,25 @@ namespace chimp {
             "incorrect number of 'from' or 'ops' items" );
       }
 
+      /** Save the Term to a binary cache. */
+      void save( BinaryWriter & out ) const {
+        out.write( species );
+        out.write( n );
+        out.write( from );
+        out.write( product_ops );
+      }
+
+      /** Load a Term from a binary cache. */
+      static Term load( BinaryReader & in ) {
+        const int species = in.get<int>();
+        const int n = in.get<int>();
+        std::vector< int > from;
+        std::vector< std::string > product_ops;
+        in.read( from );
+        in.read( product_ops );
+        return Term( species, from, product_ops, n );
+      }
+
       /** Term stream printer. */
       template <class RnDB>
       std::ostream & print(std::ostream & out, const RnDB & db) const {
@@ -0,0 +1,192 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Variable-weight no-time-counter (Schmidt & Rutland) weighting policy for the
+ * chimp::interaction::Driver class.
+ */
+
+#ifndef chimp_interaction_VariableWeightNTC_h
+#define chimp_interaction_VariableWeightNTC_h
+
+#include <chimp/accessors.h>
+#include <chimp/interaction/ProductSink.h>
+
+#include <iterator>
+#include <algorithm>
+#include <utility>
+
+namespace chimp {
+  namespace interaction {
+
+    /** Variable-weight no-time-counter weighting policy for the
+     * chimp::interaction::Driver class, following the scheme of Schmidt and
+     * Rutland.
+     *
+     * Particles may each carry a different weight (see
+     * chimp::accessors::particle::weight).  The number of collision tests of a
+     * pair of species is computed from the largest weight W found among the
+     * particles of both species:
+     * \f$ N_{\rm test} = W N_a N_b \Delta t
+     *    \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} / V \f$.
+     * Each selected pair (with weights \f$w_{\rm lo} \le w_{\rm hi}\f$) is then
+     * accepted with probability
+     * \f$ \sigma_{\rm T} v_{\rm rel} w_{\rm hi} /
+     *     \left[ \left( \sigma_{\rm T} v_{\rm rel} \right)_{\rm max} W \right]\f$.
+     *
+     * For accepted pairs of unequal weight, only the fraction
+     * \f$ w_{\rm lo}/w_{\rm hi} \f$ of the heavier particle interacts.  How
+     * this is accounted for depends on what the interaction model actually did:
+     *  - If the interaction created products, all products are given the
+     *    weight \f$ w_{\rm lo} \f$ and a pre-collision copy of the heavier
+     *    particle is appended to the products with the remaining weight
+     *    \f$ w_{\rm hi} - w_{\rm lo} \f$.  If the model also modified the
+     *    heavier particle in place, that particle is given the weight
+     *    \f$ w_{\rm lo} \f$.  Mass, momentum, and energy are thus conserved
+     *    exactly.
+     *  - If the interaction only modified the particles in place, the heavier
+     *    particle keeps its post-collision state only with probability
+     *    \f$ w_{\rm lo}/w_{\rm hi} \f$ and is otherwise restored to its
+     *    pre-collision state (Bird).  Conservation is thus obtained only on
+     *    average.
+     *  .
+     *
+     * Use this policy by passing it as the third template parameter of
+     * chimp::interaction::Driver (or chimp::interaction::ParallelDriver).
+     */
+    struct VariableWeightNTC {
+
+      /** Calculate the weight factor W (the largest weight of all particles in
+       * both species ranges).  Returns zero if either range is empty. */
+      template < typename SpeciesRange >
+      double weightFactor( const SpeciesRange & aRange,
+                           const SpeciesRange & bRange ) const {
+        if ( aRange.size() == 0u || bRange.size() == 0u )
+          return 0.0;
+
+        return std::max( maxWeight( aRange ), maxWeight( bRange ) );
+      }
+
+      /** Test (and possibly execute) an interaction of the given pair.  The
+       * total sigma*v of the pair is returned in sigma_relspeed.
+       * @see VariableWeightNTC class documentation.
+       */
+      template < typename ChimpDBInteractionSet,
+                 typename PIter,
+                 typename BackInsertionSequence,
+                 typename RNG >
+      std::pair<int,double>
+      interact( const ChimpDBInteractionSet & eqset,
+                const double & m_s_v,
+                const double & weight_factor,
+                const std::pair<PIter, PIter> & pair,
+                BackInsertionSequence & result_list,
+                RNG & rng,
+                double & sigma_relspeed ) const {
+        typedef typename std::iterator_traits<PIter>::value_type Particle;
+        using chimp::accessors::particle::weight;
+        using chimp::accessors::particle::setWeight;
+
+        const double wA = weight(*pair.first),
+                     wB = weight(*pair.second);
+        const PIter heavy = ( wA < wB ) ? pair.second : pair.first;
+        const double w_hi = std::max( wA, wB ),
+                     w_lo = std::min( wA, wB );
+
+        if ( !( w_hi > 0.0 ) )
+          return std::make_pair(-1,0.0);
+
+        /* scale (sigma*v)_max such that the acceptance probability of this
+         * pair is s*v / (s*v)_max  *  w_hi / W. */
+        const double scaled_m_s_v = m_s_v * weight_factor / w_hi;
+
+        if ( w_lo == w_hi )
+          return eqset.interact( scaled_m_s_v, pair, result_list, rng,
+                                 sigma_relspeed );
+
+        const Particle original = *heavy;
+        const std::size_t sz_i = result_list.size();
+
+        std::pair<int,double> path =
+          eqset.interact( scaled_m_s_v, pair, result_list, rng,
+                                 sigma_relspeed );
+
+        if ( path.first < 0 )
+          return path;
+
+        const bool changed = modified( *heavy, original );
+
+        if ( result_list.size() > sz_i ) {
+          /* products carry the lighter weight while the non-interacting
+           * remainder of the heavier particle is retained. */
+          detail::AsProductSink< Particle, BackInsertionSequence >
+            products( result_list );
+          for ( std::size_t i = sz_i, n = products().size(); i < n; ++i )
+            setWeight( products()[i], w_lo );
+
+          if ( changed )
+            /* the heavier particle was also changed in place:  only the
+             * interacting fraction keeps the post-collision state. */
+            setWeight( *heavy, w_lo );
+
+          setWeight( products().append( original ), w_hi - w_lo );
+        } else if ( changed && rng.rand() * w_hi >= w_lo ) {
+          /* in-place:  the heavier particle only interacts with probability
+           * w_lo / w_hi. */
+          *heavy = original;
+        }
+
+        return path;
+      }
+
+    private:
+      /** Whether the interaction changed the particle in place. */
+      template < typename Particle >
+      static bool modified( const Particle & p, const Particle & original ) {
+        using chimp::accessors::particle::position;
+        using chimp::accessors::particle::velocity;
+        using chimp::accessors::particle::species;
+
+        return species(p) != species(original) ||
+               !( velocity(p) == velocity(original) ) ||
+               !( position(p) == position(original) );
+      }
+
+      /** The largest weight in the given range of particles. */
+      template < typename SpeciesRange >
+      static double maxWeight( const SpeciesRange & range ) {
+        using chimp::accessors::particle::weight;
+
+        double w = 0.0;
+        for ( typename SpeciesRange::iterator i = range.begin(),
+                                            end = range.end();
+              i != end; ++i )
+          w = std::max( w, static_cast<double>( weight(*i) ) );
+        return w;
+      }
+    };
+
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_VariableWeightNTC_h
@@ -43,12 +43,17 @@
 #ifndef chimp_interaction_cross_section_Base_h
 #define chimp_interaction_cross_section_Base_h
 
+#include <chimp/BinaryCache.h>
+
 #include <xylose/xml/Doc.h>
 #include <xylose/compat/math.hpp>
 
 #include <physical/physical.h>
 
 #include <vector>
+#include <string>
+#include <cstddef>
+#include <stdexcept>
 
 
 namespace chimp {
@@ -76,6 +81,26 @@ namespace chimp {
          * */
         virtual double operator() (const double & v_relative) const  = 0;
 
+        /** Compute the cross section for each of an array of relative
+         * velocities.  The virtual dispatch is thus paid once per block of
+         * values instead of once per value.  The default implementation calls
+         * operator() for each value; implementations override this with a
+         * loop that the compiler can vectorize.
+         *
+         * @param v_relative
+         *     Array of n relative velocities.
+         * @param sigma
+         *     Array of n values into which the cross sections are written.
+         * @param n
+         *     Number of values.
+         * */
+        virtual void evaluate( const double * v_relative,
+                               double * sigma,
+                               const std::size_t & n ) const {
+          for ( std::size_t i = 0u; i < n; ++i )
+            sigma[i] = this->operator()( v_relative[i] );
+        }
+
         /** Obtain the threshold energy for this cross section.  The units are
          * such that (getThresholdEnergy() / mass ) has the units of [velocity]^2
          * where [velocity] are the units as used in operator()(v_relative). */
@@ -106,9 +131,47 @@ namespace chimp {
                                  const interaction::Equation<options> & eq,
                                  const RuntimeDB<options> & db ) const = 0;
 
+        /** Complete the construction of a cross section that was loaded by
+         * new_load(const xml::Context &, ...).  new_load only does the work
+         * that requires the units calculator (and whatever the interaction
+         * model needs, such as the threshold), while the rest, such as
+         * root-finding and lookup tables, is done here.  RuntimeDB thus
+         * initializes many cross sections concurrently.
+         *
+         * The default implementation does nothing.
+         * */
+        virtual void initialize() { }
+
         /** Obtain the label of the model. */
         virtual std::string getLabel() const = 0;
 
+        /** Save this instance to a binary cache.  Implementations must first
+         * write the label of the class that is to be used to load the data
+         * again (see new_load(BinaryReader&,...)), followed by all data
+         * required to reconstruct the cross section without the xml data set.
+         *
+         * The default implementation throws std::runtime_error.
+         * */
+        virtual void save( BinaryWriter & out ) const {
+          throw std::runtime_error(
+            "cross section '" + getLabel() + "' cannot be saved to a binary "
+            "cache" );
+        }
+
+        /** Load a new instance of cross_section::Base from a binary cache.  The
+         * label written by save(BinaryWriter&) has already been read from the
+         * cache.
+         *
+         * The default implementation throws std::runtime_error.
+         * */
+        virtual Base * new_load( BinaryReader & in,
+                                 const interaction::Equation<options> & eq,
+                                 const RuntimeDB<options> & db ) const {
+          throw std::runtime_error(
+            "cross section '" + getLabel() + "' cannot be loaded from a "
+            "binary cache" );
+        }
+
       };
 
 
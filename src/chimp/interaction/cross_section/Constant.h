@@ -125,6 +125,14 @@ namespace chimp {
             return 0.0;
         }
 
+        /** Compute the cross section for an array of relative velocities. */
+        virtual void evaluate( const double * v_relative,
+                               double * sigma,
+                               const std::size_t & n ) const {
+          for ( std::size_t i = 0u; i < n; ++i )
+            sigma[i] = v_relative[i] >= threshold_v ? value : 0.0;
+        }
+
         /** Obtain the threshold energy for this cross section.  The units are
          * such that (getThresholdEnergy() / mass ) has the units of [velocity]^2
          * where [velocity] are the units as used in operator()(v_relative). */
@@ -157,6 +165,21 @@ namespace chimp {
           return new Constant( x, eq.reducedMass );
         }
 
+        /** Save the constant value and threshold to a binary cache. */
+        virtual void save( BinaryWriter & out ) const {
+          out.write( label );
+          out.write( value );
+          out.write( threshold_E );
+        }
+
+        /** Load the constant value and threshold from a binary cache. */
+        virtual Constant * new_load( BinaryReader & in,
+                                     const interaction::Equation<options> & eq,
+                                     const RuntimeDB<options> & db ) const {
+          const double value = in.get<double>();
+          return new Constant( value, eq.reducedMass, in.get<double>() );
+        }
+
         /** Obtain the label of the model. */
         virtual std::string getLabel() const {
           return label;
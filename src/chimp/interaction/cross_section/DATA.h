@@ -30,6 +30,7 @@
 
 #include <chimp/interaction/cross_section/Base.h>
 #include <chimp/interaction/cross_section/detail/logE_E.h>
+#include <chimp/interaction/cross_section/detail/LookupTable.h>
 #include <chimp/interaction/Equation.h>
 #include <chimp/interaction/ReducedMass.h>
 
@@ -43,6 +44,8 @@
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
+#include <utility>
 
 #include <cstdlib>
 
@@ -81,8 +84,14 @@ namespace chimp {
 
         /* MEMBER STORAGE */
       private:
-        /** Table of cross-section data. */
-        DoubleDataSet table;
+        /** Table of cross-section data, stored contiguously with a bucket
+         * index that is used for all evaluations of the cross section.  The
+         * first entry is the threshold. */
+        detail::LookupTable lookup;
+
+        /** Running maximum of (v * sigma(v), v) over the table entries
+         * [0, i] for each i.  */
+        std::vector< std::pair<double,double> > max_sigma_v;
 
         /** Extrapolation coefficient C in C*b*ln(a*(v^2-v0^2+b)/(a*(v^2-v0^2+b). */
         double C;
@@ -115,15 +124,15 @@ namespace chimp {
         /** Constructor with the reduced mass already specified. */
         DATA( const xml::Context & x,
               const ReducedMass & mu )
-          : table( loadCrossSectionData(x, mu ) ), mu( mu ) {
-          init();
+          : mu( mu ) {
+          init( loadCrossSectionData(x, mu) );
         }
 
         /** Constructor to initialize the cross section data by copying from a
          * set of data previously loaded. */
         DATA( const DoubleDataSet & table )
-          : cross_section::Base<options>(), table( table ) {
-          init();
+          : cross_section::Base<options>() {
+          init( table );
         }
 
         /** Virtual NO-OP destructor. */
@@ -136,7 +145,17 @@ namespace chimp {
          * */
         inline virtual double operator() (const double & v_relative) const {
           /* find the first entry not less that v_relative */
-          return this->eval( table.lower_bound(v_relative), v_relative );
+          return this->eval( lookup.lower_bound(v_relative), v_relative );
+        }
+
+        /** Interpolate the cross-section for an array of relative velocities.
+         * */
+        virtual void evaluate( const double * v_relative,
+                               double * sigma,
+                               const std::size_t & n ) const {
+          for ( std::size_t i = 0u; i < n; ++i )
+            sigma[i] = this->eval( lookup.lower_bound(v_relative[i]),
+                                   v_relative[i] );
         }
 
         /** Obtain the threshold energy for this cross section.  The units are
@@ -144,14 +163,14 @@ namespace chimp {
          * where [velocity] are the units as used in operator()(v_relative). */
         virtual double getThresholdEnergy() const {
           using xylose::SQR;
-          return 0.5 * mu.value * SQR(table.begin()->first);
+          return 0.5 * mu.value * SQR(lookup.x.front());
         }
 
         /** Obtain the threshold energy for this cross section.  The units are
          * such that (getThresholdEnergy() / mass ) has the units of [velocity]^2
          * where [velocity] are the units as used in operator()(v_relative). */
         virtual double getThresholdVelocity() const {
-          return table.begin()->first;
+          return lookup.x.front();
         }
 
         /** Determine by inspection the maximum value of the product v_rel *
@@ -164,18 +183,12 @@ namespace chimp {
          */
         virtual std::pair<double,double>
         findMaxSigmaV(const double & v_rel_max) const {
-          /* search through the data within the range [0:v_rel_max) to find
-           * maximum product. */
-          std::pair<double,double> retval = std::make_pair(0.0,0.0);
-          /* find the first entry not less than v_rel_max */
-          const DoubleDataSet::const_iterator e = table.lower_bound(v_rel_max);
-          for (DoubleDataSet::const_iterator i = table.begin(); i != e; ++i) {
-            double prod_i = i->first * i->second;
-            if (retval.first < prod_i) {
-              retval.first = prod_i;
-              retval.second = i->first;
-            }
-          }
+          /* the maximum product of the data within the range [0:v_rel_max)
+           * is given by the running maximum up to the entry before the first
+           * entry not less than v_rel_max. */
+          const std::size_t e = lookup.lower_bound(v_rel_max);
+          std::pair<double,double> retval =
+            e > 0u ? max_sigma_v[e-1u] : std::make_pair(0.0,0.0);
 
           /* make one last ditch effort to find (v*sigma)_max by determining the
            * interpolated/extrapolated value and comparing the result.
@@ -196,7 +209,62 @@ namespace chimp {
         virtual DATA * new_load( const xml::Context & x,
                                  const interaction::Equation<options> & eq,
                                  const RuntimeDB<options> & db ) const {
-          return new DATA( x, eq.reducedMass );
+          /* the extrapolation coefficients and the maxima are left to
+           * initialize(). */
+          DATA * retval = new DATA;
+          retval->mu = eq.reducedMass;
+          DoubleDataSet table = loadCrossSectionData( x, eq.reducedMass );
+          checkThreshold( table );
+          retval->lookup.assign( table );
+          return retval;
+        }
+
+        /** Compute the extrapolation coefficients and the running maxima of
+         * v * sigma(v) of a table that was loaded by new_load. */
+        virtual void initialize() {
+          setCoeffs();
+          setMaxSigmaV();
+        }
+
+        /** Save the (already converted and checked) table and the
+         * extrapolation coefficients to a binary cache.  Classes derived from
+         * DATA (such as AveragedDiameters) are thus reloaded as DATA. */
+        virtual void save( BinaryWriter & out ) const {
+          out.write( label );
+          out.write( static_cast<unsigned int>( lookup.size() ) );
+          for ( std::size_t i = 0u; i < lookup.size(); ++i ) {
+            out.write( lookup.x[i] );
+            out.write( lookup.y[i] );
+          }
+          out.write( C );
+          out.write( a );
+          out.write( b );
+          out.write( v02 );
+        }
+
+        /** Load the table and extrapolation coefficients from a binary cache.
+         * */
+        virtual DATA * new_load( BinaryReader & in,
+                                 const interaction::Equation<options> & eq,
+                                 const RuntimeDB<options> & db ) const {
+          DATA * retval = new DATA;
+          retval->mu = eq.reducedMass;
+
+          const unsigned int n = in.get<unsigned int>();
+          retval->lookup.x.resize( n );
+          retval->lookup.y.resize( n );
+          for ( unsigned int i = 0u; i < n; ++i ) {
+            in.read( retval->lookup.x[i] );
+            in.read( retval->lookup.y[i] );
+          }
+
+          in.read( retval->C );
+          in.read( retval->a );
+          in.read( retval->b );
+          in.read( retval->v02 );
+          retval->lookup.index();
+          retval->setMaxSigmaV();
+          return retval;
         }
 
         /** Obtain the label of the model. */
@@ -206,7 +274,8 @@ namespace chimp {
 
         /** Print the cross section data table. */
         std::ostream & print(std::ostream & out) const {
-          out << table;
+          for ( std::size_t i = 0u; i < lookup.size(); ++i )
+            out << lookup.x[i] << '\t' << lookup.y[i] << '\n';
           return out;
         }
 
@@ -214,8 +283,7 @@ namespace chimp {
         void setTable( const DoubleDataSet & table,
                        const ReducedMass & mu ) {
           this->mu = mu;
-          this->table = table;
-          init();
+          init( table );
         }
 
         /** return the number of extrapolations performed till now. */
@@ -224,12 +292,29 @@ namespace chimp {
         }
 
       private:
-        void init() {
-          checkThreshold();
-          setCoeffs();
+        /** Check the threshold of the table, copy it into the lookup table,
+         * and initialize. */
+        void init( DoubleDataSet table ) {
+          checkThreshold( table );
+          lookup.assign( table );
+          DATA::initialize();
         }
 
-        void checkThreshold() {
+        /** Compute the running maximum of v * sigma(v) over the table. */
+        void setMaxSigmaV() {
+          max_sigma_v.resize( lookup.size() );
+          std::pair<double,double> m = std::make_pair(0.0,0.0);
+          for ( std::size_t i = 0u; i < lookup.size(); ++i ) {
+            double prod_i = lookup.x[i] * lookup.y[i];
+            if (m.first < prod_i) {
+              m.first = prod_i;
+              m.second = lookup.x[i];
+            }
+            max_sigma_v[i] = m;
+          }
+        }
+
+        static void checkThreshold( DoubleDataSet & table ) {
           using namespace xylose::logger;
           /* this funcion checks whether the first element is the threshold.  It
            * is the threshold if it or the next element's sigma value is
@@ -276,27 +361,26 @@ namespace chimp {
                 ! options::cross_section_data_extrapolation_allowed ) )
             return;
 
-          if (table.size() == 2u) {
+          const std::size_t n = lookup.size();
+          if (n == 2u) {
             /* we really shouldn't have data like this, but... */
             // FIXME:  set coeffs for linear extrap?
             return;
-          } else if (table.size() < 2u) {
+          } else if (n < 2u) {
             return;
           }
 
           /* We'll try for the last three points, if we have that many. */
-          DoubleDataSet::iterator d0 = table.end(),
-                                  d1 = table.end(),
-                                  d2 = table.end();
-          --d2;
-          --d1; --d1;
-          --d0; --d0; --d0;
-
-          if ( d2->second == 0.0 )
+          const std::pair<double,double>
+            d0( lookup.x[n-3u], lookup.y[n-3u] ),
+            d1( lookup.x[n-2u], lookup.y[n-2u] ),
+            d2( lookup.x[n-1u], lookup.y[n-1u] );
+
+          if ( d2.second == 0.0 )
             /* extrapolation not needed as data goes to zero. */
             return;
 
-          xylose::Vector<double,4u> Cabv2 = detail::getCab_coeffs( *d0, *d1, *d2 );
+          xylose::Vector<double,4u> Cabv2 = detail::getCab_coeffs( d0, d1, d2 );
           C   = Cabv2[0];
           a   = Cabv2[1];
           b   = Cabv2[2];
@@ -305,20 +389,23 @@ namespace chimp {
 
         /** Do the actual work of evaluating the cross section, with the initial
          * lookup already done.  i is assumed to be the result of
-         * table.lower_bound(v_relative). */
-        inline double eval( DoubleDataSet::const_iterator i,
+         * lookup.lower_bound(v_relative). */
+        inline double eval( std::size_t i,
                             const double & v_relative ) const {
           using xylose::SQR;
 
-          if      (i==table.begin()) {
+          const double * x = &lookup.x[0];
+          const double * y = &lookup.y[0];
+
+          if      (i==0u) {
             /* Assume that the data begins at a threshold value */
-            if ( i->first == v_relative )
-              return i->second;
+            if ( x[0] == v_relative )
+              return y[0];
             else
               return 0.0;
-          } else if (i==table.end()) {
+          } else if (i==lookup.size()) {
             --i;
-            if ( i->second == 0.0 )
+            if ( y[i] == 0.0 )
               /* the data actually says to stay at zero--no extrap. required.*/
               return 0.0;
 
@@ -340,14 +427,14 @@ namespace chimp {
             using detail::f;
             return f(SQR(v_relative) - v02, C, a, b);
           } else {
-            DoubleDataSet::const_iterator f = i;
+            const std::size_t f = i;
             --i;
             /* we are not at the ends of the data, so use the normal lever rule.
              * TODO:  Do we need to do the L_inv mult befoe the add to avoid
              * precision errors?  Does our data ever require this? */
-            double L_inv = 1.0/(f->first - i->first);
-            return   i->second * L_inv * (f->first - v_relative) +
-                     f->second * L_inv * (v_relative - i->first);
+            double L_inv = 1.0/(x[f] - x[i]);
+            return   y[i] * L_inv * (x[f] - v_relative) +
+                     y[f] * L_inv * (v_relative - x[i]);
           }
         }
       };
@@ -125,6 +125,18 @@ namespace chimp {
           return param.value_vref / v_relative ;
         }
 
+        /** Compute the cross section for an array of relative velocities.
+         * @see operator()(const double &).
+         * */
+        virtual void evaluate( const double * v_relative,
+                               double * sigma,
+                               const std::size_t & n ) const {
+          for ( std::size_t i = 0u; i < n; ++i ) {
+            const double s = param.value_vref / v_relative[i];
+            sigma[i] = v_relative[i] < threshold_v ? 0.0 : s;
+          }
+        }
+
         /** Obtain the threshold energy for this cross section.  The units are
          * such that (getThresholdEnergy() / mass ) has the units of [velocity]^2
          * where [velocity] are the units as used in operator()(v_relative). */
@@ -152,6 +164,23 @@ namespace chimp {
           return new Inverse( x, eq.reducedMass );
         }
 
+        /** Save the Inverse parameters to a binary cache. */
+        virtual void save( BinaryWriter & out ) const {
+          out.write( label );
+          out.write( param );
+          out.write( threshold_E );
+        }
+
+        /** Load the Inverse parameters from a binary cache. */
+        virtual Inverse * new_load( BinaryReader & in,
+                                    const interaction::Equation<options> & eq,
+                                    const RuntimeDB<options> & db ) const {
+          Inverse * retval = new Inverse;
+          in.read( retval->param );
+          retval->setThresholdEnergy( in.get<double>(), eq.reducedMass );
+          return retval;
+        }
+
         /** Obtain the label of the model. */
         virtual std::string getLabel() const {
           return label;
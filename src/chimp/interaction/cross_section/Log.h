@@ -127,6 +127,19 @@ namespace chimp {
           return param.A - param.B * log10( v_relative );
         }
 
+        /** Compute the cross section for an array of relative velocities.
+         * @see operator()(const double &).
+         * */
+        virtual void evaluate( const double * v_relative,
+                               double * sigma,
+                               const std::size_t & n ) const {
+          using std::log10;
+          for ( std::size_t i = 0u; i < n; ++i ) {
+            const double s = param.A - param.B * log10( v_relative[i] );
+            sigma[i] = v_relative[i] < threshold_v ? 0.0 : s;
+          }
+        }
+
         /** Obtain the threshold energy for this cross section.  The units are
          * such that (getThresholdEnergy() / mass ) has the units of [velocity]^2
          * where [velocity] are the units as used in operator()(v_relative). */
@@ -153,6 +166,23 @@ namespace chimp {
           return new Log( x, eq.reducedMass );
         }
 
+        /** Save the Log parameters to a binary cache. */
+        virtual void save( BinaryWriter & out ) const {
+          out.write( label );
+          out.write( param );
+          out.write( threshold_E );
+        }
+
+        /** Load the Log parameters from a binary cache. */
+        virtual Log * new_load( BinaryReader & in,
+                                const interaction::Equation<options> & eq,
+                                const RuntimeDB<options> & db ) const {
+          Log * retval = new Log;
+          in.read( retval->param );
+          retval->setThresholdEnergy( in.get<double>(), eq.reducedMass );
+          return retval;
+        }
+
         /** Obtain the label of the model. */
         virtual std::string getLabel() const {
           return label;
@@ -113,6 +113,13 @@ namespace chimp {
             maxSigmaV(0),
             sigmaV_max_vrel( std::numeric_limits<double>::infinity() ),
             mu( mu ) {
+          findThreshold();
+          initialize();
+        }
+
+        /** Determine the threshold of the cross section. */
+        void findThreshold() {
+          this->threshold = 0.0;
           using boost::math::tools::toms748_solve;
           boost::math::tools::eps_tolerance<double> tol(64);
           typedef typename ParametersVector::const_iterator CIter;
@@ -147,8 +154,13 @@ namespace chimp {
               this->threshold = z.second;
             }
           }
+        }
 
-
+        /** Search for the maximum of v*sigma(v) over (threshold, infinity].
+         * Requires the threshold (see findThreshold). */
+        virtual void initialize() {
+          using boost::math::tools::toms748_solve;
+          boost::math::tools::eps_tolerance<double> tol(64);
           {
             /* Second, do a search for the zero-crossing of D[v*sigma, v] over the
              * range (threshold, infinity] */
@@ -202,6 +214,41 @@ namespace chimp {
           return sigma;
         }
 
+        /** Compute the cross section for an array of relative velocities.  The
+         * loop over the Lotz parameters is the outer loop such that the inner
+         * loop over the velocities can be vectorized.  The terms are summed in
+         * the same order as in operator()(const double &), but a*q/P^2 is
+         * computed once for each set of parameters, such that the results may
+         * differ from those of operator()(const double &) in the last few
+         * bits.
+         * */
+        virtual void evaluate( const double * v_relative,
+                               double * sigma,
+                               const std::size_t & n ) const {
+          for ( std::size_t k = 0u; k < n; ++k )
+            sigma[k] = 0.0;
+
+          typedef typename ParametersVector::const_iterator CIter;
+          CIter end = parameters.end();
+          for ( CIter i = parameters.begin(); i != end; ++i ) {
+            using std::log;
+            using std::exp;
+            using xylose::SQR;
+            Parameters const & p = *i;
+            const double aq_P2 = p.a * p.q / SQR(p.P);
+            for ( std::size_t k = 0u; k < n; ++k ) {
+              const double v2Beta = SQR(v_relative[k]) * p.beta;
+              sigma[k] += aq_P2
+                        * log( v2Beta ) / v2Beta
+                        * ( 1 - p.b * exp( -p.c * ( v2Beta - 1 ) ) );
+            }
+          }
+
+          for ( std::size_t k = 0u; k < n; ++k )
+            if ( v_relative[k] < this->threshold )
+              sigma[k] = 0.0;
+        }
+
         /** Obtain the threshold energy for this cross section.  The units are
          * such that (getThresholdEnergy() / mass ) has the units of [velocity]^2
          * where [velocity] are the units as used in operator()(v_relative). */
@@ -231,7 +278,38 @@ namespace chimp {
         virtual Lotz * new_load( const xml::Context & x,
                                  const interaction::Equation<options> & eq,
                                  const RuntimeDB<options> & db ) const {
-          return new Lotz( x, eq.reducedMass );
+          /* only the threshold is determined here since the interaction
+           * model may depend on it.  The search for (v*sigma)_max is left to
+           * initialize(). */
+          Lotz * retval = new Lotz;
+          retval->parameters = x.parse< ParametersVector >();
+          retval->mu = eq.reducedMass;
+          retval->findThreshold();
+          return retval;
+        }
+
+        /** Save the Lotz parameters and the cached threshold and (v*sigma)_max
+         * to a binary cache. */
+        virtual void save( BinaryWriter & out ) const {
+          out.write( label );
+          out.write( parameters );
+          out.write( threshold );
+          out.write( maxSigmaV );
+          out.write( sigmaV_max_vrel );
+        }
+
+        /** Load the Lotz parameters from a binary cache without repeating the
+         * root-finding done by the xml constructor. */
+        virtual Lotz * new_load( BinaryReader & in,
+                                 const interaction::Equation<options> & eq,
+                                 const RuntimeDB<options> & db ) const {
+          Lotz * retval = new Lotz;
+          in.read( retval->parameters );
+          in.read( retval->threshold );
+          in.read( retval->maxSigmaV );
+          in.read( retval->sigmaV_max_vrel );
+          retval->mu = eq.reducedMass;
+          return retval;
         }
 
         /** Obtain the label of the model. */
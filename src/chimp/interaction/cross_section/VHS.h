@@ -41,6 +41,7 @@
 
 #include <ostream>
 #include <limits>
+#include <cmath>
 
 namespace chimp {
   namespace xml = xylose::xml;
@@ -140,6 +141,34 @@ namespace chimp {
             * vhs.gamma_visc_inv;
         }
 
+        /** Compute the cross section for an array of relative velocities.
+         * The power is computed with std::pow (rather than xylose::fast_pow
+         * of operator()(const double &)) such that the loop can be
+         * vectorized.
+         * @see operator()(const double &).
+         * */
+        virtual void evaluate( const double * v_relative,
+                               double * sigma,
+                               const std::size_t & n ) const {
+          using physical::constant::si::K_B;
+          using xylose::SQR;
+
+          const double two_K_T = 2.0 * K_B * vhs.T_ref;
+          const double expnt   = vhs.visc_T_law - 0.5;
+          const double sigma0  = vhs.cross_section * vhs.gamma_visc_inv;
+          for ( std::size_t i = 0u; i < n; ++i ) {
+            const double s =
+                sigma0
+              * std::pow(
+                  ( two_K_T
+                    / ( mu.value * SQR(v_relative[i])
+                        + std::numeric_limits<double>::min()
+                      )
+                  ), expnt);
+            sigma[i] = v_relative[i] < threshold_v ? 0.0 : s;
+          }
+        }
+
         /** Obtain the threshold energy for this cross section.  The units are
          * such that (getThresholdEnergy() / mass ) has the units of [velocity]^2
          * where [velocity] are the units as used in operator()(v_relative). */
@@ -166,6 +195,24 @@ namespace chimp {
           return new VHS( x, eq.reducedMass );
         }
 
+        /** Save the VHS parameters to a binary cache. */
+        virtual void save( BinaryWriter & out ) const {
+          out.write( label );
+          out.write( vhs );
+          out.write( threshold_E );
+        }
+
+        /** Load the VHS parameters from a binary cache. */
+        virtual VHS * new_load( BinaryReader & in,
+                                const interaction::Equation<options> & eq,
+                                const RuntimeDB<options> & db ) const {
+          VHS * retval = new VHS;
+          in.read( retval->vhs );
+          retval->mu = eq.reducedMass;
+          retval->setThresholdEnergy( in.get<double>(), eq.reducedMass );
+          return retval;
+        }
+
         /** Obtain the label of the model. */
         virtual std::string getLabel() const {
           return label;
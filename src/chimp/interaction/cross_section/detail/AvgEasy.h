@@ -119,6 +119,15 @@ namespace chimp {
             throw std::runtime_error("AvgEasy::new_load not yet useful");
           }
 
+          /** Save both sub-cross-sections to a binary cache.  The label of
+           * AvgEasy is recognized by RuntimeDB::loadCrossSection, which
+           * recombines the two sub-cross-sections that follow it. */
+          virtual void save( BinaryWriter & out ) const {
+            out.write( label );
+            cs0->save( out );
+            cs1->save( out );
+          }
+
           /** Obtain the label of the model. */
           virtual std::string getLabel() const {
             return label;
@@ -0,0 +1,153 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Flat (contiguous) sorted table with a bucket index for constant-time
+ * lookups.
+ * */
+
+#ifndef chimp_interaction_cross_section_detail_LookupTable_h
+#define chimp_interaction_cross_section_detail_LookupTable_h
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace chimp {
+  namespace interaction {
+    namespace cross_section {
+      namespace detail {
+
+        /** Sorted table of (x,y) pairs stored in two contiguous arrays.  A set
+         * of uniformly spaced buckets over [x.front(), x.back()] maps any
+         * value to the range of table entries that can contain its lower
+         * bound, such that lower_bound(x) only searches within a single
+         * bucket.  The number of buckets is proportional to the number of
+         * entries, so a lookup takes constant time for all but pathologically
+         * clustered data.
+         */
+        struct LookupTable {
+          /* STATIC STORAGE */
+          /** Number of buckets per table entry. */
+          static const unsigned int buckets_per_entry = 2u;
+
+
+          /* MEMBER STORAGE */
+          /** Abscissa values (sorted in increasing order). */
+          std::vector<double> x;
+
+          /** Ordinate values. */
+          std::vector<double> y;
+
+        private:
+          /** Lower edge of the first bucket (== x.front()). */
+          double x0;
+
+          /** Inverse of the width of each bucket. */
+          double inv_dx;
+
+          /** Index of the first entry not less than the lower edge of each
+           * bucket; bucket.back() == x.size(). */
+          std::vector<unsigned int> bucket;
+
+
+          /* MEMBER FUNCTIONS */
+        public:
+          /** Default constructor creates an empty table. */
+          LookupTable() : x0(0.0), inv_dx(0.0) { }
+
+          /** Copy the (sorted) pairs of a map-like container into the table
+           * and build the bucket index. */
+          template < typename Map >
+          void assign( const Map & table ) {
+            x.clear();
+            y.clear();
+            x.reserve( table.size() );
+            y.reserve( table.size() );
+            for ( typename Map::const_iterator i = table.begin(),
+                                             end = table.end();
+                  i != end; ++i ) {
+              x.push_back( i->first );
+              y.push_back( i->second );
+            }
+            index();
+          }
+
+          /** Number of entries in the table. */
+          std::size_t size() const { return x.size(); }
+
+          /** Index of the first entry that is not less than xi (or size() if
+           * all entries are less than xi).  This is equivalent to
+           * std::lower_bound on the x array. */
+          std::size_t lower_bound( const double & xi ) const {
+            const std::size_t n = x.size();
+            if ( n == 0u || !( xi > x.front() ) )
+              return 0u;
+            if ( xi > x.back() )
+              return n;
+
+            std::size_t b = static_cast<std::size_t>( (xi - x0) * inv_dx );
+            if ( b >= bucket.size() - 1u )
+              b = bucket.size() - 2u;
+
+            const double * beg = &x[0];
+            std::size_t k = std::lower_bound( beg + bucket[b],
+                                              beg + bucket[b+1u], xi ) - beg;
+
+            /* correct for round-off in the computation of the bucket. */
+            while ( k < n && x[k] < xi )
+              ++k;
+            while ( k > 0u && !( x[k-1u] < xi ) )
+              --k;
+            return k;
+          }
+
+          /** Build the bucket index for the current x array.  This must be
+           * called after x has been changed directly. */
+          void index() {
+            bucket.clear();
+            x0 = inv_dx = 0.0;
+            if ( x.size() < 2u ) {
+              bucket.resize( 2u, 0u );
+              bucket.back() = x.size();
+              return;
+            }
+
+            const std::size_t nb = buckets_per_entry * x.size();
+            x0 = x.front();
+            const double dx = ( x.back() - x0 ) / nb;
+            inv_dx = dx > 0.0 ? 1.0 / dx : 0.0;
+
+            bucket.resize( nb + 1u );
+            for ( std::size_t b = 0u; b < nb; ++b )
+              bucket[b] = std::lower_bound( x.begin(), x.end(), x0 + b * dx )
+                        - x.begin();
+            bucket[nb] = x.size();
+          }
+        };
+
+      } /* namespace chimp::interaction::cross_section::detail */
+    } /* namespace chimp::interaction::cross_section */
+  } /* namespace chimp::interaction */
+} /* namespace chimp */
+
+#endif // chimp_interaction_cross_section_detail_LookupTable_h
@@ -0,0 +1,78 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the Constant cross section model class.
+ * */
+#define BOOST_TEST_MODULE  Constant
+
+
+#include <chimp/interaction/cross_section/Constant.h>
+#include <chimp/interaction/ReducedMass.h>
+#include <chimp/make_options.h>
+
+#include <physical/physical.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+namespace {
+  typedef chimp::interaction::cross_section::Constant<
+    chimp::make_options<>::type > Constant;
+
+  using chimp::interaction::ReducedMass;
+  using physical::constant::si::eV;
+
+  /** Compare batch evaluation against single evaluations. */
+  void checkBatch( const Constant & c ) {
+    std::vector<double> v( 1u, 0.0 ), sigma;
+    for ( double vi = 1.0; vi < 1e6; vi *= 1.1 )
+      v.push_back( vi );
+    sigma.resize( v.size() );
+
+    c.evaluate( &v[0], &sigma[0], v.size() );
+    for ( unsigned int i = 0u; i < v.size(); ++i )
+      BOOST_CHECK_EQUAL( sigma[i], c(v[i]) );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( Constant_test ); // {
+
+  BOOST_AUTO_TEST_CASE( batch ) {
+    const Constant c( 2e-19 );
+    BOOST_CHECK_EQUAL( c(0.0), 2e-19 );
+    checkBatch( c );
+  }
+
+  BOOST_AUTO_TEST_CASE( batch_threshold ) {
+    const double m = 6.63e-26;
+    const Constant c( 2e-19, ReducedMass( m, m ), 0.1 * eV );
+    const double v_th = c.getThresholdVelocity();
+    BOOST_CHECK_EQUAL( c( 0.99 * v_th ), 0.0 );
+    BOOST_CHECK_EQUAL( c( 1.01 * v_th ), 2e-19 );
+
+    checkBatch( c );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }  Constant
@@ -28,6 +28,7 @@
 
 
 #include <chimp/interaction/cross_section/DATA.h>
+#include <chimp/interaction/cross_section/detail/LookupTable.h>
 #include <chimp/interaction/ReducedMass.h>
 #include <chimp/physical_calc.h>
 #include <chimp/make_options.h>
@@ -42,6 +43,8 @@
 
 #include <vector>
 #include <fstream>
+#include <algorithm>
+#include <cmath>
 
 #ifndef XML_FILENAME
 #  error The filename was supposed to already be defined on the command line
@@ -62,6 +65,34 @@ namespace {
   using xylose::SQR;
 
   chimp::interaction::ReducedMass mu(m_e,amu);
+
+  using chimp::interaction::cross_section::DoubleDataSet;
+
+  /** A table with clustered, non-uniform abscissas that ends at zero. */
+  DoubleDataSet makeClusteredTable() {
+    DoubleDataSet t;
+    t.insert( std::make_pair( 1.0, 0.0 ) );
+    for ( int i = 1; i < 40; ++i )
+      t.insert( std::make_pair( 1.0 + 1e-3 * i, 1e-20 * i ) );
+    for ( int i = 0; i < 30; ++i )
+      t.insert( std::make_pair( 2.0 * std::pow( 1.3, i ), 4e-20 / (1. + i) ) );
+    t.insert( std::make_pair( 1e5, 0.0 ) );
+    return t;
+  }
+
+  /** Reference linear interpolation directly on the map. */
+  double reference( const DoubleDataSet & t, const double & v ) {
+    DoubleDataSet::const_iterator f = t.lower_bound( v );
+    if ( f == t.begin() )
+      return f->first == v ? f->second : 0.0;
+    if ( f == t.end() )
+      return 0.0;
+    DoubleDataSet::const_iterator i = f;
+    --i;
+    double L_inv = 1.0/(f->first - i->first);
+    return   i->second * L_inv * (f->first - v) +
+             f->second * L_inv * (v - i->first);
+  }
 }
 
 BOOST_AUTO_TEST_SUITE( threshold ); // {
@@ -90,3 +121,76 @@ BOOST_AUTO_TEST_SUITE( threshold ); // {
 
 BOOST_AUTO_TEST_SUITE_END(); // }  threshold
 
+
+
+BOOST_AUTO_TEST_SUITE( lookup ); // {
+
+  BOOST_AUTO_TEST_CASE( lower_bound ) {
+    const DoubleDataSet t = makeClusteredTable();
+    chimp::interaction::cross_section::detail::LookupTable lt;
+    lt.assign( t );
+    BOOST_REQUIRE_EQUAL( lt.size(), t.size() );
+
+    /* every table point, the midpoints, and values outside of the table. */
+    std::vector<double> v( lt.x );
+    for ( unsigned int i = 1u; i < lt.size(); ++i )
+      v.push_back( 0.5 * ( lt.x[i-1u] + lt.x[i] ) );
+    v.push_back( 0.0 );
+    v.push_back( 0.5 );
+    v.push_back( 2e5 );
+
+    for ( unsigned int i = 0u; i < v.size(); ++i )
+      BOOST_CHECK_EQUAL(
+        lt.lower_bound( v[i] ),
+        std::size_t( std::lower_bound( lt.x.begin(), lt.x.end(), v[i] )
+                     - lt.x.begin() )
+      );
+  }
+
+  BOOST_AUTO_TEST_CASE( interpolation ) {
+    const DoubleDataSet t = makeClusteredTable();
+    DATA data( t );
+
+    for ( double v = 0.5; v < 2e5; v *= 1.0007 )
+      BOOST_CHECK_EQUAL( data(v), reference( t, v ) );
+
+    /* exactly at the threshold and at each table point. */
+    for ( DoubleDataSet::const_iterator i = t.begin(); i != t.end(); ++i )
+      BOOST_CHECK_CLOSE( data(i->first), i->second, 1e-10 );
+  }
+
+  BOOST_AUTO_TEST_CASE( findMaxSigmaV ) {
+    const DoubleDataSet t = makeClusteredTable();
+    DATA data( t );
+
+    for ( double v = 0.5; v < 2e5; v *= 1.01 ) {
+      /* brute force search of the table and the end point. */
+      std::pair<double,double> m = std::make_pair(0.0,0.0);
+      for ( DoubleDataSet::const_iterator i = t.begin();
+            i != t.end() && i->first < v; ++i )
+        if ( m.first < i->first * i->second )
+          m = std::make_pair( i->first * i->second, i->first );
+      if ( m.first < v * reference( t, v ) )
+        m = std::make_pair( v * reference( t, v ), v );
+
+      const std::pair<double,double> r = data.findMaxSigmaV( v );
+      BOOST_CHECK_EQUAL( r.first, m.first );
+      BOOST_CHECK_EQUAL( r.second, m.second );
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE( evaluate ) {
+    const DoubleDataSet t = makeClusteredTable();
+    DATA data( t );
+
+    std::vector<double> v, sigma;
+    for ( double vi = 0.5; vi < 2e5; vi *= 1.01 )
+      v.push_back( vi );
+    sigma.resize( v.size() );
+
+    data.evaluate( &v[0], &sigma[0], v.size() );
+    for ( unsigned int i = 0u; i < v.size(); ++i )
+      BOOST_CHECK_EQUAL( sigma[i], data(v[i]) );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }  lookup
@@ -70,6 +70,13 @@ BOOST_AUTO_TEST_SUITE( Inverse_test ); // {
 
       /* check calculated values. */
       BOOST_CHECK_CLOSE( inverse(1000.), 2.12*SQR(nm) / 1000., 1e-6 );
+
+      /* check batch evaluation against single evaluations. */
+      const double v[] = { 1.0, 10.0, 1000., 1e4, 1e5 };
+      double sigma[5];
+      inverse.evaluate( v, sigma, 5u );
+      for ( unsigned int i = 0u; i < 5u; ++i )
+        BOOST_CHECK_EQUAL( sigma[i], inverse(v[i]) );
     }
 
     /* not sure why telling it to catch xml::error did not work. Perhaps they
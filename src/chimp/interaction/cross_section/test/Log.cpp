@@ -75,6 +75,13 @@ BOOST_AUTO_TEST_SUITE( Log_test ); // {
       BOOST_CHECK_CLOSE(
         l(1000.), (171.23 - 27.2*log10(1000.)) * SQR(Angstrom), 1e-6
       );
+
+      /* check batch evaluation against single evaluations. */
+      const double v[] = { 1.0, 10.0, 1000., 1e4, 1e5 };
+      double sigma[5];
+      l.evaluate( v, sigma, 5u );
+      for ( unsigned int i = 0u; i < 5u; ++i )
+        BOOST_CHECK_EQUAL( sigma[i], l(v[i]) );
     }
 
     /* not sure why telling it to catch xml::error did not work. Perhaps they
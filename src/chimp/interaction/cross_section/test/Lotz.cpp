@@ -137,6 +137,17 @@ BOOST_AUTO_TEST_SUITE( Lotz_test ); // {
       // very sharp, very thin peaks.
       BOOST_CHECK_CLOSE( lotz.maxSigmaV, 1.8684418618653654e6/*m/s*/ * 0.933748*SQR(nm), 5e-2/* % */ );
 
+      /* check batch evaluation against single evaluations. */
+      {
+        std::vector<double> v, sigma;
+        for ( double vi = 0.5 * lotz.threshold; vi < 1e8; vi *= 1.1 )
+          v.push_back( vi );
+        sigma.resize( v.size() );
+        lotz.evaluate( &v[0], &sigma[0], v.size() );
+        for ( unsigned int i = 0u; i < v.size(); ++i )
+          BOOST_CHECK_CLOSE( sigma[i], lotz(v[i]), 1e-10 );
+      }
+
       #ifdef WRITE_FILES
       {
         chimp::interaction::cross_section::detail::DSigmaVFunctor<Lotz> dsv(lotz);
@@ -0,0 +1,93 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the VHS cross section model class.
+ * */
+#define BOOST_TEST_MODULE  VHS
+
+
+#include <chimp/interaction/cross_section/VHS.h>
+#include <chimp/interaction/ReducedMass.h>
+#include <chimp/make_options.h>
+
+#include <xylose/power.h>
+
+#include <physical/physical.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cmath>
+
+namespace {
+  typedef chimp::interaction::cross_section::VHS<
+    chimp::make_options<>::type > VHS;
+
+  using chimp::interaction::ReducedMass;
+  using physical::constant::si::eV;
+  using xylose::SQR;
+
+  /** A VHS cross section with the parameters of argon. */
+  VHS makeVHS( const double & threshold ) {
+    const double m_Ar = 6.63e-26;
+
+    VHS vhs;
+    vhs.mu = ReducedMass( m_Ar, m_Ar );
+    vhs.vhs.cross_section = M_PI * SQR( 4.17e-10 );
+    vhs.vhs.T_ref = 273.0;
+    vhs.vhs.visc_T_law = 0.81;
+    vhs.vhs.compute_gamma_visc_inv();
+    vhs.setThresholdEnergy( threshold, vhs.mu );
+    return vhs;
+  }
+
+  /** Compare batch evaluation against single evaluations. */
+  void checkBatch( const VHS & vhs ) {
+    std::vector<double> v( 1u, 0.0 ), sigma;
+    for ( double vi = 1.0; vi < 1e6; vi *= 1.1 )
+      v.push_back( vi );
+    sigma.resize( v.size() );
+
+    vhs.evaluate( &v[0], &sigma[0], v.size() );
+    for ( unsigned int i = 0u; i < v.size(); ++i )
+      BOOST_CHECK_CLOSE( sigma[i], vhs(v[i]), 1e-10 );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( VHS_test ); // {
+
+  BOOST_AUTO_TEST_CASE( batch ) {
+    checkBatch( makeVHS( 0.0 ) );
+  }
+
+  BOOST_AUTO_TEST_CASE( batch_threshold ) {
+    const VHS vhs = makeVHS( 0.1 * eV );
+    const double v_th = vhs.getThresholdVelocity();
+    BOOST_CHECK_EQUAL( vhs( 0.99 * v_th ), 0.0 );
+    BOOST_CHECK_GT( vhs( 1.01 * v_th ), 0.0 );
+
+    checkBatch( vhs );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }  VHS
@@ -24,6 +24,8 @@
 #ifndef chimp_interaction_detail_DriverRetval_h
 #define chimp_interaction_detail_DriverRetval_h
 
+#include <cassert>
+
 namespace chimp {
   namespace interaction {
     namespace detail {
@@ -87,7 +89,7 @@ namespace chimp {
           } else {
             *pair.first = *last; // move the last up
             /* set the new range for A species. */
-            aRange = SpeciesRange( aRange.begin(), last );
+            aRange = Range( aRange.begin(), last );
 
             last = bRange.end() -1;
             *pair.second = *last; // move the last up
@@ -95,7 +97,7 @@ namespace chimp {
 
           eq.insert( last ); // queue the deletion
           /* set the new range for B species. */
-          bRange = SpeciesRange( bRange.begin(), last );
+          bRange = Range( bRange.begin(), last );
 
         }
       };
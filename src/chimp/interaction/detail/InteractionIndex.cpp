@@ -0,0 +1,95 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Implementation of the interaction::detail::InteractionIndex class.
+ */
+
+#include <chimp/interaction/detail/InteractionIndex.h>
+
+#include <algorithm>
+
+namespace chimp {
+  namespace interaction {
+    namespace detail {
+
+      InteractionIndex::Entry::Entry( const filter::EqView & view )
+        : view( view ) {
+        const filter::EqView::TermList & out = view.out();
+        for ( filter::EqView::TermList::const_iterator i = out.begin(),
+                                                     e = out.end();
+              i != e; ++i )
+          products.insert( i->name );
+      }
+
+      InteractionIndex::InteractionIndex( const xml::Context & root ) {
+        xml::Context::list xl = root.eval("//Interaction[cross_section]");
+        for ( xml::Context::list::iterator i = xl.begin(), e = xl.end();
+              i != e; ++i ) {
+          const filter::EqView view( *i );
+          const filter::EqView::TermList & in = view.in();
+
+          TermKey key;
+          bool unique_terms = true;
+          for ( filter::EqView::TermList::const_iterator t = in.begin(),
+                                                       te = in.end();
+                t != te; ++t ) {
+            if ( key.find( t->name ) != key.end() ) {
+              /* repeated terms can never match the count of unique input
+               * terms of a query. */
+              unique_terms = false;
+              break;
+            }
+            key[t->name] = t->n;
+          }
+
+          if ( !unique_terms || key.empty() )
+            continue;
+
+          index[key].push_back( Entry( view ) );
+        }
+      }
+
+      const InteractionIndex::EntryList &
+      InteractionIndex::find( const filter::EqTermSet & in ) const {
+        TermKey key;
+        for ( filter::EqTermSet::const_iterator i = in.begin(), e = in.end();
+              i != e; ++i )
+          key[i->name] = i->n;
+
+        std::map< TermKey, EntryList >::const_iterator i = index.find( key );
+        if ( i == index.end() )
+          return empty;
+        return i->second;
+      }
+
+      bool
+      InteractionIndex::hasOnlyProducts( const Entry & e,
+                                         const std::set< std::string > & names ) {
+        return !e.products.empty() &&
+               std::includes( names.begin(), names.end(),
+                              e.products.begin(), e.products.end() );
+      }
+
+    }/* namespace chimp::interaction::detail */
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
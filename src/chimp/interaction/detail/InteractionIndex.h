@@ -0,0 +1,111 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Declaration of the interaction::detail::InteractionIndex class.
+ */
+
+#ifndef chimp_interaction_detail_InteractionIndex_h
+#define chimp_interaction_detail_InteractionIndex_h
+
+#include <chimp/interaction/filter/EqIO.h>
+#include <chimp/interaction/filter/EqView.h>
+
+#include <xylose/xml/Doc.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace chimp {
+  namespace xml = xylose::xml;
+
+  namespace interaction {
+    namespace detail {
+
+      /** Index of all Interaction nodes (that have cross section data) of an
+       * xml data set, keyed by the multiset of input species.  The index is
+       * created with a single pass over the document and replaces evaluating
+       * one xpath query over the whole document for each pair of species.
+       *
+       * Input terms match as for filter::getXpathQuery("In", ...):  the
+       * number of terms and the multiplicity of each term must be equal.
+       *
+       * Each node is parsed once into a filter::EqView, such that the
+       * equation filters of all pairs of species reuse the same views (see
+       * filter::Base::filterViews).
+       */
+      class InteractionIndex {
+        /* TYPEDEFS */
+      public:
+        /** Map of particle name to multiplicity used to look up inputs. */
+        typedef std::map< std::string, int > TermKey;
+
+        /** An indexed Interaction node and the names of its product species. */
+        struct Entry {
+          /** The parsed view of the Interaction node. */
+          filter::EqView view;
+
+          /** Names of all product species of the Interaction. */
+          std::set< std::string > products;
+
+          /** Constructor records the product species of the view. */
+          explicit Entry( const filter::EqView & view );
+
+          /** The Interaction node. */
+          const xml::Context & context() const { return view.context(); }
+        };
+
+        /** List of indexed Interaction nodes.  The views of each list are
+         * stored in a single array (see filter::ViewList). */
+        typedef std::vector< Entry > EntryList;
+
+
+        /* MEMBER STORAGE */
+      private:
+        /** Interaction nodes indexed by input terms. */
+        std::map< TermKey, EntryList > index;
+
+        /** Empty list returned by find() for unknown inputs. */
+        EntryList empty;
+
+
+        /* MEMBER FUNCTIONS */
+      public:
+        /** Index all <code>//Interaction[cross_section]</code> nodes under
+         * the given context. */
+        explicit InteractionIndex( const xml::Context & root );
+
+        /** Find all Interaction nodes with exactly the given inputs. */
+        const EntryList & find( const filter::EqTermSet & in ) const;
+
+        /** Whether all products of the entry are in the given set of names. */
+        static bool hasOnlyProducts( const Entry & e,
+                                     const std::set< std::string > & names );
+      };
+
+    }/* namespace chimp::interaction::detail */
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_detail_InteractionIndex_h
@@ -0,0 +1,79 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Declaration of the interaction::detail::NestLock class.
+ */
+
+#ifndef chimp_interaction_detail_NestLock_h
+#define chimp_interaction_detail_NestLock_h
+
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+namespace chimp {
+  namespace interaction {
+    namespace detail {
+
+      /** Recursive lock that may be set again by the thread that holds it.
+       * This is an OpenMP nest lock if OpenMP is enabled and a NO-OP
+       * otherwise.  Copies of a NestLock are independent (unlocked) locks. */
+      class NestLock {
+        /* MEMBER STORAGE */
+#ifdef _OPENMP
+      private:
+        omp_nest_lock_t lock;
+#endif
+
+
+        /* MEMBER FUNCTIONS */
+      public:
+#ifdef _OPENMP
+        NestLock() { omp_init_nest_lock( &lock ); }
+        NestLock( const NestLock & ) { omp_init_nest_lock( &lock ); }
+        ~NestLock() { omp_destroy_nest_lock( &lock ); }
+        NestLock & operator=( const NestLock & ) { return *this; }
+
+        void set()   { omp_set_nest_lock( &lock ); }
+        void unset() { omp_unset_nest_lock( &lock ); }
+#else
+        void set()   { }
+        void unset() { }
+#endif
+
+        /** Holds a NestLock for the lifetime of the Guard. */
+        class Guard {
+          NestLock & l;
+          Guard( const Guard & );
+          Guard & operator=( const Guard & );
+        public:
+          explicit Guard( NestLock & l ) : l(l) { l.set(); }
+          ~Guard() { l.unset(); }
+        };
+      };
+
+    }/* namespace chimp::interaction::detail */
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_detail_NestLock_h
@@ -0,0 +1,282 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Closed-set (variant) dispatch of the built-in cross sections and interaction
+ * models.
+ */
+
+#ifndef chimp_interaction_detail_VariantDispatch_h
+#define chimp_interaction_detail_VariantDispatch_h
+
+#include <chimp/interaction/Equation.h>
+#include <chimp/interaction/model/Base.h>
+#include <chimp/interaction/model/Elastic.h>
+#include <chimp/interaction/model/VSSElastic.h>
+#include <chimp/interaction/model/InElastic.h>
+#include <chimp/interaction/cross_section/Base.h>
+#include <chimp/interaction/cross_section/VHS.h>
+#include <chimp/interaction/cross_section/Log.h>
+#include <chimp/interaction/cross_section/DATA.h>
+#include <chimp/interaction/cross_section/Lotz.h>
+#include <chimp/interaction/cross_section/Inverse.h>
+#include <chimp/interaction/cross_section/Constant.h>
+#include <chimp/interaction/cross_section/AveragedDiameters.h>
+#include <chimp/interaction/cross_section/detail/AvgEasy.h>
+
+#include <typeinfo>
+
+namespace chimp {
+  namespace interaction {
+    namespace detail {
+
+      /** Test whether the dynamic type of *p is exactly T.  Classes that are
+       * derived from T (possibly overriding its virtual functions) do not
+       * match. */
+      template < typename T, typename BaseT >
+      inline bool isExactly( const BaseT * p ) {
+        return p && typeid(*p) == typeid(T);
+      }
+
+
+      /** Tagged reference to a cross section.  If the cross section is one of
+       * the built-in types, operator() calls the implementation of that type
+       * directly (such that it can be inlined).  Otherwise, the virtual
+       * function is called.
+       */
+      template < typename options >
+      struct CrossSectionVariant {
+        /* TYPEDEFS */
+        typedef cross_section::Base<options> Base;
+        typedef cross_section::VHS<options> VHS;
+        typedef cross_section::Constant<options> Constant;
+        typedef cross_section::Log<options> Log;
+        typedef cross_section::Inverse<options> Inverse;
+        typedef cross_section::Lotz<options> Lotz;
+        typedef cross_section::DATA<options> DATA;
+        typedef cross_section::AveragedDiameters<options> AveragedDiameters;
+        typedef cross_section::detail::AvgEasy<options> AvgEasy;
+
+        enum Kind {
+          VIRTUAL = 0,
+          VHS_KIND,
+          CONSTANT_KIND,
+          LOG_KIND,
+          INVERSE_KIND,
+          LOTZ_KIND,
+          DATA_KIND,
+          AVG_EASY_KIND
+        };
+
+
+        /* MEMBER STORAGE */
+        /** The type of the cross section. */
+        Kind kind;
+
+        /** The cross section. */
+        const Base * cs;
+
+
+        /* MEMBER FUNCTIONS */
+        /** Constructor determines the type of the given cross section. */
+        explicit CrossSectionVariant( const Base * cs = NULL )
+          : kind( classify(cs) ), cs(cs) { }
+
+        /** Evaluate the cross section at the given relative speed. */
+        inline double operator() ( const double & v_relative ) const {
+          switch ( kind ) {
+            case VHS_KIND:      return call<VHS>( v_relative );
+            case CONSTANT_KIND: return call<Constant>( v_relative );
+            case LOG_KIND:      return call<Log>( v_relative );
+            case INVERSE_KIND:  return call<Inverse>( v_relative );
+            case LOTZ_KIND:     return call<Lotz>( v_relative );
+            case DATA_KIND:     return call<DATA>( v_relative );
+            case AVG_EASY_KIND: return call<AvgEasy>( v_relative );
+            default:            return cs->operator()( v_relative );
+          }
+        }
+
+        /** Determine the Kind of the given cross section. */
+        static Kind classify( const Base * cs ) {
+          if ( isExactly<VHS>( cs ) )       return VHS_KIND;
+          if ( isExactly<Constant>( cs ) )  return CONSTANT_KIND;
+          if ( isExactly<Log>( cs ) )       return LOG_KIND;
+          if ( isExactly<Inverse>( cs ) )   return INVERSE_KIND;
+          if ( isExactly<Lotz>( cs ) )      return LOTZ_KIND;
+          if ( isExactly<DATA>( cs ) )      return DATA_KIND;
+          /* AveragedDiameters only adds a constructor to DATA. */
+          if ( isExactly<AveragedDiameters>( cs ) ) return DATA_KIND;
+          if ( isExactly<AvgEasy>( cs ) )   return AVG_EASY_KIND;
+          return VIRTUAL;
+        }
+
+        /** The relative speed below which the cross section is known to be
+         * exactly zero.  This is zero for types that do not guarantee this
+         * (e.g. DATA, which extrapolates below its first data point) and for
+         * user-defined types. */
+        double thresholdVelocity() const {
+          switch ( classify(cs) ) {
+            case VHS_KIND:      return threshold<VHS>();
+            case CONSTANT_KIND: return threshold<Constant>();
+            case LOG_KIND:      return threshold<Log>();
+            case INVERSE_KIND:  return threshold<Inverse>();
+            case LOTZ_KIND:
+              return static_cast< const Lotz * >( cs )->threshold;
+            default:            return 0.0;
+          }
+        }
+
+      private:
+        template < typename T >
+        inline double threshold() const {
+          return static_cast< const T * >( cs )->T::getThresholdVelocity();
+        }
+
+        template < typename T >
+        inline double call( const double & v_relative ) const {
+          return static_cast< const T * >( cs )->T::operator()( v_relative );
+        }
+      };
+
+
+      /** Tagged reference to an interaction model.  If the model is one of
+       * the built-in types, interact calls the implementation of that type
+       * directly.  Otherwise, the virtual function is called.
+       */
+      template < typename options >
+      struct ModelVariant {
+        /* TYPEDEFS */
+        typedef model::Base<options> Base;
+        typedef typename Base::ParticleArgRef ParticleArgRef;
+        typedef typename options::Particle Particle;
+        typedef model::Elastic<options> Elastic;
+        typedef model::VSSElastic<options> VSSElastic;
+        typedef model::InElastic_2X2<options,false,false> InElastic_2X2_FF;
+        typedef model::InElastic_2X2<options,false,true > InElastic_2X2_FT;
+        typedef model::InElastic_2X2<options,true ,false> InElastic_2X2_TF;
+        typedef model::InElastic_2X2<options,true ,true > InElastic_2X2_TT;
+        typedef model::InElastic_2X3<options,false,false> InElastic_2X3_FF;
+        typedef model::InElastic_2X3<options,false,true > InElastic_2X3_FT;
+        typedef model::InElastic_2X3<options,true ,false> InElastic_2X3_TF;
+        typedef model::InElastic_2X3<options,true ,true > InElastic_2X3_TT;
+
+        enum Kind {
+          VIRTUAL = 0,
+          ELASTIC_KIND,
+          VSS_ELASTIC_KIND,
+          INELASTIC_2X2_FF_KIND,
+          INELASTIC_2X2_FT_KIND,
+          INELASTIC_2X2_TF_KIND,
+          INELASTIC_2X2_TT_KIND,
+          INELASTIC_2X3_FF_KIND,
+          INELASTIC_2X3_FT_KIND,
+          INELASTIC_2X3_TF_KIND,
+          INELASTIC_2X3_TT_KIND
+        };
+
+
+        /* MEMBER STORAGE */
+        /** The type of the interaction model. */
+        Kind kind;
+
+        /** The interaction model. */
+        const Base * model;
+
+
+        /* MEMBER FUNCTIONS */
+        /** Constructor determines the type of the given interaction model. */
+        explicit ModelVariant( const Base * model = NULL )
+          : kind( classify(model) ), model(model) { }
+
+        /** Two-body collision interface.
+         * @see model::Base::interact.
+         */
+        inline void interact( ParticleArgRef part1,
+                              ParticleArgRef part2,
+                              ProductSink< Particle > & products,
+                              typename options::RNG & rng ) const {
+          switch ( kind ) {
+            case ELASTIC_KIND:
+              call<Elastic>( part1, part2, products, rng );          break;
+            case VSS_ELASTIC_KIND:
+              call<VSSElastic>( part1, part2, products, rng );       break;
+            case INELASTIC_2X2_FF_KIND:
+              call<InElastic_2X2_FF>( part1, part2, products, rng ); break;
+            case INELASTIC_2X2_FT_KIND:
+              call<InElastic_2X2_FT>( part1, part2, products, rng ); break;
+            case INELASTIC_2X2_TF_KIND:
+              call<InElastic_2X2_TF>( part1, part2, products, rng ); break;
+            case INELASTIC_2X2_TT_KIND:
+              call<InElastic_2X2_TT>( part1, part2, products, rng ); break;
+            case INELASTIC_2X3_FF_KIND:
+              call<InElastic_2X3_FF>( part1, part2, products, rng ); break;
+            case INELASTIC_2X3_FT_KIND:
+              call<InElastic_2X3_FT>( part1, part2, products, rng ); break;
+            case INELASTIC_2X3_TF_KIND:
+              call<InElastic_2X3_TF>( part1, part2, products, rng ); break;
+            case INELASTIC_2X3_TT_KIND:
+              call<InElastic_2X3_TT>( part1, part2, products, rng ); break;
+            default:
+              model->interact( part1, part2, products, rng );
+          }
+        }
+
+        /** Determine the Kind of the given interaction model. */
+        static Kind classify( const Base * model ) {
+          if ( isExactly<Elastic>( model ) )    return ELASTIC_KIND;
+          if ( isExactly<VSSElastic>( model ) ) return VSS_ELASTIC_KIND;
+          if ( isExactly<InElastic_2X2_FF>( model ) )
+            return INELASTIC_2X2_FF_KIND;
+          if ( isExactly<InElastic_2X2_FT>( model ) )
+            return INELASTIC_2X2_FT_KIND;
+          if ( isExactly<InElastic_2X2_TF>( model ) )
+            return INELASTIC_2X2_TF_KIND;
+          if ( isExactly<InElastic_2X2_TT>( model ) )
+            return INELASTIC_2X2_TT_KIND;
+          if ( isExactly<InElastic_2X3_FF>( model ) )
+            return INELASTIC_2X3_FF_KIND;
+          if ( isExactly<InElastic_2X3_FT>( model ) )
+            return INELASTIC_2X3_FT_KIND;
+          if ( isExactly<InElastic_2X3_TF>( model ) )
+            return INELASTIC_2X3_TF_KIND;
+          if ( isExactly<InElastic_2X3_TT>( model ) )
+            return INELASTIC_2X3_TT_KIND;
+          return VIRTUAL;
+        }
+
+      private:
+        /* The arguments are passed as ParticleArgRef such that the overload
+         * of T::interact that implements model::Base::interact is chosen. */
+        template < typename T >
+        inline void call( ParticleArgRef part1,
+                          ParticleArgRef part2,
+                          ProductSink< Particle > & products,
+                          typename options::RNG & rng ) const {
+          static_cast< const T * >( model )
+            ->T::interact( part1, part2, products, rng );
+        }
+      };
+
+    }/* namespace chimp::interaction::detail */
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_detail_VariantDispatch_h
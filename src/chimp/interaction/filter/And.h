@@ -32,6 +32,7 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <iterator>
 #include <algorithm>
 
 namespace chimp {
@@ -53,21 +54,58 @@ namespace chimp {
         /** Virtual NO-OP destructor. */
         virtual ~And() {}
 
-        /** Virtual filter operation. */
+        /** Virtual filter operation (see filterViews). */
         virtual set filter(const set & in) {
-          set lset = l->filter(in);
-          set rset = r->filter(in);
+          return filterByViews(in);
+        }
+
+        /** Virtual filter operation.  Predicate sub-trees are applied
+         * directly to the views instead of intersecting their results. */
+        virtual ViewList filterViews(const ViewList & in) {
+          if ( isPredicate() )
+            return filter::Base::filterViews(in);
+
+          if ( r->isPredicate() )
+            return select( l->filterViews(in), *r );
+
+          if ( l->isPredicate() )
+            return select( r->filterViews(in), *l );
 
-          set retval;
+          ViewList lset = l->filterViews(in);
+          ViewList rset = r->filterViews(in);
+
+          ViewList retval;
           std::set_intersection( lset.begin(), lset.end(),
                                  rset.begin(), rset.end(),
-                                 inserter(retval, retval.begin()) );
+                                 std::back_inserter(retval) );
           return retval;
         }
 
+        /** Both sub-filters must match. */
+        virtual bool match(const EqView & v) const {
+          return l->match(v) && r->match(v);
+        }
+
+        virtual bool isPredicate() const {
+          return l->isPredicate() && r->isPredicate();
+        }
+
         virtual std::string getLabel() const { return this->label(); }
 
         static std::string label() { return "And"; }
+
+      private:
+        /** Select the views of the list that match the predicate filter. */
+        static ViewList select( const ViewList & in, const filter::Base & f ) {
+          ViewList retval;
+          for ( ViewList::const_iterator i  = in.begin(),
+                                       end  = in.end();
+                                         i != end; ++i ) {
+            if ( f.match(**i) )
+              retval.push_back( *i );
+          }
+          return retval;
+        }
       };
 
       namespace loader {
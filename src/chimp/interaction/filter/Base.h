@@ -28,11 +28,14 @@
 #ifndef chimp_interaction_filter_Base_h
 #define chimp_interaction_filter_Base_h
 
+#include <chimp/interaction/filter/EqView.h>
+
 #include <xylose/xml/Doc.h>
 
 #include <boost/shared_ptr.hpp>
 
 #include <map>
+#include <vector>
 #include <string>
 #include <stdexcept>
 
@@ -49,8 +52,21 @@ namespace chimp {
        * from this class.  Simple filters (those that can be accomplished by
        * filtering via an XPath query) can be implemented easily by 1)
        * inheriting from this class, and 2) setting the protected xpath_query
-       * member variable to something appropriate.  See the Elastic filter for a
-       * prime example of this.
+       * member variable to something appropriate.
+       *
+       * Filters are evaluated on pre-parsed views (see EqView) of the
+       * candidate Interaction nodes.  A filter that only depends on the node
+       * itself (a predicate) should override match() to inspect the view
+       * instead of relying on an XPath query and should return true from
+       * isPredicate()--see the Elastic filter for a prime example of this.
+       * Trees of predicates are evaluated with a single pass over the
+       * candidates.
+       *
+       * Filters that are not predicates are applied to the entire set of
+       * candidates:  either by overriding filter(set) (which is then also used
+       * when the filter is part of a tree of filters) or, for filters that
+       * work on the views (see Section), by overriding filterViews() and
+       * filter(set) (by way of filterByViews()).
        */
       class Base {
         /* MEMBER STORAGE */
@@ -66,20 +82,96 @@ namespace chimp {
         /** Virtual NO-OP destructor. */
         virtual ~Base() {}
 
-        /** Virtual filter operation. */
+        /** Virtual filter operation.  The default implementation returns all
+         * nodes of the input set for which match() is true. */
         virtual set filter(const set & in) {
-          std::string query = xpath_query + "/Eq";
           set retval;
           for ( set::const_iterator i  = in.begin(),
                                   end  = in.end();
                                     i != end; ++i ) {
-            if ( i->eval(query).size() > 0 )
-              retval.insert(*i);
+            if ( match( EqView(*i) ) )
+              retval.insert( retval.end(), *i );
+          }
+          return retval;
+        }
+
+        /** Filter a list of views.  The default implementation returns all
+         * views for which match() is true if isPredicate() and otherwise the
+         * views of the nodes that pass filter(set) (in the original order).
+         */
+        virtual ViewList filterViews(const ViewList & in) {
+          ViewList retval;
+
+          if ( isPredicate() ) {
+            for ( ViewList::const_iterator i  = in.begin(),
+                                         end  = in.end();
+                                           i != end; ++i ) {
+              if ( match(**i) )
+                retval.push_back( *i );
+            }
+            return retval;
+          }
+
+          set xs;
+          for ( ViewList::const_iterator i  = in.begin(),
+                                       end  = in.end();
+                                         i != end; ++i ) {
+            xs.insert( (*i)->context() );
+          }
+
+          const set fs = filter( xs );
+          for ( ViewList::const_iterator i  = in.begin(),
+                                       end  = in.end();
+                                         i != end; ++i ) {
+            if ( fs.find( (*i)->context() ) != fs.end() )
+              retval.push_back( *i );
           }
           return retval;
         }
 
+        /** Whether a single view passes this filter.  The default
+         * implementation evaluates the xpath_query on the Interaction node.
+         * This is only used by parent filters if isPredicate() is true. */
+        virtual bool match(const EqView & v) const {
+          return v.context().eval( xpath_query + "/Eq" ).size() > 0;
+        }
+
+        /** Whether this filter reduces to match() of each individual view
+         * (as opposed to depending on the entire set of candidates).  The
+         * default is false, such that filters that only override filter(set)
+         * are always applied by way of filter(set). */
+        virtual bool isPredicate() const { return false; }
+
         virtual std::string getLabel() const = 0;
+
+      protected:
+        /** Parse each node of the input set into an EqView and return the
+         * result of filterViews().  Filters that override filterViews()
+         * should implement filter(set) with this. */
+        set filterByViews(const set & in) {
+          std::vector< EqView > views;
+          views.reserve( in.size() );
+          for ( set::const_iterator i  = in.begin(),
+                                  end  = in.end();
+                                    i != end; ++i ) {
+            views.push_back( EqView(*i) );
+          }
+
+          ViewList vl;
+          vl.reserve( views.size() );
+          for ( unsigned int i = 0u; i < views.size(); ++i )
+            vl.push_back( &views[i] );
+
+          vl = filterViews( vl );
+
+          set retval;
+          for ( ViewList::iterator i  = vl.begin(),
+                                 end  = vl.end();
+                                   i != end; ++i ) {
+            retval.insert( retval.end(), (*i)->context() );
+          }
+          return retval;
+        }
       };
 
 
@@ -55,6 +55,13 @@ namespace chimp {
           xpath_query = elastic_predicate<>::xpath_query;
         }
 
+        /** Match the elastic flag of the view. */
+        virtual bool match(const EqView & v) const {
+          return v.isElastic();
+        }
+
+        virtual bool isPredicate() const { return true; }
+
         virtual std::string getLabel() const { return this->label(); }
 
         static std::string label() { return "Elastic"; }
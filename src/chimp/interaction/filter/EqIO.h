@@ -180,6 +180,38 @@ namespace chimp {
           xpath_query = getXpathQuery(m_id_name, terms);
         }
 
+        /** Match the parsed terms of the view using the same rules as the
+         * query from getXpathQuery(). */
+        virtual bool match(const EqView & v) const {
+          /* an empty term set matches nothing (see getXpathQuery). */
+          if ( terms.size() == 0u )
+            return false;
+
+          const EqView::TermList & vt = m_id == EqIO::IN ? v.in() : v.out();
+          if ( vt.size() != terms.size() )
+            return false;
+
+          for ( EqTermSet::const_iterator i  = terms.begin(),
+                                        end  = terms.end();
+                                          i != end; ++i ) {
+            if ( i->n == 0 )
+              continue;
+
+            EqView::TermList::const_iterator j = vt.begin();
+            for ( ; j != vt.end(); ++j ) {
+              if ( j->name == i->name && ( i->n < 0 || j->n == i->n ) )
+                break;
+            }
+
+            if ( j == vt.end() )
+              return false;
+          }
+
+          return true;
+        }
+
+        virtual bool isPredicate() const { return true; }
+
         virtual std::string getLabel() const { return this->label(); }
 
         static std::string label() { return "EqIO"; }
@@ -0,0 +1,233 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Declaration of the filter::EqView class.
+ */
+
+#ifndef chimp_interaction_filter_EqView_h
+#define chimp_interaction_filter_EqView_h
+
+#include <xylose/xml/Doc.h>
+
+#include <string>
+#include <vector>
+
+namespace chimp {
+  namespace interaction {
+    namespace filter {
+
+      namespace xml = xylose::xml;
+
+      /** Structured view of a single Interaction node as seen by the filters.
+       * Rather than having each filter evaluate its own XPath query against
+       * every candidate node, the filters inspect the input terms, output
+       * terms, model label, section path, and elastic flag of this view.
+       *
+       * All parts of the view are parsed by the constructor with a single
+       * XPath query of the node.  The views of all Interaction nodes of a
+       * data set are created once by interaction::detail::InteractionIndex
+       * and reused for each pair of species that is filtered.
+       */
+      class EqView {
+        /* TYPEDEFS */
+      public:
+        /** A single parsed term of the equation. */
+        struct Term {
+          /** Name of the particle (<code>string(P)</code>). */
+          std::string name;
+
+          /** Multiplicity of the term (a missing or empty <code>n</code> means
+           * 1). */
+          int n;
+
+          Term( const std::string & name = "", const int & n = 1 )
+            : name(name), n(n) { }
+        };
+
+        /** List of terms of one side of the equation (in document order). */
+        typedef std::vector<Term> TermList;
+
+
+        /* MEMBER STORAGE */
+      private:
+        /** The Interaction node. */
+        xml::Context x;
+
+        /** The (first) Eq child of the Interaction. */
+        xml::Context eq_x;
+
+        /** Whether the Interaction has an Eq child. */
+        bool has_eq;
+
+        /** Terms of the In side of the equation. */
+        TermList in_terms;
+
+        /** Terms of the Out side of the equation. */
+        TermList out_terms;
+
+        /** Whether the Interaction has a model attribute. */
+        bool has_model;
+
+        /** Value of the model attribute. */
+        std::string model_label;
+
+        /** Path of the section under /ParticleDB (see section()). */
+        std::string section_path;
+
+        /** Whether the equation is elastic. */
+        bool elastic;
+
+
+        /* MEMBER FUNCTIONS */
+      public:
+        /** Constructor parses the view of the given Interaction node. */
+        explicit EqView( const xml::Context & x )
+          : x(x), has_eq(false), has_model(false), elastic(false) {
+          parse();
+        }
+
+        /** The Interaction node that this view represents. */
+        const xml::Context & context() const { return x; }
+
+        /** Whether the Interaction has an Eq child node.  Nodes without an
+         * equation never pass a filter that inspects the equation. */
+        bool hasEq() const { return has_eq; }
+
+        /** The (first) Eq child node of the Interaction.  Only valid if
+         * hasEq(). */
+        const xml::Context & eq() const { return eq_x; }
+
+        /** The In terms of the equation. */
+        const TermList & in() const { return in_terms; }
+
+        /** The Out terms of the equation. */
+        const TermList & out() const { return out_terms; }
+
+        /** Whether the Interaction node has a model attribute. */
+        bool hasModel() const { return has_model; }
+
+        /** The value of the model attribute of the Interaction node. */
+        const std::string & model() const { return model_label; }
+
+        /** The names of the ancestors of the Interaction node below the root
+         * /ParticleDB node, separated by '/', such as "standard/Interactions".
+         * This is empty if the node is not within a /ParticleDB document.
+         */
+        const std::string & section() const { return section_path; }
+
+        /** Whether the Interaction is within the given section, where the
+         * section is given as a '/' separated path relative to /ParticleDB.
+         * This is equivalent to the Interaction being matched by
+         * <code>/ParticleDB/[section]//Interaction</code>.
+         */
+        bool inSection( const std::string & s ) const {
+          const std::string & p = section();
+          return p.compare( 0u, s.size(), s ) == 0 &&
+                 ( p.size() == s.size() || p[s.size()] == '/' );
+        }
+
+        /** Whether the equation is elastic, that is
+         * <code>string(In) = string(Out)</code> of the (first) Eq node. */
+        bool isElastic() const { return elastic; }
+
+      private:
+        /** Parse all parts of the view.  A single query returns the
+         * ancestors, the model attribute, and the Eq, In, Out, T, P, and n
+         * nodes (and the text of In and Out) in document order:  ancestors
+         * precede the Interaction node itself and each T, P, n, and text node
+         * follows the In or Out node to which it belongs. */
+        void parse() {
+          xml::Context::list xl = x.eval(
+            "ancestor-or-self::* | @model | Eq[1] | "
+            "Eq[1]/In | Eq[1]/In/T | Eq[1]/In/T/P | Eq[1]/In/T/n | "
+            "Eq[1]/Out | Eq[1]/Out/T | Eq[1]/Out/T/P | Eq[1]/Out/T/n | "
+            "Eq[1]/In//text() | Eq[1]/Out//text()"
+          );
+
+          xml::Context::list::iterator i = xl.begin(), end = xl.end();
+
+          std::vector< std::string > ancestors;
+          for ( ; i != end && !isSame( *i, x ); ++i )
+            ancestors.push_back( i->name() );
+          if ( i != end )
+            ++i; /* the Interaction node itself */
+
+          if ( ancestors.size() > 0u && ancestors.front() == "ParticleDB" ) {
+            const char * sep = "";
+            for ( unsigned int a = 1u; a < ancestors.size(); ++a ) {
+              section_path += sep + ancestors[a];
+              sep = "/";
+            }
+          }
+
+          TermList * terms = NULL;
+          std::string in_str, out_str, * str = NULL;
+          for ( ; i != end; ++i ) {
+            const std::string name = i->name();
+            if ( name == "model" ) {
+              has_model = true;
+              model_label = i->parse< std::string >();
+            } else if ( name == "Eq" ) {
+              has_eq = true;
+              eq_x = *i;
+            } else if ( name == "In" ) {
+              terms = &in_terms;
+              str = &in_str;
+            } else if ( name == "Out" ) {
+              terms = &out_terms;
+              str = &out_str;
+            } else if ( !terms ) {
+              continue;
+            } else if ( name == "T" ) {
+              terms->push_back( Term() );
+            } else if ( name == "P" && !terms->empty() ) {
+              terms->back().name = i->parse< std::string >();
+            } else if ( name == "n" && !terms->empty() ) {
+              /* an empty n node means a multiplicity of one. */
+              if ( i->text().find_first_not_of( " \t\r\n" )
+                   != std::string::npos )
+                terms->back().n = i->parse< int >();
+            } else if ( name == "text" ) {
+              *str += i->text();
+            }
+          }
+
+          elastic = has_eq && in_str == out_str;
+        }
+
+        /** Whether both contexts refer to the same node. */
+        static bool isSame( const xml::Context & a, const xml::Context & b ) {
+          return !( a < b ) && !( b < a );
+        }
+      };
+
+      /** List of views that are being filtered.  The entries of a list always
+       * point into a single array of views and are sorted by address, such
+       * that lists can be combined with std::set_intersection and friends. */
+      typedef std::vector< const EqView * > ViewList;
+
+    }/* namespace chimp::interaction::filter */
+  }/* namespace chimp::interaction */
+}/* namespace chimp */
+
+#endif // chimp_interaction_filter_EqView_h
@@ -50,12 +50,24 @@ namespace chimp {
        \endverbatim
        */
       struct Label : filter::Base {
+        /* MEMBER STORAGE */
+        /** The value of the model attribute to select. */
+        std::string model;
+
+
         /* MEMBER FUNCTIONS */
         /** Default constructor does not initialize the xpath filter string. */
-        Label( const std::string & label ) {
+        Label( const std::string & label ) : model(label) {
           xpath_query = "self::node()[@model='" + label + "']";
         }
 
+        /** Match the model label of the view. */
+        virtual bool match(const EqView & v) const {
+          return v.hasModel() && v.model() == model && v.hasEq();
+        }
+
+        virtual bool isPredicate() const { return true; }
+
         virtual std::string getLabel() const { return this->label(); }
 
         static std::string label() { return "Label"; }
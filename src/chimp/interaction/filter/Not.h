@@ -32,6 +32,7 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <iterator>
 #include <algorithm>
 
 namespace chimp {
@@ -54,18 +55,46 @@ namespace chimp {
         /** Virtual NO-OP destructor. */
         virtual ~Not() {}
 
-        /** Virtual filter operation. */
+        /** Virtual filter operation (see filterViews). */
         virtual set filter(const set & in) {
-          set pset = pos->filter(in);
-          set nset = neg->filter(in);
+          return filterByViews(in);
+        }
+
+        /** Virtual filter operation.  A predicate neg sub-filter is applied
+         * directly to the views instead of computing the set difference. */
+        virtual ViewList filterViews(const ViewList & in) {
+          if ( isPredicate() )
+            return filter::Base::filterViews(in);
+
+          ViewList pset = pos->filterViews(in);
+
+          ViewList retval;
+          if ( neg->isPredicate() ) {
+            for ( ViewList::const_iterator i  = pset.begin(),
+                                         end  = pset.end();
+                                           i != end; ++i ) {
+              if ( !neg->match(**i) )
+                retval.push_back( *i );
+            }
+            return retval;
+          }
 
-          set retval;
+          ViewList nset = neg->filterViews(in);
           std::set_difference( pset.begin(), pset.end(),
                                nset.begin(), nset.end(),
-                               inserter(retval, retval.begin()) );
+                               std::back_inserter(retval) );
           return retval;
         }
 
+        /** The pos sub-filter must match while the neg sub-filter must not. */
+        virtual bool match(const EqView & v) const {
+          return pos->match(v) && !neg->match(v);
+        }
+
+        virtual bool isPredicate() const {
+          return pos->isPredicate() && neg->isPredicate();
+        }
+
         virtual std::string getLabel() const { return this->label(); }
 
         static std::string label() { return "Not"; }
@@ -47,6 +47,18 @@ namespace chimp {
           return in;
         }
 
+        /** Virtual filter operation. */
+        virtual ViewList filterViews(const ViewList & in) {
+          return in;
+        }
+
+        /** Everything passes this filter. */
+        virtual bool match(const EqView & v) const {
+          return true;
+        }
+
+        virtual bool isPredicate() const { return true; }
+
         virtual std::string getLabel() const { return this->label(); }
 
         static std::string label() { return "Null"; }
@@ -32,6 +32,7 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <iterator>
 #include <algorithm>
 
 namespace chimp {
@@ -53,18 +54,36 @@ namespace chimp {
         /** Virtual NO-OP destructor. */
         virtual ~Or() {}
 
-        /** Virtual filter operation. */
+        /** Virtual filter operation (see filterViews). */
         virtual set filter(const set & in) {
-          set lset = l->filter(in);
-          set rset = r->filter(in);
+          return filterByViews(in);
+        }
+
+        /** Virtual filter operation.  A tree of predicates is evaluated
+         * with a single pass over the views. */
+        virtual ViewList filterViews(const ViewList & in) {
+          if ( isPredicate() )
+            return filter::Base::filterViews(in);
 
-          set retval;
+          ViewList lset = l->filterViews(in);
+          ViewList rset = r->filterViews(in);
+
+          ViewList retval;
           std::set_union( lset.begin(), lset.end(),
                           rset.begin(), rset.end(),
-                          inserter(retval, retval.begin()) );
+                          std::back_inserter(retval) );
           return retval;
         }
 
+        /** Either sub-filter must match. */
+        virtual bool match(const EqView & v) const {
+          return l->match(v) || r->match(v);
+        }
+
+        virtual bool isPredicate() const {
+          return l->isPredicate() && r->isPredicate();
+        }
+
         virtual std::string getLabel() const { return this->label(); }
 
         static std::string label() { return "Or"; }
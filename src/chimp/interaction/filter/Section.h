@@ -89,62 +89,67 @@ namespace chimp {
         /** Virtual NO-OP destructor. */
         virtual ~Section() {}
 
-        /** Virtual filter operation. */
+        /** Virtual filter operation (see filterViews). */
         virtual set filter(const set & in) {
+          return filterByViews(in);
+        }
+
+        /** Virtual filter operation. */
+        virtual ViewList filterViews(const ViewList & in) {
           if ( section.size() == 0 ) {
             using xylose::logger::log_warning;
             log_warning( "Empty Section filter name allows everything" );
             return in;
           }
 
-          set fset = f->filter(in);
+          ViewList fset = f->filterViews(in);
 
           if ( fset.size() == 0u )
             return fset;
 
+          /* Sections that are not simple paths are only available by way of
+           * an xpath query over the whole document. */
           set section_set;
-          {
-            xml::Context::list xl = fset.begin()->eval(
+          if ( !isSimplePath(section) ) {
+            xml::Context::list xl = fset.front()->context().eval(
               "/ParticleDB/" + section + "//Interaction"
             );
             section_set.insert( xl.begin(), xl.end() );
           }
 
           if ( requirement == REQUIRED ) {
-            set retval;
-            std::set_intersection( fset.begin(), fset.end(),
-                                   section_set.begin(), section_set.end(),
-                                   inserter(retval, retval.begin()) );
+            ViewList retval;
+            for ( ViewList::iterator i  = fset.begin(),
+                                   end  = fset.end();
+                                     i != end; ++i ) {
+              if ( inSection( **i, &section_set ) )
+                retval.push_back( *i );
+            }
             return retval;
           }
 
           /* else requirement == PREFERRED */
-          set standard_set;
-          {
-            xml::Context::list xl = fset.begin()->eval(
-              "/ParticleDB/standard//Interaction"
-            );
-            standard_set.insert( xl.begin(), xl.end() );
-          }
-
           detail::EqMap map;
 
-          for ( set::iterator i  = fset.begin(),
-                            end  = fset.end();
-                              i != end; ++i ) {
+          for ( ViewList::iterator i  = fset.begin(),
+                                 end  = fset.end();
+                                   i != end; ++i ) {
             /* we need to test to see if the section matches. */
-            std::string estr = formatUniqueEqString( i->find("Eq") );
+            const EqView & v = **i;
+            std::string estr = formatUniqueEqString(
+              v.hasEq() ? v.eq() : v.context().find("Eq")
+            );
 
-            if      ( section_set.find(*i) != section_set.end() )
-              map[estr].matched = &(*i);
-            else if ( standard_set.find(*i) != standard_set.end() )
-              map[estr].standard = &(*i);
+            if      ( inSection( v, &section_set ) )
+              map[estr].matched = &v;
+            else if ( v.inSection("standard") )
+              map[estr].standard = &v;
             else
-              map[estr].unmatched = &(*i);
+              map[estr].unmatched = &v;
           }
 
           /* now insert the appropriate item. */
-          set retval;
+          ViewList retval;
           for ( detail::EqMap::iterator i  = map.begin(),
                                       end  = map.end();
                                         i != end; ++i ) {
@@ -153,19 +158,79 @@ namespace chimp {
                     i->second.unmatched );
 
             if      (i->second.matched)
-              retval.insert( *(i->second.matched) );
+              retval.push_back( i->second.matched );
             else if (i->second.standard)
-              retval.insert( *(i->second.standard) );
+              retval.push_back( i->second.standard );
             else
-              retval.insert( *(i->second.unmatched) );
+              retval.push_back( i->second.unmatched );
           }
 
+          /* lists of views must be kept in order (see ViewList). */
+          std::sort( retval.begin(), retval.end() );
           return retval;
         }
 
+        /** Only the REQUIRED Section filter with a predicate sub-tree can be
+         * applied to each view individually. */
+        virtual bool match(const EqView & v) const {
+          if ( section.size() == 0 )
+            return true;
+
+          return f->match(v) &&
+                 ( requirement == PREFERRED || inSection( v ) );
+        }
+
+        virtual bool isPredicate() const {
+          return requirement == REQUIRED && section.size() > 0 &&
+                 isSimplePath(section) && f->isPredicate();
+        }
+
+        /** Whether the section string is a simple '/' separated path of
+         * element names (as opposed to a more general xpath expression). */
+        static bool isSimplePath( const std::string & s ) {
+          std::string::size_type start = 0u;
+          do {
+            std::string::size_type stop = s.find( '/', start );
+            if ( stop == std::string::npos )
+              stop = s.size();
+
+            const std::string name = s.substr( start, stop - start );
+            if ( name.size() == 0 || name == "." || name == ".." ||
+                 name.find_first_not_of( "abcdefghijklmnopqrstuvwxyz"
+                                         "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                         "0123456789_-." )
+                   != std::string::npos )
+              return false;
+
+            start = stop + 1u;
+          } while ( start <= s.size() );
+
+          return true;
+        }
+
         virtual std::string getLabel() const { return this->label(); }
 
         static std::string label() { return "Section"; }
+
+      private:
+        /** Whether the view is within this section.  For sections that are not
+         * simple paths, the section_set should contain all Interaction nodes of
+         * the section (the section is queried for this single view if NULL).
+         */
+        bool inSection( const EqView & v,
+                        const set * section_set = NULL ) const {
+          if ( isSimplePath(section) )
+            return v.inSection(section);
+
+          if ( section_set )
+            return section_set->find( v.context() ) != section_set->end();
+
+          xml::Context::list xl = v.context().eval(
+            "/ParticleDB/" + section + "//Interaction"
+          );
+          const set s( xl.begin(), xl.end() );
+          return s.find( v.context() ) != s.end();
+        }
       };
 
 
@@ -25,6 +25,8 @@
 #ifndef chimp_interaction_filter_detail_EqPair_h
 #define chimp_interaction_filter_detail_EqPair_h
 
+#include <chimp/interaction/filter/EqView.h>
+
 #include <map>
 #include <string>
 #include <ostream>
@@ -35,13 +37,13 @@ namespace chimp {
       namespace detail {
 
         struct EqSet {
-          const xml::Context * matched;
-          const xml::Context * standard;
-          const xml::Context * unmatched;
+          const EqView * matched;
+          const EqView * standard;
+          const EqView * unmatched;
 
-          EqSet( const xml::Context * matched = NULL,
-                 const xml::Context * standard = NULL,
-                 const xml::Context * unmatched = NULL )
+          EqSet( const EqView * matched = NULL,
+                 const EqView * standard = NULL,
+                 const EqView * unmatched = NULL )
             : matched(matched), standard(standard), unmatched(unmatched) { }
         };
 
@@ -0,0 +1,239 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Test file for the EqView class.
+ * */
+#define BOOST_TEST_MODULE  EqView
+
+
+#include <chimp/default_data.h>
+#include <chimp/interaction/filter/EqView.h>
+#include <chimp/interaction/filter/EqIO.h>
+#include <chimp/interaction/filter/Or.h>
+#include <chimp/interaction/filter/And.h>
+#include <chimp/interaction/filter/Not.h>
+#include <chimp/interaction/filter/Null.h>
+#include <chimp/interaction/filter/Label.h>
+#include <chimp/interaction/filter/Section.h>
+#include <chimp/interaction/filter/Elastic.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+namespace {
+  namespace xml = xylose::xml;
+  using chimp::interaction::filter::EqView;
+
+  /** Check that the match() of the filter is the same as the result of the
+   * given xpath query for every Interaction of the database. */
+  void check_match( const chimp::interaction::filter::Base & f,
+                    const std::string & query,
+                    const bool & expect_matches = true ) {
+    xml::Doc xmlDb( chimp::default_data::particledb() );
+    xml::Context::list xl = xmlDb.eval("//Interaction");
+    BOOST_REQUIRE_GT( xl.size(), 0u );
+
+    unsigned int n_matched = 0u;
+    for ( xml::Context::list::iterator i = xl.begin(); i != xl.end(); ++i ) {
+      bool m = f.match( EqView(*i) );
+      BOOST_CHECK_EQUAL( m, i->eval(query).size() > 0u );
+      n_matched += m;
+    }
+
+    BOOST_CHECK_EQUAL( n_matched > 0u, expect_matches );
+  }
+
+  /** A filter that only overrides filter(set), keeping the first node. */
+  struct First : chimp::interaction::filter::Base {
+    virtual xml::Context::set filter( const xml::Context::set & in ) {
+      xml::Context::set retval;
+      if ( in.size() > 0u )
+        retval.insert( *in.begin() );
+      return retval;
+    }
+
+    virtual std::string getLabel() const { return "First"; }
+  };
+}
+
+BOOST_AUTO_TEST_SUITE( EqView_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( parse ) {
+    xml::Doc xmlDb( chimp::default_data::particledb() );
+    xml::Context::list xl = xmlDb.eval(
+      "//Interaction[Eq/In/T/P='87Rb']"
+    );
+    BOOST_REQUIRE_EQUAL( xl.size(), 1u );
+
+    EqView v( xl.front() );
+    BOOST_CHECK_EQUAL( v.hasEq(), true );
+    BOOST_CHECK_EQUAL( v.hasModel(), false );
+    BOOST_CHECK_EQUAL( v.isElastic(), true );
+
+    BOOST_REQUIRE_EQUAL( v.in().size(), 1u );
+    BOOST_CHECK_EQUAL( v.in()[0].name, "87Rb" );
+    BOOST_CHECK_EQUAL( v.in()[0].n, 2 );
+    BOOST_REQUIRE_EQUAL( v.out().size(), 1u );
+    BOOST_CHECK_EQUAL( v.out()[0].name, "87Rb" );
+    BOOST_CHECK_EQUAL( v.out()[0].n, 2 );
+
+    BOOST_CHECK_EQUAL( v.section(), "standard/Interactions" );
+    BOOST_CHECK_EQUAL( v.inSection("standard"), true );
+    BOOST_CHECK_EQUAL( v.inSection("standard/Interactions"), true );
+    BOOST_CHECK_EQUAL( v.inSection("stand"), false );
+    BOOST_CHECK_EQUAL( v.inSection("test"), false );
+  }
+
+  BOOST_AUTO_TEST_CASE( parse_order ) {
+    const char * filename = "EqView-test.xml";
+    {
+      std::ofstream fout( filename );
+      fout << "<ParticleDB><test>"
+              "<Interaction model='inelastic'><Eq>"
+                "<Out><T><n/><P>e^-</P></T><T><P>Hg^+</P></T></Out>"
+                "<In><T><P>e^-</P></T><T><n>1</n><P>Hg</P></T></In>"
+              "</Eq></Interaction>"
+              "</test></ParticleDB>";
+    }
+
+    xml::Doc xmlDb( filename );
+    std::remove( filename );
+    xml::Context::list xl = xmlDb.eval("//Interaction");
+    BOOST_REQUIRE_EQUAL( xl.size(), 1u );
+
+    /* the Out node precedes the In node and n may be empty. */
+    EqView v( xl.front() );
+    BOOST_CHECK_EQUAL( v.hasEq(), true );
+    BOOST_CHECK_EQUAL( v.hasModel(), true );
+    BOOST_CHECK_EQUAL( v.model(), "inelastic" );
+    BOOST_CHECK_EQUAL( v.isElastic(), false );
+    BOOST_CHECK_EQUAL( v.section(), "test" );
+
+    BOOST_REQUIRE_EQUAL( v.in().size(), 2u );
+    BOOST_CHECK_EQUAL( v.in()[0].name, "e^-" );
+    BOOST_CHECK_EQUAL( v.in()[0].n, 1 );
+    BOOST_CHECK_EQUAL( v.in()[1].name, "Hg" );
+    BOOST_CHECK_EQUAL( v.in()[1].n, 1 );
+    BOOST_REQUIRE_EQUAL( v.out().size(), 2u );
+    BOOST_CHECK_EQUAL( v.out()[0].name, "e^-" );
+    BOOST_CHECK_EQUAL( v.out()[0].n, 1 );
+    BOOST_CHECK_EQUAL( v.out()[1].name, "Hg^+" );
+    BOOST_CHECK_EQUAL( v.out()[1].n, 1 );
+  }
+
+  BOOST_AUTO_TEST_CASE( match_same_as_xpath ) {
+    using namespace chimp::interaction::filter;
+
+    check_match( Elastic(),
+                 std::string(Elastic::elastic_predicate<>::xpath_query)+"/Eq" );
+
+    /* the standard data does not use the model attribute. */
+    check_match( Label("vhs"), "self::node()[@model='vhs']/Eq", false );
+
+    EqTermSet in;
+    in.insert( EqTerm("e^-", 1) );
+    in.insert( EqTerm("Hg", 1) );
+    check_match( EqIO(EqIO::IN, in), getXpathQuery("In", in) + "/Eq" );
+
+    EqTermSet out;
+    out.insert( EqTerm("e^-") );
+    out.insert( EqTerm("Hg^+") );
+    check_match( EqIO(EqIO::OUT, out), getXpathQuery("Out", out) + "/Eq" );
+  }
+
+  BOOST_AUTO_TEST_CASE( predicate_trees ) {
+    using namespace chimp::interaction::filter;
+    typedef boost::shared_ptr<Base> SP;
+
+    SP in( new EqIO( EqIO::IN, "e^-", "Hg" ) );
+    SP elastic( new Elastic );
+
+    BOOST_CHECK_EQUAL( And( in, SP(new Not(SP(new Null), elastic)) )
+                        .isPredicate(), true );
+    BOOST_CHECK_EQUAL( Section( "standard", Section::REQUIRED, in )
+                        .isPredicate(), true );
+    BOOST_CHECK_EQUAL( Section( "standard", Section::PREFERRED, in )
+                        .isPredicate(), false );
+    BOOST_CHECK_EQUAL( Section( "*[1]", Section::REQUIRED, in )
+                        .isPredicate(), false );
+    BOOST_CHECK_EQUAL( And( in, SP(new Section) ).isPredicate(), false );
+
+    /* a tree of predicates gives the same result as the individual filters. */
+    xml::Doc xmlDb( chimp::default_data::particledb() );
+    xml::Context::list xl = xmlDb.eval("//Interaction");
+    xml::Context::set xset( xl.begin(), xl.end() );
+
+    xml::Context::set ans = And( in, elastic ).filter( xset );
+    xml::Context::set in_set = in->filter( xset );
+    BOOST_CHECK_EQUAL( ans.size(), 1u );
+    BOOST_CHECK_EQUAL( in_set.size() > ans.size(), true );
+    BOOST_CHECK_EQUAL( elastic->filter( in_set ) == ans, true );
+  }
+
+  BOOST_AUTO_TEST_CASE( legacy_filters ) {
+    using namespace chimp::interaction::filter;
+    typedef boost::shared_ptr<Base> SP;
+
+    xml::Doc xmlDb( chimp::default_data::particledb() );
+    xml::Context::list xl = xmlDb.eval("//Interaction");
+    xml::Context::set xset( xl.begin(), xl.end() );
+    BOOST_REQUIRE_GT( xset.size(), 1u );
+
+    /* filters that only override filter(set) are used as such within trees
+     * of filters. */
+    SP first( new First );
+    BOOST_CHECK_EQUAL( first->isPredicate(), false );
+    BOOST_CHECK_EQUAL( And( first, SP(new Null) ).filter( xset ).size(), 1u );
+    BOOST_CHECK_EQUAL( And( SP(new Null), first ).filter( xset ).size(), 1u );
+    BOOST_CHECK_EQUAL( Or( first, first ).filter( xset ).size(), 1u );
+    BOOST_CHECK_EQUAL( Not( SP(new Null), first ).filter( xset ).size(),
+                       xset.size() - 1u );
+    BOOST_CHECK_EQUAL( Section( "standard", Section::REQUIRED, first )
+                         .filter( xset ) == first->filter( xset ), true );
+  }
+
+  BOOST_AUTO_TEST_CASE( section_path ) {
+    using chimp::interaction::filter::Section;
+
+    BOOST_CHECK_EQUAL( Section::isSimplePath("standard"), true );
+    BOOST_CHECK_EQUAL( Section::isSimplePath("standard/Interactions"), true );
+    BOOST_CHECK_EQUAL( Section::isSimplePath("standard/"), false );
+    BOOST_CHECK_EQUAL( Section::isSimplePath("a//b"), false );
+    BOOST_CHECK_EQUAL( Section::isSimplePath("../standard"), false );
+    BOOST_CHECK_EQUAL( Section::isSimplePath("*[1]"), false );
+
+    /* a general xpath expression still selects the same section. */
+    xml::Doc xmlDb( chimp::default_data::particledb() );
+    xml::Context::list xl = xmlDb.eval("//Interaction");
+    xml::Context::set xset( xl.begin(), xl.end() );
+
+    Section simple( "standard", Section::REQUIRED );
+    Section general( "*[name()='standard']", Section::REQUIRED );
+    BOOST_CHECK_EQUAL( simple.filter( xset ) == xset, true );
+    BOOST_CHECK_EQUAL( general.filter( xset ) == xset, true );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
@@ -28,6 +28,9 @@
 #ifndef chimp_interaction_model_Base_h
 #define chimp_interaction_model_Base_h
 
+#include <chimp/BinaryCache.h>
+#include <chimp/interaction/ProductSink.h>
+
 #include <xylose/xml/Doc.h>
 
 #include <string>
@@ -79,18 +82,15 @@ namespace chimp {
         virtual std::string getLabel() const = 0;
 
         /** Two-body collision interface.
-         * Implementing classes must take care that the products array may not
-         * necessarily be initially empty.  This means that implementors might
-         * take the following approach:
-         *   -# use products.push_back to add the particles
-         *   -# AFTER push_back has been done (resizes might happen during
-         *      push_back), obtain and references of the just-added particles by
-         *      making use of *products.rbegin(), *(products.rbegin() + 1), etc.
-         *   .
+         * Implementing classes must take care that the product sink may not
+         * necessarily be initially empty.  Products are created by first
+         * calling products.reserve(n) for all n products and then
+         * products.append(p) for each product; the references returned by
+         * append remain valid until the model returns (see ProductSink).
          */
         virtual void interact( ParticleArgRef part1,
                                ParticleArgRef part2,
-                               std::vector< Particle > & products,
+                               ProductSink< Particle > & products,
                                typename options::RNG & rng ) const {
           throw std::runtime_error(
             "Two body interactions are not supported by "
@@ -98,13 +98,25 @@ namespace chimp {
           );
         }
 
+        /** Two-body collision interface with the products appended to a
+         * std::vector. */
+        void interact( ParticleArgRef part1,
+                       ParticleArgRef part2,
+                       std::vector< Particle > & products,
+                       typename options::RNG & rng ) const {
+          SequenceSink< std::vector< Particle > > sink( products );
+          this->interact( part1, part2,
+                          static_cast< ProductSink< Particle > & >( sink ),
+                          rng );
+        }
+
         /** Three-body collision interface.
-         * @see notes in Base::interact( ParticleArgRef, ParticleArgRef, std;:vector< Particle > &, typename options::RNG & )
+         * @see notes in Base::interact( ParticleArgRef, ParticleArgRef, ProductSink< Particle > &, typename options::RNG & )
          */
         virtual void interact( ParticleArgRef part1,
                                ParticleArgRef part2,
                                ParticleArgRef part3,
-                               std::vector< Particle > & products,
+                               ProductSink< Particle > & products,
                                typename options::RNG & rng ) const {
           throw std::runtime_error(
             "Three body interactions are not supported by "
@@ -113,14 +125,44 @@ namespace chimp {
         }
 
         /** load a new instance of the Interaction.
-         * By the time that this function is called by Equation::load(...), the
-         * cross section model will already be loaded (allowing interaction
-         * models to make decisions based on the cross section data).
+         * By the time that this function is called by Equation::parse(...),
+         * the cross section model will already be loaded (allowing interaction
+         * models to make decisions based on the cross section data).  The
+         * cross section may not yet be initialized, such that only its
+         * threshold energy is reliable (see cross_section::Base::initialize).
          */
         virtual Base * new_load( const xml::Context & x,
                                  const interaction::Equation<options> & eq,
                                  const RuntimeDB<options> & db ) const = 0;
 
+        /** Save this instance to a binary cache.  Implementations must first
+         * write the label of the model (as registered in
+         * RuntimeDB::interaction_registry), followed by all parameters that
+         * cannot be recomputed from the Equation.
+         *
+         * The default implementation throws std::runtime_error.
+         */
+        virtual void save( BinaryWriter & out ) const {
+          throw std::runtime_error(
+            "interaction model '" + this->getLabel() + "' cannot be saved to a "
+            "binary cache" );
+        }
+
+        /** Load a new instance of the Interaction from a binary cache.  The
+         * label written by save(BinaryWriter&) has already been read from the
+         * cache.  As with the xml version, the cross section of the equation
+         * will already be loaded.
+         *
+         * The default implementation throws std::runtime_error.
+         */
+        virtual Base * new_load( BinaryReader & in,
+                                 const interaction::Equation<options> & eq,
+                                 const RuntimeDB<options> & db ) const {
+          throw std::runtime_error(
+            "interaction model '" + this->getLabel() + "' cannot be loaded from "
+            "a binary cache" );
+        }
+
       };
 
     } /* namespace chimp::interaction::model */
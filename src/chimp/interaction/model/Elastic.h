@@ -33,6 +33,7 @@
 #include <chimp/interaction/Equation.h>
 #include <chimp/interaction/model/Base.h>
 #include <chimp/interaction/ReducedMass.h>
+#include <chimp/interaction/model/detail/elastic_helpers.h>
 
 #include <xylose/power.h>
 #include <xylose/Vector.h>
@@ -42,6 +43,7 @@
 #include <string>
 #include <vector>
 #include <cassert>
+#include <algorithm>
 
 namespace chimp {
   namespace interaction {
@@ -51,6 +53,7 @@ namespace chimp {
       template < typename options >
       struct Elastic : Base<options> {
         /* TYPEDEFS */
+        typedef Base<options> super;
         typedef typename options::Particle Particle;
 
 
@@ -83,24 +86,25 @@ namespace chimp {
           return label;
         }
 
+        /* the other interfaces of Base (such as the std::vector version) are
+         * not hidden by the overrides below. */
+        using super::interact;
+
         /** Two-body collision interface.  const particle version. */
         virtual void interact( const Particle & part1,
                                const Particle & part2,
-                               std::vector< Particle > & products,
+                               ProductSink< Particle > & products,
                                typename options::RNG & rng ) const {
-          products.reserve( products.size() + 2u );
-          products.push_back( part1 );
-          products.push_back( part2 );
-
-          typename std::vector< Particle >::reverse_iterator rbeg
-            = products.rbegin();
-          interact( *(rbeg+1), *rbeg, rng );
+          products.reserve( 2u );
+          Particle & r1 = products.append( part1 );
+          Particle & r2 = products.append( part2 );
+          interact( r1, r2, rng );
         }
 
         /** Two-body collision interface.  in-place operation version */
         virtual void interact( Particle & part1,
                                Particle & part2,
-                               std::vector< Particle > & products,
+                               ProductSink< Particle > & products,
                                typename options::RNG & rng ) const {
           interact( part1, part2, rng );
         }
@@ -148,6 +152,77 @@ namespace chimp {
           setVelocity(part2, VelCM - ( mu.over_m2 * VelRelPost ) );
         } // collide
 
+        /** Batched binary elastic collisions of pairs of particles whose
+         * velocities are stored as a structure of arrays.
+         *
+         * The kth pair is made of the particles first[k] and second[k]; the
+         * velocity components of particle i are vx[i], vy[i], vz[i] (or
+         * v[i][0], v[i][1], v[i][2] for the array of vectors).  The
+         * random numbers are drawn in the same order as n successive calls of
+         * interact(Particle&,Particle&,RNG&), such that the results are the
+         * same (up to the round-off of the vectorized math functions).
+         *
+         * Pairs are processed in blocks of detail::PairBlock::size, where all
+         * velocities of a block are read before any are written.  Therefore,
+         * a particle must not appear more than once within a block.
+         */
+        template < typename RNG >
+        void interactPairs( double * vx, double * vy, double * vz,
+                            const unsigned int * first,
+                            const unsigned int * second,
+                            const std::size_t & n,
+                            RNG & rng ) const {
+          interactBlocks( detail::ComponentVelocities( vx, vy, vz ),
+                          first, second, n, rng );
+        }
+
+        /** Batched elastic collisions of pairs of particles whose velocities
+         * are stored as one array of vectors, such as SoAParticles::v.
+         * @see Elastic::interactPairs for the arguments and requirements.
+         */
+        template < typename RNG >
+        void interactPairs( xylose::Vector<double,3u> * v,
+                            const unsigned int * first,
+                            const unsigned int * second,
+                            const std::size_t & n,
+                            RNG & rng ) const {
+          interactBlocks( detail::VectorVelocities( v ),
+                          first, second, n, rng );
+        }
+
+        /** The block loop of both versions of interactPairs. */
+        template < typename Velocities,
+                   typename RNG >
+        void interactBlocks( const Velocities & v,
+                             const unsigned int * first,
+                             const unsigned int * second,
+                             const std::size_t & n,
+                             RNG & rng ) const {
+          const std::size_t bs = detail::PairBlock::size;
+          detail::PairBlock block;
+
+          for ( std::size_t k0 = 0u; k0 < n; k0 += bs ) {
+            const std::size_t nk = std::min( n - k0, bs );
+            block.gather( v, first + k0, second + k0, nk, mu, rng );
+
+            for ( std::size_t k = 0u; k < nk; ++k ) {
+              // B is the cosine of a random elevation angle
+              // A is the sine of the same elevation angle
+              const double B = 2.0 * block.r0[k] - 1.0;
+              const double A = std::sqrt( 1.0 - B*B );
+              // C is a random azimuth angle
+              const double C = 2.0 * M_PI * block.r1[k];
+              const double s = block.speed[k];
+
+              block.g[0][k] = B * s;
+              block.g[1][k] = A * std::cos(C) * s;
+              block.g[2][k] = A * std::sin(C) * s;
+            }
+
+            block.scatter( v, first + k0, second + k0, mu );
+          }
+        }
+
         /** load a new instance of the Interaction. */
         virtual Elastic * new_load( const xml::Context & x,
                                     const interaction::Equation<options> & eq,
@@ -155,6 +230,18 @@ namespace chimp {
           return new Elastic( eq.reducedMass );
         }
 
+        /** Save to a binary cache (only the label is needed). */
+        virtual void save( BinaryWriter & out ) const {
+          out.write( label );
+        }
+
+        /** Load a new instance of the Interaction from a binary cache. */
+        virtual Elastic * new_load( BinaryReader & in,
+                                    const interaction::Equation<options> & eq,
+                                    const RuntimeDB<options> & db ) const {
+          return new Elastic( eq.reducedMass );
+        }
+
       };
 
       template < typename options >
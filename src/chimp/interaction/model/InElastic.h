@@ -38,6 +38,7 @@
 #include <xylose/logger.h>
 
 #include <string>
+#include <vector>
 #include <stdexcept>
 
 namespace chimp {
@@ -66,10 +67,8 @@ namespace chimp {
         /** Index of source particles for each of the (two) reactants. */
         std::vector< detail::ParticleFactory > factories;
 
-        /** A list of lists of expressions for each output species. */
-        std::vector<
-          runtime::physical::calc::Driver::ExpressionVector
-        > expressions;
+        /** The compiled 'ops' expressions for each output species. */
+        std::vector< detail::CompiledOps > expressions;
 
         /** A constant pointer to the database. */
         const RuntimeDB<options> * db_ptr;
@@ -82,23 +81,29 @@ namespace chimp {
          * stashed for use in 'ops' expressions. */
         bool force_cq_calc;
 
+        /** Change of kinetic energy of the interaction (SI units). */
+        double dE;
+
 
         /* MEMBER FUNCTIONS */
         /** Default constructor sets bogus values--mostly useful for loading
          * with InElastic::load. */
-        InElastic() : db_ptr(NULL) { }
+        InElastic()
+          : db_ptr(NULL), force_cm_calc(false), force_cq_calc(false),
+            dE(0.0) { }
 
         /** Constructor to set up factories and expressions. */
-        InElastic( const xml::Context & x,
-                   const interaction::Equation<options> & eq,
-                   const RuntimeDB<options> & db )
+        InElastic( const interaction::Equation<options> & eq,
+                   const RuntimeDB<options> & db,
+                   const double & dE = 0.0 )
           : mu( eq.reducedMass ),
             muQ( db[eq.A.species].chimp::property::charge::value,
                  db[eq.B.species].chimp::property::charge::value ),
-            db_ptr(&db) {
-          detail::setFactories( factories, expressions, x, eq, db );
-          force_cm_calc = detail::hasToken( "CM()", expressions );
-          force_cq_calc = detail::hasToken( "CQ()", expressions );
+            db_ptr(&db),
+            dE( dE ) {
+          detail::setFactories( factories, expressions, eq, db );
+          force_cm_calc = detail::usesCenter( true, expressions );
+          force_cq_calc = detail::usesCenter( false, expressions );
         }
 
         /** Virtual NO-OP destructor. */
@@ -124,6 +129,59 @@ namespace chimp {
              */
             dE = -eq.cs->getThresholdEnergy();
 
+          return create( eq, db, dE );
+        }
+
+        /** Save the kinetic energy change and the 'ops' expressions of the
+         * products to a binary cache.  The expressions are saved with all
+         * symbols replaced by their values (see CompiledOps::getResolved),
+         * such that loading does not require the units calculator. */
+        virtual void save( BinaryWriter & out ) const {
+          std::vector< std::string > resolved;
+          for ( unsigned int i = 0u; i < expressions.size(); ++i )
+            resolved.push_back( expressions[i].getResolved() );
+
+          out.write( label );
+          out.write( dE );
+          out.write( resolved );
+        }
+
+        /** Load a new instance of the Interaction from a binary cache. */
+        virtual InElastic * new_load( BinaryReader & in,
+                                      const interaction::Equation<options> & eq,
+                                      const RuntimeDB<options> & db ) const {
+          const double dE = in.get<double>();
+          std::vector< std::string > resolved;
+          in.read( resolved );
+
+          if ( resolved.empty() )
+            /* unsupported number of products (see create). */
+            return create( eq, db, dE );
+
+          /* compile the resolved expressions in place of the originals. */
+          interaction::Equation<options> r_eq = eq;
+          unsigned int k = 0u;
+          for ( typename interaction::Equation<options>::TermList::iterator
+                  i = r_eq.products.begin(), e = r_eq.products.end();
+                i != e; ++i )
+            for ( int ni = 0; ni < i->n && k < resolved.size(); ++ni, ++k )
+              i->product_ops[ni] = resolved[k];
+
+          if ( k != resolved.size() || k != r_eq.numberProducts() )
+            throw std::runtime_error(
+              "InElastic:  cached 'ops' expressions do not match the equation"
+            );
+
+          return create( r_eq, db, dE );
+        }
+
+        /** Create the specific InElastic implementation appropriate for the
+         * number of products of the given equation and for the kinetic energy
+         * change dE.
+         */
+        static InElastic * create( const interaction::Equation<options> & eq,
+                                   const RuntimeDB<options> & db,
+                                   const double & dE ) {
           // TODO:  When chimp reactants are stored in a list someday, then we
           //        will need to count the number of reactants as well.
 
@@ -133,9 +191,9 @@ namespace chimp {
             case 2u : {
               if ( dE == 0.0 ) {
                 if ( has_expressions )
-                  return new InElastic_2X2<options,false,true>( x, eq, db );
+                  return new InElastic_2X2<options,false,true>( eq, db );
                 else
-                  return new InElastic_2X2<options,false,false>( x, eq, db );
+                  return new InElastic_2X2<options,false,false>( eq, db );
               } else {
                 /* dE comes to this point in SI units.
                  * dE/mu _MUST_ be in the same units as velocity as passed
@@ -144,18 +202,18 @@ namespace chimp {
                  * become desirable to use energy instead of velocity.
                  */
                 if ( has_expressions )
-                  return new InElastic_2X2<options,true,true>( x, eq, db, dE );
+                  return new InElastic_2X2<options,true,true>( eq, db, dE );
                 else
-                  return new InElastic_2X2<options,true,false>( x, eq, db, dE );
+                  return new InElastic_2X2<options,true,false>( eq, db, dE );
               }
             }
 
             case 3u : {
               if ( dE == 0.0 ) {
                 if ( has_expressions )
-                  return new InElastic_2X3<options,false,true>( x, eq, db );
+                  return new InElastic_2X3<options,false,true>( eq, db );
                 else
-                  return new InElastic_2X3<options,false,false>( x, eq, db );
+                  return new InElastic_2X3<options,false,false>( eq, db );
               } else {
                 /* dE comes to this point in SI units.
                  * dE/mu _MUST_ be in the same units as velocity as passed
@@ -164,9 +222,9 @@ namespace chimp {
                  * become desirable to use energy instead of velocity.
                  */
                 if ( has_expressions )
-                  return new InElastic_2X3<options,true,true>( x, eq, db, dE );
+                  return new InElastic_2X3<options,true,true>( eq, db, dE );
                 else
-                  return new InElastic_2X3<options,true,false>( x, eq, db, dE );
+                  return new InElastic_2X3<options,true,false>( eq, db, dE );
               }
             }
 
@@ -97,11 +97,10 @@ namespace chimp {
         /** Constructor that specifies the reduced mass explicitly. */
         template < typename Eq,
                    typename DB >
-        InElastic_2X2( const xml::Context & x,
-                       const Eq & eq,
+        InElastic_2X2( const Eq & eq,
                        const DB & db,
                        const double & dE = 0.0 )
-          : InElastic<options>( x, eq, db ),
+          : InElastic<options>( eq, db, dE ),
             mu_1_scale(0.0),
             dV2rel( dE / ( 0.5 * eq.reducedMass.value ) ) {
 
@@ -143,10 +142,14 @@ namespace chimp {
         /** Virtual NO-OP destructor. */
         virtual ~InElastic_2X2() { }
 
+        /* the other interfaces of Base (such as the std::vector version) are
+         * not hidden by the override below. */
+        using base::interact;
+
         /** Two-body collision interface. */
         virtual void interact( typename base::ParticleArgRef part1,
                                typename base::ParticleArgRef part2,
-                               std::vector< Particle > & products,
+                               ProductSink< Particle > & products,
                                typename options::RNG & rng ) const {
           /* Create products based on reactants. */
           detail::ParticleFactory::Scratch scratch( factories,
@@ -154,14 +157,13 @@ namespace chimp {
                                                     mu, muQ,
                                                     force_cm_calc,
                                                     force_cq_calc );
-          /* ensure that there is enough room for both so that products.back()
-           * doesn't become invalid after adding another. */
-          products.reserve( products.size() + 2u );
-          factories[0].create( products, part1, part2, scratch );
-          Particle & r1 = products.back();
-          factories[1].create( products, part1, part2, scratch );
-          Particle & r2 = products.back();
-
+          /* ensure that there is enough room for all products such that
+           * the references to the products remain valid. */
+          products.reserve( 2u );
+          Particle & r1 = factories[0].create( products, part1, part2,
+                                               scratch );
+          Particle & r2 = factories[1].create( products, part1, part2,
+                                               scratch );
 
           using xylose::SQR;
           using xylose::Vector;
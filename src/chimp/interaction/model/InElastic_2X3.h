@@ -104,11 +104,10 @@ namespace chimp {
         /** Constructor that specifies the reduced mass explicitly. */
         template < typename Eq,
                    typename DB >
-        InElastic_2X3( const xml::Context & x,
-                       const Eq & eq,
+        InElastic_2X3( const Eq & eq,
                        const DB & db,
                        const double & dE = 0.0 )
-          : InElastic<options>( x, eq, db ),
+          : InElastic<options>( eq, db, dE ),
             mu_1_scale(0.0),
             mu_2_scale(0.0),
             dV2rel( dE / ( 0.5 * eq.reducedMass.value ) ) {
@@ -153,10 +152,14 @@ namespace chimp {
         /** Virtual NO-OP destructor. */
         virtual ~InElastic_2X3() { }
 
+        /* the other interfaces of Base (such as the std::vector version) are
+         * not hidden by the override below. */
+        using base::interact;
+
         /** Two-body collision interface. */
         virtual void interact( typename base::ParticleArgRef part1,
                                typename base::ParticleArgRef part2,
-                               std::vector< Particle > & products,
+                               ProductSink< Particle > & products,
                                typename options::RNG & rng ) const {
           /* Create products based on reactants. */
           detail::ParticleFactory::Scratch scratch( factories,
@@ -164,16 +167,15 @@ namespace chimp {
                                                     mu, muQ,
                                                     force_cm_calc,
                                                     force_cq_calc );
-          /* ensure that there is enough room for both so that products.back()
-           * doesn't become invalid after adding another. */
-          products.reserve( products.size() + 3u );
-          factories[0].create( products, part1, part2, scratch );
-          Particle & r1 = products.back();
-          factories[1].create( products, part1, part2, scratch );
-          Particle & r2 = products.back();
-          factories[2].create( products, part1, part2, scratch );
-          Particle & r3 = products.back();
-
+          /* ensure that there is enough room for all products such that
+           * the references to the products remain valid. */
+          products.reserve( 3u );
+          Particle & r1 = factories[0].create( products, part1, part2,
+                                               scratch );
+          Particle & r2 = factories[1].create( products, part1, part2,
+                                               scratch );
+          Particle & r3 = factories[2].create( products, part1, part2,
+                                               scratch );
 
           using xylose::SQR;
           using xylose::Vector;
@@ -33,6 +33,7 @@
 #include <chimp/interaction/model/Base.h>
 #include <chimp/interaction/ReducedMass.h>
 #include <chimp/interaction/model/detail/vss_helpers.h>
+#include <chimp/interaction/model/detail/elastic_helpers.h>
 
 #include <xylose/power.h>
 #include <xylose/Vector.h>
@@ -41,6 +42,7 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 
 namespace chimp {
   namespace interaction {
@@ -50,6 +52,7 @@ namespace chimp {
       template < typename options >
       struct VSSElastic : Base<options> {
         /* TYPEDEFS */
+        typedef Base<options> super;
         typedef typename options::Particle Particle;
 
 
@@ -85,24 +88,25 @@ namespace chimp {
           return label;
         }
 
+        /* the other interfaces of Base (such as the std::vector version) are
+         * not hidden by the overrides below. */
+        using super::interact;
+
         /** Two-body collision interface.  const particle version. */
         virtual void interact( const Particle & part1,
                                const Particle & part2,
-                               std::vector< Particle > & products,
+                               ProductSink< Particle > & products,
                                typename options::RNG & rng ) const {
-          products.reserve( products.size() + 2u );
-          products.push_back( part1 );
-          products.push_back( part2 );
-
-          typename std::vector< Particle >::reverse_iterator rbeg
-            = products.rbegin();
-          interact( *(rbeg+1), *rbeg, rng );
+          products.reserve( 2u );
+          Particle & r1 = products.append( part1 );
+          Particle & r2 = products.append( part2 );
+          interact( r1, r2, rng );
         }
 
         /** Two-body collision interface.  in-place operation version */
         virtual void interact( Particle & part1,
                                Particle & part2,
-                               std::vector< Particle > & products,
+                               ProductSink< Particle > & products,
                                typename options::RNG & rng ) const {
           interact( part1, part2, rng );
         }
@@ -178,6 +182,86 @@ namespace chimp {
 
         } // collide
 
+        /** Batched binary elastic collisions of the VSS model of pairs of
+         * particles whose velocities are stored as a structure of arrays.
+         * The deflection angle is sampled with std::pow (rather than
+         * xylose::fast_pow of the scalar version) such that the loop can be
+         * vectorized.
+         * @see Elastic::interactPairs for the arguments and requirements.
+         */
+        template < typename RNG >
+        void interactPairs( double * vx, double * vy, double * vz,
+                            const unsigned int * first,
+                            const unsigned int * second,
+                            const std::size_t & n,
+                            RNG & rng ) const {
+          interactBlocks( detail::ComponentVelocities( vx, vy, vz ),
+                          first, second, n, rng );
+        }
+
+        /** Batched VSS elastic collisions of pairs of particles whose velocities
+         * are stored as one array of vectors, such as SoAParticles::v.
+         * @see Elastic::interactPairs for the arguments and requirements.
+         */
+        template < typename RNG >
+        void interactPairs( xylose::Vector<double,3u> * v,
+                            const unsigned int * first,
+                            const unsigned int * second,
+                            const std::size_t & n,
+                            RNG & rng ) const {
+          interactBlocks( detail::VectorVelocities( v ),
+                          first, second, n, rng );
+        }
+
+        /** The block loop of both versions of interactPairs. */
+        template < typename Velocities,
+                   typename RNG >
+        void interactBlocks( const Velocities & v,
+                             const unsigned int * first,
+                             const unsigned int * second,
+                             const std::size_t & n,
+                             RNG & rng ) const {
+          const std::size_t bs = detail::PairBlock::size;
+          detail::PairBlock block;
+
+          for ( std::size_t k0 = 0u; k0 < n; k0 += bs ) {
+            const std::size_t nk = std::min( n - k0, bs );
+            block.gather( v, first + k0, second + k0, nk, mu, rng );
+
+            for ( std::size_t k = 0u; k < nk; ++k ) {
+              const double gx = block.g[0][k];
+              const double gy = block.g[1][k];
+              const double gz = block.g[2][k];
+              const double s  = block.speed[k];
+
+              /* see interact(Particle&,Particle&,RNG&) above. */
+              const double B = 2.0 * std::pow( block.r0[k], vss_param_inv )
+                             - 1.0;
+              const double A = std::sqrt( 1.0 - B*B );
+              const double C = 2.0 * M_PI * block.r1[k];
+              const double COSC = std::cos(C);
+              const double SINC = std::sin(C);
+              const double D = std::sqrt( gy*gy + gz*gz );
+
+              /* both branches are computed such that the loop has no
+               * branches. */
+              const bool big_D = D > 1.0E-6;
+              const double A_D = big_D ? A / D : 0.0;
+
+              block.g[0][k] = big_D ? B * gx + A * SINC * D
+                                    : B * gx;
+              block.g[1][k] = big_D ? B * gy + A_D * (  s  * gz * COSC
+                                                      - gx * gy * SINC )
+                                    : A * COSC * gx;
+              block.g[2][k] = big_D ? B * gz - A_D * (  s  * gy * COSC
+                                                      + gx * gz * SINC )
+                                    : A * SINC * gx;
+            }
+
+            block.scatter( v, first + k0, second + k0, mu );
+          }
+        }
+
         /** load a new instance of the Interaction. */
         virtual
         VSSElastic * new_load( const xml::Context & x,
@@ -185,6 +269,23 @@ namespace chimp {
                                const RuntimeDB<options> & db ) const {
           return new VSSElastic( x, eq.reducedMass );
         }
+
+        /** Save the VSS parameter to a binary cache. */
+        virtual void save( BinaryWriter & out ) const {
+          out.write( label );
+          out.write( vss_param_inv );
+        }
+
+        /** Load a new instance of the Interaction from a binary cache. */
+        virtual
+        VSSElastic * new_load( BinaryReader & in,
+                               const interaction::Equation<options> & eq,
+                               const RuntimeDB<options> & db ) const {
+          VSSElastic * retval = new VSSElastic;
+          retval->mu = eq.reducedMass;
+          in.read( retval->vss_param_inv );
+          return retval;
+        }
       };
 
       template < typename options >
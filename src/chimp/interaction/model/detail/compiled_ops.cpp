@@ -0,0 +1,770 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Implementation of the compiler of inelastic 'ops' expressions.
+ */
+
+#include <chimp/interaction/model/detail/compiled_ops.h>
+
+#include <chimp/physical_calc.h>
+
+#include <physical/calc/Driver.h>
+#include <physical/math.h>
+
+#include <boost/math/special_functions/asinh.hpp>
+#include <boost/math/special_functions/acosh.hpp>
+#include <boost/math/special_functions/atanh.hpp>
+#include <boost/math/special_functions/erf.hpp>
+#include <boost/math/special_functions/gamma.hpp>
+#include <boost/math/special_functions/sinc.hpp>
+
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace chimp {
+  namespace interaction {
+    namespace model {
+      namespace detail {
+
+        namespace {
+
+          using runtime::physical::Quantity;
+
+          typedef CompiledOps::Node Node;
+          typedef CompiledOps::NodePtr NodePtr;
+          typedef xylose::Vector<double,3u> OpsContext::* VectorMember;
+
+          struct Constant : Node {
+            double value;
+            explicit Constant( const double & value ) : value(value) { }
+            virtual double evaluate( OpsContext & ) const { return value; }
+          };
+
+          /** P(n,item) */
+          struct Source : Node {
+            unsigned int n;
+            unsigned int item;
+            Source( const unsigned int & n, const unsigned int & item )
+              : n(n), item(item) { }
+            virtual double evaluate( OpsContext & ctx ) const {
+              return ctx.source[n][item];
+            }
+          };
+
+          /** CM(i) and CQ(i) */
+          struct Component : Node {
+            VectorMember member;
+            unsigned int i;
+            Component( const VectorMember & member, const unsigned int & i )
+              : member(member), i(i) { }
+            virtual double evaluate( OpsContext & ctx ) const {
+              return (ctx.*member)[i];
+            }
+          };
+
+          struct Negate : Node {
+            NodePtr a;
+            explicit Negate( const NodePtr & a ) : a(a) { }
+            virtual double evaluate( OpsContext & ctx ) const {
+              return - a->evaluate(ctx);
+            }
+          };
+
+          struct Add {
+            double operator() ( double a, double b ) const { return a + b; }
+          };
+
+          struct Subtract {
+            double operator() ( double a, double b ) const { return a - b; }
+          };
+
+          struct Multiply {
+            double operator() ( double a, double b ) const { return a * b; }
+          };
+
+          struct Divide {
+            double operator() ( double a, double b ) const { return a / b; }
+          };
+
+          struct Power {
+            double operator() ( double a, double b ) const {
+              return std::pow(a, b);
+            }
+          };
+
+          template < typename Op >
+          struct Binary : Node {
+            NodePtr a, b;
+            Binary( const NodePtr & a, const NodePtr & b ) : a(a), b(b) { }
+            virtual double evaluate( OpsContext & ctx ) const {
+              return Op()( a->evaluate(ctx), b->evaluate(ctx) );
+            }
+          };
+
+          typedef double (*Function1Ptr)( double );
+          typedef double (*Function2Ptr)( double, double );
+
+          struct Function1 : Node {
+            Function1Ptr f;
+            NodePtr a;
+            Function1( const Function1Ptr & f, const NodePtr & a )
+              : f(f), a(a) { }
+            virtual double evaluate( OpsContext & ctx ) const {
+              return f( a->evaluate(ctx) );
+            }
+          };
+
+          struct Function2 : Node {
+            Function2Ptr f;
+            NodePtr a, b;
+            Function2( const Function2Ptr & f,
+                       const NodePtr & a,
+                       const NodePtr & b )
+              : f(f), a(a), b(b) { }
+            virtual double evaluate( OpsContext & ctx ) const {
+              return f( a->evaluate(ctx), b->evaluate(ctx) );
+            }
+          };
+
+          /** setPosition(x,y,z) and setVelocity(vx,vy,vz) */
+          struct SetVector : Node {
+            VectorMember member;
+            unsigned int flag;
+            NodePtr a[3];
+            SetVector( const VectorMember & member,
+                       const unsigned int & flag,
+                       const std::vector< NodePtr > & args )
+              : member(member), flag(flag) {
+              a[0] = args[0];
+              a[1] = args[1];
+              a[2] = args[2];
+            }
+            virtual double evaluate( OpsContext & ctx ) const {
+              xylose::Vector<double,3u> & v = ctx.*member;
+              v[0] = a[0]->evaluate(ctx);
+              v[1] = a[1]->evaluate(ctx);
+              v[2] = a[2]->evaluate(ctx);
+              ctx.assigned |= flag;
+              return 1.0;
+            }
+          };
+
+          /** setWeight(w) */
+          struct SetWeight : Node {
+            NodePtr w;
+            explicit SetWeight( const NodePtr & w ) : w(w) { }
+            virtual double evaluate( OpsContext & ctx ) const {
+              ctx.weight = w->evaluate(ctx);
+              ctx.assigned |= OpsContext::SET_WEIGHT;
+              return 1.0;
+            }
+          };
+
+          double abs_( double a ) { return std::fabs(a); }
+          double sqrt_( double a ) { return std::sqrt(a); }
+          double exp_( double a ) { return std::exp(a); }
+          double log_( double a ) { return std::log(a); }
+          double log10_( double a ) { return std::log10(a); }
+          double sin_( double a ) { return std::sin(a); }
+          double cos_( double a ) { return std::cos(a); }
+          double tan_( double a ) { return std::tan(a); }
+          double asin_( double a ) { return std::asin(a); }
+          double acos_( double a ) { return std::acos(a); }
+          double atan_( double a ) { return std::atan(a); }
+          double sinh_( double a ) { return std::sinh(a); }
+          double cosh_( double a ) { return std::cosh(a); }
+          double tanh_( double a ) { return std::tanh(a); }
+          double asinh_( double a ) { return boost::math::asinh(a); }
+          double acosh_( double a ) { return boost::math::acosh(a); }
+          double atanh_( double a ) { return boost::math::atanh(a); }
+          double erf_( double a ) { return boost::math::erf(a); }
+          double erfc_( double a ) { return boost::math::erfc(a); }
+          double gamma_( double a ) { return boost::math::tgamma(a); }
+          double sinc_( double a ) { return boost::math::sinc_pi(a); }
+          double floor_( double a ) { return std::floor(a); }
+          double ceil_( double a ) { return std::ceil(a); }
+          double real_( double a ) { return a; }
+          double imag_( double ) { return 0.0; }
+          double pow_( double a, double b ) { return std::pow(a,b); }
+          double atan2_( double a, double b ) { return std::atan2(a,b); }
+          double max_( double a, double b ) { return a < b ? b : a; }
+          double min_( double a, double b ) { return b < a ? b : a; }
+
+          /** How the units of the result of a function follow from the units
+           * of its argument(s). */
+          enum FunctionUnits {
+            /** The argument(s) must be dimensionless, as is the result. */
+            DIMENSIONLESS,
+
+            /** The result has the units of the (matching) arguments. */
+            SAME,
+
+            /** The result has the square root of the units of the argument. */
+            SQRT,
+
+            /** The arguments must match and the result is dimensionless. */
+            MATCHING_DIMENSIONLESS
+          };
+
+          struct Function1Info {
+            const char * name;
+            Function1Ptr f;
+            FunctionUnits units;
+          };
+
+          const Function1Info * findFunction1( const std::string & name ) {
+            static const Function1Info table[] = {
+              { "abs",   &abs_,   SAME }, { "fabs",  &abs_,   SAME },
+              { "floor", &floor_, SAME }, { "ceil",  &ceil_,  SAME },
+              { "real",  &real_,  SAME }, { "conj",  &real_,  SAME },
+              { "imag",  &imag_,  SAME }, { "sqrt",  &sqrt_,  SQRT },
+              { "exp",   &exp_,   DIMENSIONLESS },
+              { "log",   &log_,   DIMENSIONLESS },
+              { "ln",    &log_,   DIMENSIONLESS },
+              { "log10", &log10_, DIMENSIONLESS },
+              { "sin",   &sin_,   DIMENSIONLESS },
+              { "cos",   &cos_,   DIMENSIONLESS },
+              { "tan",   &tan_,   DIMENSIONLESS },
+              { "asin",  &asin_,  DIMENSIONLESS },
+              { "acos",  &acos_,  DIMENSIONLESS },
+              { "atan",  &atan_,  DIMENSIONLESS },
+              { "sinh",  &sinh_,  DIMENSIONLESS },
+              { "cosh",  &cosh_,  DIMENSIONLESS },
+              { "tanh",  &tanh_,  DIMENSIONLESS },
+              { "asinh", &asinh_, DIMENSIONLESS },
+              { "acosh", &acosh_, DIMENSIONLESS },
+              { "atanh", &atanh_, DIMENSIONLESS },
+              { "erf",   &erf_,   DIMENSIONLESS },
+              { "erfc",  &erfc_,  DIMENSIONLESS },
+              { "gamma", &gamma_, DIMENSIONLESS },
+              { "sinc",  &sinc_,  DIMENSIONLESS }
+            };
+            for ( unsigned int i = 0u; i < sizeof(table)/sizeof(table[0]); ++i )
+              if ( name == table[i].name )
+                return &table[i];
+            return NULL;
+          }
+
+          struct Function2Info {
+            const char * name;
+            Function2Ptr f;
+            FunctionUnits units;
+          };
+
+          const Function2Info * findFunction2( const std::string & name ) {
+            static const Function2Info table[] = {
+              { "atan2", &atan2_, MATCHING_DIMENSIONLESS },
+              { "max",   &max_,   SAME },
+              { "min",   &min_,   SAME }
+            };
+            for ( unsigned int i = 0u; i < sizeof(table)/sizeof(table[0]); ++i )
+              if ( name == table[i].name )
+                return &table[i];
+            return NULL;
+          }
+
+          int findValueType( const std::string & name ) {
+            static const char * names[OpsContext::N_VALUE_TYPES] = {
+              "X", "Y", "Z", "VX", "VY", "VZ", "WEIGHT", "SPECIES_CHARGE"
+            };
+            for ( int i = 0; i < OpsContext::N_VALUE_TYPES; ++i )
+              if ( name == names[i] )
+                return i;
+            return -1;
+          }
+
+          const Constant * asConstant( const NodePtr & n ) {
+            return dynamic_cast< const Constant * >( n.get() );
+          }
+
+          /** The units of q with a (positive) coefficient of one. */
+          Quantity unitsOf( const Quantity & q ) {
+            const double c = std::fabs( q.getCoeff<double>() );
+            if ( c == 0.0 || c != c )
+              return q;
+            return q / Quantity(c);
+          }
+
+          bool isDimensionless( const Quantity & q ) {
+            try {
+              q.assertUnitless();
+              return true;
+            } catch ( const std::exception & ) {
+              return false;
+            }
+          }
+
+          bool matches( const Quantity & a, const Quantity & b ) {
+            try {
+              a.assertMatch(b);
+              return true;
+            } catch ( const std::exception & ) {
+              return false;
+            }
+          }
+
+
+          /** A compiled (sub-)expression and its units.  The units are
+           * propagated with the Quantity arithmetic of the units calculator,
+           * such that the rules of the calculator are checked once during
+           * compilation instead of on each evaluation.  Particle values
+           * (P(n,item), CM(i), CQ(i)) are dimensionless SI values, just as
+           * when the expressions were evaluated by the calculator. */
+          struct Expr {
+            NodePtr node;
+            Quantity units;
+
+            Expr( const NodePtr & node, const Quantity & units = Quantity(1.0) )
+              : node(node), units( unitsOf(units) ) { }
+
+            const Constant * constant() const { return asConstant(node); }
+          };
+
+          /** Create a binary operation, folding constant operands. */
+          template < typename Op >
+          NodePtr makeBinary( const NodePtr & a, const NodePtr & b ) {
+            const Constant * ca = asConstant(a);
+            const Constant * cb = asConstant(b);
+            if ( ca && cb )
+              return NodePtr( new Constant( Op()( ca->value, cb->value ) ) );
+            return NodePtr( new Binary<Op>( a, b ) );
+          }
+
+
+          /** Recursive descent parser for the 'ops' expressions:
+           *    statements := expr ( ';' expr )*
+           *    expr       := term ( ('+'|'-') term )*
+           *    term       := unary ( ('*'|'/') unary )*
+           *    unary      := ('-'|'+') unary | power
+           *    power      := primary ( '^' unary )?
+           *    primary    := number | name | name '(' args ')' | '(' expr ')'
+           */
+          class Parser {
+            const std::string & str;
+            std::string::size_type pos;
+
+            /** The calculator context in which symbols are resolved (the
+             * process-wide calculator if NULL). */
+            const CalcContext * calc;
+
+          public:
+            bool uses_cm;
+            bool uses_cq;
+
+            /** The expression with each symbol that was resolved by the units
+             * calculator replaced by its (SI) coefficient. */
+            std::string resolved;
+
+            Parser( const std::string & str, const CalcContext * calc )
+              : str(str), pos(0u), calc(calc),
+                uses_cm(false), uses_cq(false), copied(0u) { }
+
+            void statements( std::vector< NodePtr > & out ) {
+              while ( true ) {
+                skipSpace();
+                while ( accept(';') )
+                  skipSpace();
+                if ( pos >= str.size() )
+                  break;
+
+                out.push_back( expr().node );
+
+                skipSpace();
+                if ( pos < str.size() && !accept(';') )
+                  fail( "expected ';' or end of expression" );
+              }
+
+              resolved += str.substr( copied );
+            }
+
+          private:
+            /** The position in str up to which resolved is complete. */
+            std::string::size_type copied;
+
+            void fail( const std::string & msg ) const {
+              std::ostringstream ostr;
+              ostr << "chimp::interaction::model::detail::CompiledOps:  "
+                   << msg << " at position " << pos << " in '" << str << '\'';
+              throw std::runtime_error( ostr.str() );
+            }
+
+            void skipSpace() {
+              while ( pos < str.size() &&
+                      std::isspace( static_cast<unsigned char>(str[pos]) ) )
+                ++pos;
+            }
+
+            bool accept( const char & c ) {
+              skipSpace();
+              if ( pos < str.size() && str[pos] == c ) {
+                ++pos;
+                return true;
+              }
+              return false;
+            }
+
+            void expect( const char & c ) {
+              if ( !accept(c) )
+                fail( std::string("expected '") + c + '\'' );
+            }
+
+            void requireDimensionless( const Expr & e,
+                                       const std::string & what ) const {
+              if ( !isDimensionless( e.units ) )
+                fail( what + " must be dimensionless" );
+            }
+
+            void requireMatch( const Expr & a,
+                               const Expr & b,
+                               const std::string & what ) const {
+              if ( !matches( a.units, b.units ) )
+                fail( "units of the operands of " + what + " do not match" );
+            }
+
+            /** The argument must be dimensionless (an SI value) or have the
+             * given units. */
+            void requireUnits( const Expr & e,
+                               const Quantity & units,
+                               const std::string & what ) const {
+              if ( !isDimensionless( e.units ) && !matches( e.units, units ) )
+                fail( "invalid units of the argument(s) of " + what );
+            }
+
+            Expr expr() {
+              Expr lhs = term();
+              while ( true ) {
+                if      ( accept('+') ) {
+                  const Expr rhs = term();
+                  requireMatch( lhs, rhs, "'+'" );
+                  lhs.node = makeBinary<Add>( lhs.node, rhs.node );
+                } else if ( accept('-') ) {
+                  const Expr rhs = term();
+                  requireMatch( lhs, rhs, "'-'" );
+                  lhs.node = makeBinary<Subtract>( lhs.node, rhs.node );
+                } else
+                  return lhs;
+              }
+            }
+
+            Expr term() {
+              Expr lhs = unary();
+              while ( true ) {
+                if      ( accept('*') ) {
+                  const Expr rhs = unary();
+                  lhs = Expr( makeBinary<Multiply>( lhs.node, rhs.node ),
+                              lhs.units * rhs.units );
+                } else if ( accept('/') ) {
+                  const Expr rhs = unary();
+                  lhs = Expr( makeBinary<Divide>( lhs.node, rhs.node ),
+                              lhs.units / rhs.units );
+                } else
+                  return lhs;
+              }
+            }
+
+            Expr unary() {
+              if ( accept('-') ) {
+                Expr a = unary();
+                if ( const Constant * c = a.constant() )
+                  a.node = NodePtr( new Constant( - c->value ) );
+                else
+                  a.node = NodePtr( new Negate(a.node) );
+                return a;
+              }
+              if ( accept('+') )
+                return unary();
+              return power();
+            }
+
+            Expr power() {
+              Expr base = primary();
+              if ( accept('^') )
+                return makePower( base, unary(), "'^'" );
+              return base;
+            }
+
+            /** base^exponent.  The base may only have units if the exponent is
+             * a constant multiple of 1/2. */
+            Expr makePower( const Expr & base,
+                            const Expr & exponent,
+                            const std::string & what ) {
+              requireDimensionless( exponent, "the exponent of " + what );
+              const NodePtr node = makeBinary<Power>( base.node, exponent.node );
+
+              if ( isDimensionless( base.units ) )
+                return Expr( node );
+
+              const Constant * c = exponent.constant();
+              if ( !c || 2.0 * c->value != std::floor( 2.0 * c->value ) )
+                fail( "a base with units may only be raised to a constant "
+                      "integer or half-integer power in " + what );
+
+              const int n = static_cast<int>( 2.0 * c->value );
+              const Quantity root =
+                ( n % 2 ) ? sqrt( base.units ) : base.units;
+              Quantity units( 1.0 );
+              for ( int i = 0; i < std::abs(n) / ( n % 2 ? 1 : 2 ); ++i )
+                units = units * root;
+              if ( n < 0 )
+                units = Quantity(1.0) / units;
+              return Expr( node, units );
+            }
+
+            Expr primary() {
+              skipSpace();
+              if ( pos >= str.size() )
+                fail( "unexpected end of expression" );
+
+              if ( accept('(') ) {
+                Expr e = expr();
+                expect(')');
+                return e;
+              }
+
+              const char c = str[pos];
+              if ( std::isdigit( static_cast<unsigned char>(c) ) || c == '.' )
+                return number();
+
+              if ( std::isalpha( static_cast<unsigned char>(c) ) || c == '_' ) {
+                const std::string::size_type begin = pos;
+                std::string name = identifier();
+                if ( accept('(') )
+                  return call( name );
+                return symbol( name, begin );
+              }
+
+              fail( std::string("unexpected character '") + c + '\'' );
+              return Expr( NodePtr() );
+            }
+
+            Expr number() {
+              const char * begin = str.c_str() + pos;
+              char * end = NULL;
+              const double value = std::strtod( begin, &end );
+              if ( end == begin )
+                fail( "invalid number" );
+              pos += end - begin;
+              return Expr( NodePtr( new Constant(value) ) );
+            }
+
+            std::string identifier() {
+              const std::string::size_type begin = pos;
+              while ( pos < str.size() &&
+                      ( std::isalnum( static_cast<unsigned char>(str[pos]) ) ||
+                        str[pos] == '_' ) )
+                ++pos;
+              return str.substr( begin, pos - begin );
+            }
+
+            std::vector< Expr > arguments( const std::string & name,
+                                           const unsigned int & n ) {
+              std::vector< Expr > args;
+              if ( !accept(')') ) {
+                do {
+                  args.push_back( expr() );
+                } while ( accept(',') );
+                expect(')');
+              }
+
+              if ( args.size() != n ) {
+                std::ostringstream ostr;
+                ostr << name << ":  expected " << n << " argument(s)";
+                fail( ostr.str() );
+              }
+              return args;
+            }
+
+            /** Obtain the value of an argument that must be a dimensionless
+             * constant integer within [0, n). */
+            unsigned int index( const std::string & name,
+                                const Expr & arg,
+                                const unsigned int & n ) {
+              const Constant * c = arg.constant();
+              if ( !c || c->value != std::floor(c->value) ||
+                   c->value < 0.0 || c->value >= n ||
+                   !isDimensionless( arg.units ) ) {
+                std::ostringstream ostr;
+                ostr << name << ":  index must be a constant integer in [0,"
+                     << n << ')';
+                fail( ostr.str() );
+              }
+              return static_cast<unsigned int>( c->value );
+            }
+
+            Expr call( const std::string & name ) {
+              using runtime::physical::unit::m;
+              using runtime::physical::unit::s;
+
+              if ( name == "P" ) {
+                /* the item argument is looked up by name first, such that it
+                 * need not be known to the units calculator. */
+                std::vector< Expr > args = arguments( name, 2u );
+                return Expr( NodePtr(
+                  new Source( index( "P(n,item)", args[0], 2u ),
+                              index( "P(n,item)", args[1],
+                                     OpsContext::N_VALUE_TYPES ) )
+                ) );
+              }
+
+              if ( name == "CM" || name == "CQ" ) {
+                std::vector< Expr > args = arguments( name, 1u );
+                const bool cm = ( name == "CM" );
+                ( cm ? uses_cm : uses_cq ) = true;
+                return Expr( NodePtr(
+                  new Component( cm ? &OpsContext::cm : &OpsContext::cq,
+                                 index( name + "(n)", args[0], 3u ) )
+                ) );
+              }
+
+              if ( name == "setPosition" || name == "setVelocity" ) {
+                const bool x = ( name == "setPosition" );
+                std::vector< Expr > args = arguments( name, 3u );
+                std::vector< NodePtr > nodes;
+                for ( unsigned int i = 0u; i < args.size(); ++i ) {
+                  requireUnits( args[i], x ? m : m/s, name );
+                  nodes.push_back( args[i].node );
+                }
+
+                return Expr( NodePtr(
+                  new SetVector( x ? &OpsContext::position
+                                   : &OpsContext::velocity,
+                                 x ? OpsContext::SET_POSITION
+                                   : OpsContext::SET_VELOCITY,
+                                 nodes )
+                ) );
+              }
+
+              if ( name == "setWeight" ) {
+                const Expr w = arguments( name, 1u )[0];
+                requireDimensionless( w, "the argument of " + name );
+                return Expr( NodePtr( new SetWeight( w.node ) ) );
+              }
+
+              if ( name == "pow" ) {
+                std::vector< Expr > args = arguments( name, 2u );
+                return makePower( args[0], args[1], name );
+              }
+
+              if ( const Function1Info * f = findFunction1( name ) ) {
+                const Expr a = arguments( name, 1u )[0];
+
+                Quantity units( 1.0 );
+                switch ( f->units ) {
+                  case SAME:
+                    units = a.units;
+                    break;
+                  case SQRT:
+                    units = sqrt( a.units );
+                    break;
+                  default:
+                    requireDimensionless( a, "the argument of " + name );
+                    break;
+                }
+
+                if ( const Constant * c = a.constant() )
+                  return Expr( NodePtr( new Constant( f->f( c->value ) ) ),
+                               units );
+                return Expr( NodePtr( new Function1( f->f, a.node ) ), units );
+              }
+
+              if ( const Function2Info * f = findFunction2( name ) ) {
+                std::vector< Expr > args = arguments( name, 2u );
+                requireMatch( args[0], args[1], name );
+                const Quantity units =
+                  f->units == SAME ? args[0].units : Quantity(1.0);
+
+                const Constant * ca = args[0].constant();
+                const Constant * cb = args[1].constant();
+                if ( ca && cb )
+                  return Expr(
+                    NodePtr( new Constant( f->f( ca->value, cb->value ) ) ),
+                    units );
+                return Expr(
+                  NodePtr( new Function2( f->f, args[0].node, args[1].node ) ),
+                  units );
+              }
+
+              fail( "unknown function '" + name + '\'' );
+              return Expr( NodePtr() );
+            }
+
+            Expr symbol( const std::string & name,
+                         const std::string::size_type & begin ) {
+              const int vt = findValueType( name );
+              if ( vt >= 0 )
+                return Expr( NodePtr( new Constant(vt) ) );
+
+              /* any other symbol (such as a physical constant or unit) is
+               * resolved exactly once here. */
+              using runtime::physical::calc::Driver;
+              try {
+                Quantity q;
+                if ( calc ) {
+                  CalcContext::Scope scope( *calc );
+                  q = Driver::instance().eval( name );
+                } else
+                  q = Driver::instance().eval( name );
+
+                std::ostringstream value;
+                value.precision( 17 );
+                value << '(' << q.getCoeff<double>() << ')';
+                resolved += str.substr( copied, begin - copied ) + value.str();
+                copied = begin + name.size();
+
+                return Expr( NodePtr( new Constant( q.getCoeff<double>() ) ),
+                             q );
+              } catch ( const std::exception & e ) {
+                fail( "unknown symbol '" + name + "' (" + e.what() + ')' );
+              }
+              return Expr( NodePtr() );
+            }
+          };
+
+        } /* namespace (anon) */
+
+
+        CompiledOps::CompiledOps( const std::string & ops )
+          : uses_cm(false), uses_cq(false) {
+          Parser parser( ops, NULL );
+          parser.statements( statements );
+          uses_cm = parser.uses_cm;
+          uses_cq = parser.uses_cq;
+          resolved = parser.resolved;
+        }
+
+        CompiledOps::CompiledOps( const std::string & ops,
+                                  const CalcContext & calc )
+          : uses_cm(false), uses_cq(false) {
+          Parser parser( ops, &calc );
+          parser.statements( statements );
+          uses_cm = parser.uses_cm;
+          uses_cq = parser.uses_cq;
+          resolved = parser.resolved;
+        }
+
+      } /* namespace chimp::interaction::model::detail */
+    } /* namespace chimp::interaction::model */
+  } /* namespace chimp::interaction */
+} /* namespace chimp */
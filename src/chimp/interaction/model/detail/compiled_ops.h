@@ -0,0 +1,269 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Compiled form of the 'ops' expressions of inelastic interaction products.
+ */
+
+#ifndef chimp_interaction_model_detail_compiled_ops_h
+#define chimp_interaction_model_detail_compiled_ops_h
+
+#include <chimp/accessors.h>
+#include <chimp/property/charge.h>
+
+#include <xylose/Vector.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+#include <string>
+
+namespace chimp {
+  class CalcContext;
+
+  namespace interaction {
+    namespace model {
+      namespace detail {
+
+        /** Explicit evaluation context of a CompiledOps instance.
+         * The context holds copies of all source particle information that the
+         * 'ops' expressions may request as well as the values that the
+         * expressions assign to the target particle.  Since each call of
+         * CompiledOps::evaluate uses its own context, evaluation is reentrant
+         * (and thus thread-safe).
+         */
+        struct OpsContext {
+          /* TYPEDEFS */
+          /** The items that can be requested with P(n,item). */
+          enum VALUE_TYPE {
+            X=0, Y=1, Z=2,
+            VX=3, VY=4, VZ=5,
+            WEIGHT,
+            SPECIES_CHARGE,
+            N_VALUE_TYPES
+          };
+
+          /** Bit flags of which target values have been assigned. */
+          enum TARGET_FLAGS {
+            SET_POSITION  = 0x1,
+            SET_VELOCITY  = 0x2,
+            SET_WEIGHT    = 0x4
+          };
+
+
+          /* MEMBER STORAGE */
+          /** Values of the (two) source particles:  source[n][item]. */
+          double source[2][N_VALUE_TYPES];
+
+          /** Center of mass of the source particles. */
+          xylose::Vector<double,3u> cm;
+
+          /** Center of charge of the source particles. */
+          xylose::Vector<double,3u> cq;
+
+          /** Position assigned by setPosition(x,y,z). */
+          xylose::Vector<double,3u> position;
+
+          /** Velocity assigned by setVelocity(vx,vy,vz). */
+          xylose::Vector<double,3u> velocity;
+
+          /** Weight assigned by setWeight(w). */
+          double weight;
+
+          /** Which of the target values have been assigned (TARGET_FLAGS). */
+          unsigned int assigned;
+
+
+          /* MEMBER FUNCTIONS */
+          /** Fill the source particle values.
+           * @param part1
+           *    The first source particle (P(0,...)).
+           * @param part2
+           *    The second source particle (P(1,...)).
+           * @param db
+           *    The database from which the charge of the species is obtained.
+           * @param scratch
+           *    The scratch space of ParticleFactory which holds the center of
+           *    mass and the center of charge.
+           */
+          template < typename Particle, typename DB, typename Scratch >
+          OpsContext( const Particle & part1,
+                      const Particle & part2,
+                      const DB & db,
+                      const Scratch & scratch )
+            : cm( scratch.cm ), cq( scratch.cq ),
+              weight(0.0), assigned(0u) {
+            load( source[0], part1, db );
+            load( source[1], part2, db );
+          }
+
+          /** Apply all assigned values to the target particle. */
+          template < typename Particle >
+          void apply( Particle & target ) const {
+            using chimp::accessors::particle::setPosition;
+            using chimp::accessors::particle::setVelocity;
+            using chimp::accessors::particle::setWeight;
+
+            if ( assigned & SET_POSITION )
+              setPosition( target, position );
+            if ( assigned & SET_VELOCITY )
+              setVelocity( target, velocity );
+            if ( assigned & SET_WEIGHT )
+              setWeight( target, weight );
+          }
+
+        private:
+          template < typename Particle, typename DB >
+          static void load( double (&v)[N_VALUE_TYPES],
+                            const Particle & p,
+                            const DB & db ) {
+            using chimp::accessors::particle::position;
+            using chimp::accessors::particle::velocity;
+            using chimp::accessors::particle::weight;
+            using chimp::accessors::particle::species;
+            using chimp::property::charge;
+
+            const xylose::Vector<double,3u> & x = position(p);
+            const xylose::Vector<double,3u> & u = velocity(p);
+            v[X] = x[0];
+            v[Y] = x[1];
+            v[Z] = x[2];
+            v[VX] = u[0];
+            v[VY] = u[1];
+            v[VZ] = u[2];
+            v[WEIGHT] = weight(p);
+            v[SPECIES_CHARGE] = db[species(p)].charge::value;
+          }
+        };
+
+
+        /** The 'ops' expressions of a single product particle, compiled once
+         * into a tree of operations over doubles.
+         *
+         * The supported syntax is that of the infix calculator for real
+         * values:  numbers, + - * / ^, parentheses, the functions of the math
+         * library (sqrt, exp, ln, sin, erf, gamma, ..., pow(a,b), atan2(a,b),
+         * min(a,b), max(a,b)), and the interaction helpers
+         *  - setPosition(x,y,z), setVelocity(vx,vy,vz), setWeight(w)
+         *  - P(n,item) where n is 0 or 1 and item is one of X, Y, Z, VX, VY,
+         *    VZ, WEIGHT, SPECIES_CHARGE
+         *  - CM(i), CQ(i) where i is 0, 1, or 2.
+         *  .
+         * Multiple statements may be separated by ';'.  Any other symbol is
+         * resolved once during compilation by the units calculator and is
+         * thereafter replaced by its (SI) coefficient.
+         *
+         * The units of all sub-expressions are checked during compilation with
+         * the rules of the units calculator (operands of + and - must match,
+         * arguments of exp, sin, ... must be dimensionless, ...).  As before,
+         * the particle values P(n,item), CM(i), and CQ(i) are dimensionless
+         * SI values.  The arguments of setPosition and setVelocity must be
+         * dimensionless or have units of length and velocity respectively.
+         * All checks of indices, symbols, and units are thus done once at load
+         * time and evaluation needs neither the calculator nor any global
+         * state.
+         */
+        class CompiledOps {
+          /* TYPEDEFS */
+        public:
+          /** Interface of all nodes of the operation tree. */
+          struct Node {
+            virtual ~Node() { }
+            virtual double evaluate( OpsContext & ctx ) const = 0;
+          };
+
+          typedef boost::shared_ptr< const Node > NodePtr;
+
+
+          /* MEMBER STORAGE */
+        private:
+          /** The compiled statements, evaluated in order. */
+          std::vector< NodePtr > statements;
+
+          /** Whether CM(i) is used by any statement. */
+          bool uses_cm;
+
+          /** Whether CQ(i) is used by any statement. */
+          bool uses_cq;
+
+          /** The compiled expression with the symbols resolved (see
+           * getResolved()). */
+          std::string resolved;
+
+
+          /* MEMBER FUNCTIONS */
+        public:
+          /** Default constructor creates an empty set of operations. */
+          CompiledOps() : uses_cm(false), uses_cq(false) { }
+
+          /** Compile the given 'ops' expression, resolving symbols with the
+           * process-wide units calculator.
+           * @throws std::runtime_error on any syntax error, invalid index,
+           * unknown symbol, or inconsistent units.
+           */
+          explicit CompiledOps( const std::string & ops );
+
+          /** Compile the given 'ops' expression, resolving symbols within the
+           * given calculator context (such as RuntimeDB::calculator).
+           * @throws std::runtime_error on any syntax error, invalid index,
+           * unknown symbol, or inconsistent units.
+           */
+          CompiledOps( const std::string & ops, const CalcContext & calc );
+
+          /** The number of compiled statements. */
+          std::size_t size() const { return statements.size(); }
+
+          /** Whether there are no compiled statements. */
+          bool empty() const { return statements.empty(); }
+
+          /** Whether CM(i) is used by any statement. */
+          bool usesCM() const { return uses_cm; }
+
+          /** Whether CQ(i) is used by any statement. */
+          bool usesCQ() const { return uses_cq; }
+
+          /** The compiled expression with each symbol that was resolved by
+           * the units calculator replaced by its (SI) coefficient.  Compiling
+           * this expression again gives the same operations without requiring
+           * the calculator (the units have already been checked), such that
+           * it is stored in place of the original expression in a binary
+           * cache. */
+          const std::string & getResolved() const { return resolved; }
+
+          /** Evaluate all statements in order within the given context.
+           * @returns the value of the last statement (0 if empty).
+           */
+          double evaluate( OpsContext & ctx ) const {
+            double retval = 0.0;
+            for ( std::vector< NodePtr >::const_iterator i = statements.begin(),
+                                                       end = statements.end();
+                  i != end; ++i )
+              retval = (*i)->evaluate( ctx );
+            return retval;
+          }
+        };
+
+      } /* namespace chimp::interaction::model::detail */
+    } /* namespace chimp::interaction::model */
+  } /* namespace chimp::interaction */
+} /* namespace chimp */
+
+#endif // chimp_interaction_model_detail_compiled_ops_h
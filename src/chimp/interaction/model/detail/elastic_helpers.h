@@ -0,0 +1,171 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Helpers for the batched (structure-of-arrays) elastic interaction models.
+ */
+
+#ifndef chimp_interaction_model_detail_elastic_helpers_h
+#define chimp_interaction_model_detail_elastic_helpers_h
+
+#include <chimp/interaction/ReducedMass.h>
+#include <chimp/random/Philox.h>
+
+#include <xylose/Vector.h>
+
+#include <cmath>
+#include <cstddef>
+
+namespace chimp {
+  namespace interaction {
+    namespace model {
+      namespace detail {
+
+        /** Velocities of the batched elastic interaction models that are
+         * stored as three separate arrays of components. */
+        struct ComponentVelocities {
+          /** The arrays of the x, y, and z components. */
+          double * v[3];
+
+          ComponentVelocities( double * vx, double * vy, double * vz ) {
+            v[0] = vx;
+            v[1] = vy;
+            v[2] = vz;
+          }
+
+          /** Component d of the velocity of particle i. */
+          double & operator() ( const unsigned int & i,
+                                const unsigned int & d ) const {
+            return v[d][i];
+          }
+        };
+
+        /** Velocities of the batched elastic interaction models that are
+         * stored as one array of vectors (such as SoAParticles::v). */
+        struct VectorVelocities {
+          /** The array of velocities. */
+          xylose::Vector<double,3u> * v;
+
+          VectorVelocities( xylose::Vector<double,3u> * v ) : v( v ) { }
+
+          /** Component d of the velocity of particle i. */
+          double & operator() ( const unsigned int & i,
+                                const unsigned int & d ) const {
+            return v[i][d];
+          }
+        };
+
+        /** Scratch space for a block of pairs of the batched elastic
+         * interaction models (see Elastic::interactPairs and
+         * VSSElastic::interactPairs).
+         *
+         * The velocities of a block of pairs are gathered from the
+         * structure-of-arrays storage into contiguous arrays (gather), the
+         * post-collision relative velocities are computed by the model with
+         * simple loops over these arrays that the compiler can vectorize, and
+         * the results are written back (scatter).
+         */
+        struct PairBlock {
+          /* STATIC STORAGE */
+          /** The number of pairs of a full block. */
+          static const std::size_t size = 64u;
+
+
+          /* MEMBER STORAGE */
+          /** Velocity of the center of mass of each pair. */
+          double cm[3][size];
+
+          /** Relative velocity of each pair (v1 - v2).  The model replaces
+           * this by the post-collision relative velocity. */
+          double g[3][size];
+
+          /** Relative speed of each pair. */
+          double speed[size];
+
+          /** Random numbers for the model (two per pair). */
+          double r0[size];
+          double r1[size];
+
+          /** Number of pairs in the current block. */
+          std::size_t n;
+
+
+          /* MEMBER FUNCTIONS */
+          /** Gather the velocities of the given block of pairs and draw two
+           * random numbers per pair (in the same order as the scalar
+           * interaction models do:  both numbers of a pair before the numbers
+           * of the next pair).
+           */
+          template < typename Velocities,
+                     typename RNG >
+          void gather( const Velocities & v,
+                       const unsigned int * first,
+                       const unsigned int * second,
+                       const std::size_t & n,
+                       const ReducedMass & mu,
+                       RNG & rng ) {
+            this->n = n;
+            for ( std::size_t k = 0u; k < n; ++k ) {
+              const unsigned int a = first[k], b = second[k];
+              for ( unsigned int d = 0u; d < 3u; ++d ) {
+                cm[d][k] = mu.over_m2 * v(a,d) + mu.over_m1 * v(b,d);
+                g[d][k]  = v(a,d) - v(b,d);
+              }
+            }
+
+            {/* block-fill the random numbers (see chimp::random::fill). */
+              double r[2u * size];
+              random::fill( rng, r, 2u * n );
+              for ( std::size_t k = 0u; k < n; ++k ) {
+                r0[k] = r[2u*k];
+                r1[k] = r[2u*k + 1u];
+              }
+            }
+
+            for ( std::size_t k = 0u; k < n; ++k )
+              speed[k] = std::sqrt( g[0][k]*g[0][k] +
+                                    g[1][k]*g[1][k] +
+                                    g[2][k]*g[2][k] );
+          }
+
+          /** Write the post-collision velocities back to the
+           * structure-of-arrays storage. */
+          template < typename Velocities >
+          void scatter( const Velocities & v,
+                        const unsigned int * first,
+                        const unsigned int * second,
+                        const ReducedMass & mu ) const {
+            for ( std::size_t k = 0u; k < n; ++k ) {
+              const unsigned int a = first[k], b = second[k];
+              for ( unsigned int d = 0u; d < 3u; ++d ) {
+                v(a,d) = cm[d][k] + mu.over_m1 * g[d][k];
+                v(b,d) = cm[d][k] - mu.over_m2 * g[d][k];
+              }
+            }
+          }
+        };
+
+      } /* namespace chimp::interaction::model::detail */
+    } /* namespace chimp::interaction::model */
+  } /* namespace chimp::interaction */
+} /* namespace chimp */
+
+#endif // chimp_interaction_model_detail_elastic_helpers_h
@@ -32,6 +32,7 @@
 #include <chimp/property/mass.h>
 #include <chimp/property/charge.h>
 #include <chimp/interaction/ReducedMass.h>
+#include <chimp/physical_calc.h>
 
 #include <xylose/Vector.h>
 
@@ -342,35 +343,26 @@ BOOST_AUTO_TEST_SUITE( inelastic_helpers_tests ); // {
     using chimp::accessors::particle::weight;
     using chimp::accessors::particle::species;
 
-    using runtime::physical::calc::Driver;
-    void parse( const std::string & expr,
-                Driver::ExpressionVector & expressions ) {
-
-      Driver & calc = Driver::instance();
-      unsigned int cesz = calc.expressions.size();
-      calc.parse( expr );
-
-      Driver::ExpressionVector::iterator beg = calc.expressions.begin() + cesz,
-                                         end = calc.expressions.end();
-      expressions.insert( expressions.end(), beg, end );
-      // clean up
-      calc.expressions.erase( beg, end );
-    }
   }
 
   BOOST_AUTO_TEST_CASE( InteractionHelpers ) {
-    ////// adding the helpers...       //////
-    typedef cimd::InElasticExpressions<DB> Stuff;
-    Stuff::addInteractionHelpers();
-
-
-    Driver::ExpressionVector expressions;
-    ////// building cached expressions //////
-    parse( "P(0,X)", expressions );
-    parse( "setPosition(P(0,X)*P(0,Y),P(1,Y),P(0,Z))", expressions );
-    parse( "setVelocity(P(0,X)*P(0,VY),P(1,VY),P(0,VZ))", expressions );
-    parse( "setPosition(CM(0), CM(1), CM(2))", expressions );
-    parse( "setPosition(CQ(0), CQ(1), CQ(2))", expressions );
+    ////// compiling the expressions   //////
+    std::vector< cimd::CompiledOps > expressions;
+    expressions.push_back( cimd::CompiledOps( "P(0,X)" ) );
+    expressions.push_back(
+      cimd::CompiledOps( "setPosition(P(0,X)*P(0,Y),P(1,Y),P(0,Z))" ) );
+    expressions.push_back(
+      cimd::CompiledOps( "setVelocity(P(0,X)*P(0,VY),P(1,VY),P(0,VZ))" ) );
+    expressions.push_back(
+      cimd::CompiledOps( "setPosition(CM(0), CM(1), CM(2))" ) );
+    expressions.push_back(
+      cimd::CompiledOps( "setPosition(CQ(0), CQ(1), CQ(2))" ) );
+
+    BOOST_CHECK( !cimd::usesCenter( true,
+                   std::vector< cimd::CompiledOps >( expressions.begin(),
+                                                     expressions.begin()+3 ) ) );
+    BOOST_CHECK( cimd::usesCenter( true, expressions ) );
+    BOOST_CHECK( cimd::usesCenter( false, expressions ) );
 
     ////// evaluate some expressions...//////
     MyParticle r1, part1(V3(1,2,3),V3(4,5,6),1,0), part2(V3(7,8,9),V3(10,11,12),1,1);
@@ -384,20 +376,16 @@ BOOST_AUTO_TEST_SUITE( inelastic_helpers_tests ); // {
     );
     DB db;
 
-    Stuff & stuff = Stuff::instance();
-    stuff.target = & r1;
-    stuff.p0 = & part1;
-    stuff.p1 = & part2;
-    stuff.db_ptr = & db;
-    stuff.scratch = & scratch;
+    cimd::OpsContext ctx( part1, part2, db, scratch );
 
     BOOST_CHECK_EQUAL( r1.x[0], 0.0 );
     BOOST_CHECK_EQUAL( r1.x[1], 0.0 );
     BOOST_CHECK_EQUAL( r1.x[2], 0.0 );
 
-    expressions[0]->evaluate();
-    expressions[1]->evaluate();
-    expressions[2]->evaluate();
+    BOOST_CHECK_EQUAL( expressions[0].evaluate( ctx ), 1.0 );
+    expressions[1].evaluate( ctx );
+    expressions[2].evaluate( ctx );
+    ctx.apply( r1 );
 
     BOOST_CHECK_EQUAL( r1.x[0], 2.0 );
     BOOST_CHECK_EQUAL( r1.x[1], 8.0 );
@@ -407,15 +395,132 @@ BOOST_AUTO_TEST_SUITE( inelastic_helpers_tests ); // {
     BOOST_CHECK_EQUAL( r1.v[1], 11.0 );
     BOOST_CHECK_EQUAL( r1.v[2], 6.0 );
 
-    expressions[3]->evaluate(); // CM tests
+    expressions[3].evaluate( ctx ); // CM tests
+    ctx.apply( r1 );
     BOOST_CHECK_CLOSE( r1.x[0], 5.0, 1e-10 );
     BOOST_CHECK_CLOSE( r1.x[1], 6.0, 1e-10 );
     BOOST_CHECK_CLOSE( r1.x[2], 7.0, 1e-10 );
 
-    expressions[4]->evaluate(); // CQ tests
+    expressions[4].evaluate( ctx ); // CQ tests
+    ctx.apply( r1 );
     BOOST_CHECK_CLOSE( r1.x[0], 5.8, 1e-10 );
     BOOST_CHECK_CLOSE( r1.x[1], 6.8, 1e-10 );
     BOOST_CHECK_CLOSE( r1.x[2], 7.8, 1e-10 );
+
+    ////// the Process functor evaluates in its own context //////
+    MyParticle r2;
+    cimd::Process<true>()( expressions[2], r2, part1, part2, db, scratch );
+    BOOST_CHECK_EQUAL( r2.x[0], 0.0 );
+    BOOST_CHECK_EQUAL( r2.v[0], 5.0 );
+    BOOST_CHECK_EQUAL( r2.v[1], 11.0 );
+    BOOST_CHECK_EQUAL( r2.v[2], 6.0 );
+  }
+
+  BOOST_AUTO_TEST_CASE( CompiledOps ) {
+    MyParticle part1(V3(1,2,3),V3(4,5,6),2,0),
+               part2(V3(7,8,9),V3(10,11,12),1,1);
+    cimd::ParticleFactory::Scratch scratch(
+      std::vector< cimd::ParticleFactory >(),
+      part1, part2,
+      chimp::interaction::ReducedMass(1,2),
+      chimp::interaction::ReducedMass(1,4),
+      false, false
+    );
+    DB db;
+
+    { cimd::OpsContext ctx( part1, part2, db, scratch );
+      BOOST_CHECK_CLOSE(
+        cimd::CompiledOps( "-2^2 + 3*(1 - P(1,Z))/2 + sqrt(P(0,WEIGHT)*8)" )
+          .evaluate( ctx ),
+        -4.0 + 3.0*(1.0 - 9.0)/2.0 + 4.0, 1e-10 );
+      BOOST_CHECK_CLOSE(
+        cimd::CompiledOps( "pow(P(0,VX), 0.5) * 2e0" ).evaluate( ctx ),
+        4.0, 1e-10 );
+    }
+
+    { cimd::OpsContext ctx( part1, part2, db, scratch );
+      MyParticle r;
+      cimd::CompiledOps ops( "setWeight(.5*P(0,WEIGHT)); "
+                             "setPosition(P(1,X), P(1,Y), -P(1,Z))" );
+      BOOST_CHECK_EQUAL( ops.size(), 2u );
+      ops.evaluate( ctx );
+      ctx.apply( r );
+      BOOST_CHECK_EQUAL( r.weight, 1.0f );
+      BOOST_CHECK_EQUAL( r.x, V3(7,8,-9) );
+      BOOST_CHECK_EQUAL( r.v, V3(0,0,0) );
+    }
+
+    BOOST_CHECK( cimd::CompiledOps( "" ).empty() );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "P(2,X)" ), std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "P(0,1.5)" ), std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "CM(3)" ), std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "setWeight(1,2)" ),
+                       std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "P(0,X" ), std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "noSuchFunction(1)" ),
+                       std::runtime_error );
+
+    { cimd::OpsContext ctx( part1, part2, db, scratch );
+      BOOST_CHECK_CLOSE(
+        cimd::CompiledOps( "max(P(0,X), 3) + ln(exp(2)) + erf(0) + gamma(4)" )
+          .evaluate( ctx ),
+        3.0 + 2.0 + 0.0 + 6.0, 1e-10 );
+    }
+
+    /* units are checked once during compilation. */
+    BOOST_CHECK_NO_THROW(
+      cimd::CompiledOps( "setVelocity(3*m/s, sqrt(4*m^2/s^2), P(0,VZ)); "
+                         "setPosition(P(0,X) + 1e-9, 2*nm, min(m, 3*m))" ) );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "P(0,X) + 1*m" ),
+                       std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "exp(1*m)" ), std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "2^(1*m)" ), std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "m^P(0,X)" ), std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "setVelocity(1*m, 0, 0)" ),
+                       std::runtime_error );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "setWeight(2*s)" ),
+                       std::runtime_error );
+  }
+
+  BOOST_AUTO_TEST_CASE( CompiledOps_calculator_context ) {
+    using runtime::physical::calc::Driver;
+    MyParticle part1(V3(1,2,3),V3(4,5,6),2,0),
+               part2(V3(7,8,9),V3(10,11,12),1,1);
+    cimd::ParticleFactory::Scratch scratch(
+      std::vector< cimd::ParticleFactory >(),
+      part1, part2,
+      chimp::interaction::ReducedMass(1,2),
+      chimp::interaction::ReducedMass(1,4),
+      false, false
+    );
+    DB db;
+
+    chimp::CalcContext calc;
+    {
+      chimp::CalcContext::Scope scope( calc );
+      Driver::instance().exec( "chimp_ops_symbol = 2" );
+    }
+
+    /* symbols are resolved in the given context only. */
+    cimd::OpsContext ctx( part1, part2, db, scratch );
+    BOOST_CHECK_EQUAL(
+      cimd::CompiledOps( "3*chimp_ops_symbol", calc ).evaluate( ctx ), 6.0 );
+    BOOST_CHECK_THROW( cimd::CompiledOps( "chimp_ops_symbol" ),
+                       std::runtime_error );
+
+    /* the resolved expression no longer needs the calculator context. */
+    const cimd::CompiledOps ops(
+      "setVelocity(P(0,VX) * chimp_ops_symbol, 0, 0); 1 + chimp_ops_symbol",
+      calc );
+    BOOST_CHECK_EQUAL( ops.getResolved(),
+      "setVelocity(P(0,VX) * (2), 0, 0); 1 + (2)" );
+
+    const cimd::CompiledOps resolved( ops.getResolved() );
+    cimd::OpsContext ctx0( part1, part2, db, scratch ),
+                     ctx1( part1, part2, db, scratch );
+    BOOST_CHECK_EQUAL( ops.evaluate( ctx0 ), resolved.evaluate( ctx1 ) );
+    BOOST_CHECK_EQUAL( ctx0.velocity, ctx1.velocity );
+    BOOST_CHECK_EQUAL( ctx1.velocity[0], 8.0 );
   }
 
 BOOST_AUTO_TEST_SUITE_END(); // }
@@ -33,6 +33,7 @@
 #include <chimp/test_Particle.h>
 #include <chimp/interaction/ReducedMass.h>
 #include <chimp/interaction/model/Elastic.h>
+#include <chimp/interaction/model/VSSElastic.h>
 #include <chimp/interaction/model/test/diagnostics.h>
 
 #include <xylose/random/Kiss.hpp>
@@ -43,6 +44,7 @@
 
 #include <sstream>
 #include <limits>
+#include <vector>
 
 namespace {
   using boost::shared_ptr;
@@ -184,4 +186,151 @@ BOOST_AUTO_TEST_SUITE( Elastic_tests ); // {
     }
   }
 
+  BOOST_AUTO_TEST_CASE( vector_interface ) {
+    typedef chimp::RuntimeDB<> DB;
+    DB db;
+    db.addParticleType("87Rb");
+    int part_i = db.findParticleIndx("87Rb");
+
+    Term t0(part_i);
+    chimp::interaction::Equation<DB::options> eq;
+    eq.A = eq.B = t0;
+    eq.reducedMass = chimp::interaction::ReducedMass( eq, db );
+
+    /* the std::vector interface of model::Base must not be hidden by the
+     * overrides of the derived models. */
+    typedef chimp::interaction::model::Elastic<DB::options> Elastic;
+    typedef chimp::interaction::model::VSSElastic<DB::options> VSSElastic;
+    Elastic el( eq.reducedMass );
+    VSSElastic vss;
+    vss.mu = eq.reducedMass;
+
+    Particle p0, p1;
+    randomize(p0);
+    randomize(p1);
+    const Vector<double,3u> pTi = p0.v + p1.v;
+
+    /* the default options interact in place, such that no products are
+     * created. */
+    std::vector<Particle> products;
+    el.interact( p0, p1, products, global_rng );
+    vss.interact( p0, p1, products, global_rng );
+    BOOST_CHECK_EQUAL( products.size(), 0u );
+    BOOST_CHECK_LE( (p0.v + p1.v - pTi).abs(), 1e-10 * pTi.abs() );
+  }
+
+  BOOST_AUTO_TEST_CASE( batch ) {
+    typedef chimp::RuntimeDB<> DB;
+    DB db;
+    db.addParticleType("87Rb");
+    int part_i = db.findParticleIndx("87Rb");
+
+    Term t0(part_i);
+    chimp::interaction::Equation<DB::options> eq;
+    eq.A = eq.B = t0;
+    eq.reducedMass = chimp::interaction::ReducedMass( eq, db );
+
+    /* particles are paired as (2i+1, 2i) such that each appears once. */
+    const unsigned int N = 1003u;
+    std::vector<Particle> particles( 2u * N );
+    std::vector<double> vx( 2u * N ), vy( 2u * N ), vz( 2u * N );
+    std::vector<unsigned int> first( N ), second( N );
+    for ( unsigned int i = 0u; i < particles.size(); ++i ) {
+      randomize( particles[i] );
+      vx[i] = particles[i].v[0];
+      vy[i] = particles[i].v[1];
+      vz[i] = particles[i].v[2];
+    }
+    for ( unsigned int i = 0u; i < N; ++i ) {
+      first[i]  = 2u * i + 1u;
+      second[i] = 2u * i;
+    }
+
+    { BOOST_TEST_MESSAGE( "Elastic:  batch matches scalar" );
+      typedef chimp::interaction::model::Elastic<DB::options> Elastic;
+      Elastic el( eq.reducedMass );
+
+      std::vector<Particle> p = particles;
+      std::vector<double> x = vx, y = vy, z = vz;
+
+      xylose::random::Kiss rng, brng;
+      rng.seed(3u);
+      brng.seed(3u);
+
+      for ( unsigned int i = 0u; i < N; ++i )
+        el.interact( p[first[i]], p[second[i]], rng );
+      el.interactPairs( &x[0], &y[0], &z[0], &first[0], &second[0], N, brng );
+
+      for ( unsigned int i = 0u; i < p.size(); ++i ) {
+        BOOST_CHECK_LE( std::abs( x[i] - p[i].v[0] ), 1e-10 );
+        BOOST_CHECK_LE( std::abs( y[i] - p[i].v[1] ), 1e-10 );
+        BOOST_CHECK_LE( std::abs( z[i] - p[i].v[2] ), 1e-10 );
+      }
+    }
+
+    { BOOST_TEST_MESSAGE( "VSSElastic:  batch conserves and scatters" );
+      typedef chimp::interaction::model::VSSElastic<DB::options> VSSElastic;
+      VSSElastic vss;
+      vss.mu = eq.reducedMass;
+      vss.vss_param_inv = 1.0 / 1.4;
+
+      std::vector<double> x = vx, y = vy, z = vz;
+      xylose::random::Kiss brng;
+      brng.seed(5u);
+      vss.interactPairs( &x[0], &y[0], &z[0], &first[0], &second[0], N, brng );
+
+      /* <cos(chi)> = 2 / (1 + 1/alpha) - 1 for the VSS model. */
+      double cos_chi = 0.0;
+      for ( unsigned int i = 0u; i < N; ++i ) {
+        const unsigned int a = first[i], b = second[i];
+        const Vector<double,3> g0 = V3( vx[a] - vx[b],
+                                        vy[a] - vy[b],
+                                        vz[a] - vz[b] );
+        const Vector<double,3> g1 = V3( x[a] - x[b], y[a] - y[b], z[a] - z[b] );
+        const Vector<double,3> P0 = V3( vx[a] + vx[b],
+                                        vy[a] + vy[b],
+                                        vz[a] + vz[b] );
+        const Vector<double,3> P1 = V3( x[a] + x[b], y[a] + y[b], z[a] + z[b] );
+
+        BOOST_CHECK_CLOSE( g1.abs(), g0.abs(), 1e-8 );
+        BOOST_CHECK_LE( (P1 - P0).abs(), 1e-10 * g0.abs() );
+        cos_chi += ( g0 * g1 ) / xylose::SQR( g0.abs() );
+      }
+      cos_chi /= N;
+
+      BOOST_CHECK_LE(
+        std::abs( cos_chi - ( 2.0 / (1.0 + vss.vss_param_inv) - 1.0 ) ),
+        0.06 );
+    }
+
+    { BOOST_TEST_MESSAGE( "array of vectors matches arrays of components" );
+      typedef chimp::interaction::model::Elastic<DB::options> Elastic;
+      typedef chimp::interaction::model::VSSElastic<DB::options> VSSElastic;
+      Elastic el( eq.reducedMass );
+      VSSElastic vss;
+      vss.mu = eq.reducedMass;
+      vss.vss_param_inv = 1.0 / 1.4;
+
+      std::vector<double> x = vx, y = vy, z = vz;
+      std::vector< Vector<double,3> > v( vx.size() );
+      for ( unsigned int i = 0u; i < v.size(); ++i )
+        v[i] = V3( vx[i], vy[i], vz[i] );
+
+      xylose::random::Kiss rng, vrng;
+      rng.seed(7u);
+      vrng.seed(7u);
+
+      el.interactPairs( &x[0], &y[0], &z[0], &first[0], &second[0], N, rng );
+      el.interactPairs( &v[0], &first[0], &second[0], N, vrng );
+      vss.interactPairs( &x[0], &y[0], &z[0], &first[0], &second[0], N, rng );
+      vss.interactPairs( &v[0], &first[0], &second[0], N, vrng );
+
+      for ( unsigned int i = 0u; i < v.size(); ++i ) {
+        BOOST_CHECK_EQUAL( v[i][0], x[i] );
+        BOOST_CHECK_EQUAL( v[i][1], y[i] );
+        BOOST_CHECK_EQUAL( v[i][2], z[i] );
+      }
+    }
+  }
+
 BOOST_AUTO_TEST_SUITE_END(); // }
@@ -0,0 +1,175 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the  AdaptiveMaxSigmaVProduct class.
+ * */
+#define BOOST_TEST_MODULE  AdaptiveMaxSigmaVProduct
+
+
+#include <chimp/interaction/AdaptiveMaxSigmaVProduct.h>
+#include <chimp/interaction/v_rel_fnc.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+namespace {
+  /** Mock equation with the reduced mass of the inputs. */
+  struct MockEquation {
+    struct { double value; } reducedMass;
+  };
+
+  /** Mock equation set that counts the number of (sigma*v)_max searches. */
+  struct MockSet {
+    std::vector<MockEquation> rhs;
+    mutable unsigned int n_searches;
+    MockSet() : rhs(1u), n_searches(0u) { rhs[0].reducedMass.value = 1e-26; }
+
+    double findMaxSigmaVProduct( const double & v ) const {
+      ++n_searches;
+      return 2.0 * v;
+    }
+  };
+
+  /** Mock cell that stores the cache. */
+  struct Cell {
+    chimp::interaction::MaxSigmaVCache cache;
+
+    chimp::interaction::MaxSigmaVCache & maxSigmaVCache() { return cache; }
+    double maxRelativeVelocity( const unsigned int &,
+                                const unsigned int & ) const { return 10.; }
+  };
+
+  /** Mock cell that also tracks its temperature. */
+  struct ThermalCell : Cell {
+    double T;
+    ThermalCell( const double & T ) : T(T) { }
+  };
+
+  double temperature( const ThermalCell & cell ) { return cell.T; }
+
+  chimp::interaction::MaxSigmaVStats
+  makeStats( const double & m_s_v,
+             const double & max_s_v,
+             const unsigned int & n_tests,
+             const unsigned int & n_accepted ) {
+    chimp::interaction::MaxSigmaVStats stats( m_s_v );
+    stats.max_sigma_relspeed = max_s_v;
+    stats.number_tests = n_tests;
+    stats.number_accepted = n_accepted;
+    return stats;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( AdaptiveMaxSigmaVProduct_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( seeded_once ) {
+    MockSet set;
+    Cell cell;
+    chimp::interaction::AdaptiveMaxSigmaVProduct msv;
+
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 0, 1 ), 20.0 );
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 1, 0 ), 20.0 );
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 0, 1 ), 20.0 );
+    BOOST_CHECK_EQUAL( set.n_searches, 1u );
+
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 1, 1 ), 20.0 );
+    BOOST_CHECK_EQUAL( set.n_searches, 2u );
+  }
+
+  BOOST_AUTO_TEST_CASE( seeded_thermal ) {
+    MockSet set;
+    Cell cell;
+    chimp::interaction::AdaptiveMaxSigmaVProduct msv( 0.9, 0.05, 100u, 300.0 );
+
+    const double v = chimp::interaction::estMaxVFromT( 300.0, 1e-26 );
+    BOOST_CHECK_CLOSE( msv.get( set, cell, 0, 1 ), 2.0 * v, 1e-10 );
+    BOOST_CHECK_EQUAL( set.n_searches, 1u );
+
+    /* without any equations, the speed of the cell is used. */
+    MockSet empty;
+    empty.rhs.clear();
+    BOOST_CHECK_EQUAL( msv.get( empty, cell, 1, 1 ), 20.0 );
+  }
+
+  BOOST_AUTO_TEST_CASE( seeded_from_cell ) {
+    MockSet set;
+    chimp::interaction::AdaptiveMaxSigmaVProduct msv( 0.9, 0.05, 100u, 300.0 );
+
+    /* the temperature of the cell takes precedence over seed_temperature. */
+    ThermalCell cell( 50.0 );
+    const double v = chimp::interaction::estMaxVFromT( 50.0, 1e-26 );
+    BOOST_CHECK_CLOSE( msv.get( set, cell, 0, 1 ), 2.0 * v, 1e-10 );
+
+    /* thermal seeding also works with the default seed_temperature. */
+    chimp::interaction::AdaptiveMaxSigmaVProduct msv0;
+    ThermalCell cell0( 50.0 );
+    BOOST_CHECK_CLOSE( msv0.get( set, cell0, 0, 1 ), 2.0 * v, 1e-10 );
+
+    /* cells that do not know their temperature use seed_temperature. */
+    ThermalCell cold( 0.0 );
+    const double v300 = chimp::interaction::estMaxVFromT( 300.0, 1e-26 );
+    BOOST_CHECK_CLOSE( msv.get( set, cold, 0, 1 ), 2.0 * v300, 1e-10 );
+  }
+
+  BOOST_AUTO_TEST_CASE( raise ) {
+    MockSet set;
+    Cell cell;
+    chimp::interaction::AdaptiveMaxSigmaVProduct msv;
+
+    msv.get( set, cell, 0, 0 );
+    msv.update( set, cell, 0, 0, makeStats( 20.0, 25.0, 10u, 5u ) );
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 0, 0 ), 25.0 );
+
+    /* smaller values do not lower the cache. */
+    msv.update( set, cell, 0, 0, makeStats( 25.0, 15.0, 10u, 5u ) );
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 0, 0 ), 25.0 );
+    BOOST_CHECK_EQUAL( set.n_searches, 1u );
+  }
+
+  BOOST_AUTO_TEST_CASE( decay ) {
+    MockSet set;
+    Cell cell;
+    chimp::interaction::AdaptiveMaxSigmaVProduct msv( 0.5, 0.1, 100u );
+
+    msv.get( set, cell, 0, 0 );
+
+    /* not enough samples yet. */
+    msv.update( set, cell, 0, 0, makeStats( 20.0, 4.0, 60u, 1u ) );
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 0, 0 ), 20.0 );
+
+    /* enough samples with a low acceptance. */
+    msv.update( set, cell, 0, 0, makeStats( 20.0, 3.0, 60u, 1u ) );
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 0, 0 ), 10.0 );
+
+    /* never decay below the largest observed value. */
+    msv.update( set, cell, 0, 0, makeStats( 10.0, 8.0, 200u, 2u ) );
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 0, 0 ), 8.0 );
+
+    /* high acceptance does not decay. */
+    msv.update( set, cell, 0, 0, makeStats( 8.0, 7.0, 200u, 100u ) );
+    BOOST_CHECK_EQUAL( msv.get( set, cell, 0, 0 ), 8.0 );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
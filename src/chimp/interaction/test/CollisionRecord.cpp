@@ -0,0 +1,156 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Test file for the  CollisionRecord class.
+ * */
+#define BOOST_TEST_MODULE  CollisionRecord
+
+
+#include <chimp/RuntimeDB.h>
+#include <chimp/make_options.h>
+#include <chimp/interaction/Set.h>
+#include <chimp/interaction/CollisionRecord.h>
+#include <chimp/interaction/model/Elastic.h>
+#include <chimp/interaction/cross_section/Constant.h>
+
+#include <xylose/random/Kiss.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+
+namespace {
+  typedef chimp::make_options<>::type options;
+  typedef chimp::interaction::Set<options> Set;
+  typedef chimp::interaction::CollisionRecord<options> Record;
+  typedef chimp::interaction::cross_section::Constant<options> Constant;
+  typedef chimp::interaction::model::Elastic<options> Elastic;
+  typedef chimp::interaction::ReducedMass ReducedMass;
+
+  const double sigma0 = 2e-19;
+  const double sigma1 = 1e-19;
+
+  /** A set of two channels where the second one has a threshold. */
+  Set makeSet( const ReducedMass & mu, const double & threshold ) {
+    Set set;
+    Set::Equation eq;
+    eq.reducedMass = mu;
+    eq.interaction.reset( new Elastic( mu ) );
+
+    eq.cs.reset( new Constant( sigma0, mu ) );
+    set.rhs.push_back( eq );
+
+    eq.cs.reset( new Constant( sigma1, mu, threshold ) );
+    set.rhs.push_back( eq );
+
+    set.updateRecord();
+    return set;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( CollisionRecord_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( layout ) {
+    const ReducedMass mu( 1e-26, 3e-26 );
+    const Set set = makeSet( mu, 1e-20 );
+
+    BOOST_REQUIRE( set.hasRecord() );
+    BOOST_REQUIRE_EQUAL( set.record.size(), 2u );
+
+    const std::size_t addr =
+      reinterpret_cast<std::size_t>( set.record.begin() );
+    BOOST_CHECK_EQUAL( addr % Record::cache_line, 0u );
+    BOOST_CHECK_LE( sizeof(Record::Channel), Record::cache_line );
+
+    BOOST_CHECK_EQUAL( set.record[0].threshold_v, 0.0 );
+    BOOST_CHECK_EQUAL( set.record[1].species_A, set.rhs[1].A.species );
+    BOOST_CHECK_CLOSE( set.record[1].threshold_v,
+                       std::sqrt( 2e-20 / mu.value ), 1e-10 );
+
+    /* copies have their own storage. */
+    const Set copy = set;
+    BOOST_REQUIRE_EQUAL( copy.record.size(), 2u );
+    BOOST_CHECK( copy.record.begin() != set.record.begin() );
+    BOOST_CHECK_EQUAL( copy.record[1].threshold_v, set.record[1].threshold_v );
+  }
+
+  BOOST_AUTO_TEST_CASE( rebuild ) {
+    const ReducedMass mu( 1e-26, 3e-26 );
+    Set set = makeSet( mu, 1e-20 );
+    BOOST_REQUIRE( set.hasRecord() );
+
+    /* the record is authoritative and follows rhs once it is rebuilt. */
+    set.rhs[0].cs.reset( new Constant( 3.0 * sigma0, mu ) );
+    set.updateRecord();
+    BOOST_CHECK_EQUAL( set.crossSection( 0u, 1e3 ), 3.0 * sigma0 );
+
+    set.rhs.pop_back();
+    BOOST_CHECK( !set.hasRecord() );
+    set.updateRecord();
+    BOOST_CHECK( set.hasRecord() );
+  }
+
+  BOOST_AUTO_TEST_CASE( cross_sections ) {
+    const ReducedMass mu( 1e-26, 3e-26 );
+    const Set set = makeSet( mu, 1e-20 );
+    const double v_th = set.record[1].threshold_v;
+
+    for ( double v = 0.0; v < 1e5; v = 1.5 * v + 1.0 )
+      for ( unsigned int j = 0u; j < 2u; ++j )
+        BOOST_CHECK_EQUAL( set.crossSection( j, v ),
+                           set.rhs[j].cs->operator()( v ) );
+
+    BOOST_CHECK_EQUAL( set.crossSection( 1u, 0.99 * v_th ), 0.0 );
+    BOOST_CHECK_EQUAL( set.crossSection( 1u, 1.01 * v_th ), sigma1 );
+  }
+
+  BOOST_AUTO_TEST_CASE( calculateOutPath ) {
+    const ReducedMass mu( 1e-26, 3e-26 );
+    const Set set = makeSet( mu, 1e-20 );
+    const double v = 2.0 * set.record[1].threshold_v;
+    const double m_s_v = ( sigma0 + sigma1 ) * v;
+
+    xylose::random::Kiss rng;
+    unsigned int counts[2] = { 0u, 0u };
+    const unsigned int N = 100000u;
+    for ( unsigned int i = 0u; i < N; ++i ) {
+      double sigma_relspeed = 0.0;
+      std::pair<int,double> path =
+        set.calculateOutPath( m_s_v, v, rng, sigma_relspeed );
+      BOOST_REQUIRE( path.first >= 0 );
+      BOOST_CHECK_CLOSE( sigma_relspeed, m_s_v, 1e-10 );
+      ++counts[path.first];
+    }
+
+    BOOST_CHECK_CLOSE( double(counts[0]) / N,
+                       sigma0 / ( sigma0 + sigma1 ), 2.0 );
+
+    /* below the threshold, only the first channel is open. */
+    for ( unsigned int i = 0u; i < 1000u; ++i ) {
+      std::pair<int,double> path =
+        set.calculateOutPath( 0.0, 0.5 * v / 2.0, rng );
+      BOOST_CHECK_EQUAL( path.first, 0 );
+    }
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
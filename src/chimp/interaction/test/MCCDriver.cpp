@@ -0,0 +1,184 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the  MCCDriver class.
+ * */
+#define BOOST_TEST_MODULE  MCCDriver
+
+
+#include <chimp/RuntimeDB.h>
+#include <chimp/make_options.h>
+#include <chimp/interaction/MCCDriver.h>
+#include <chimp/interaction/filter/Elastic.h>
+
+#include <xylose/Vector.h>
+#include <xylose/IteratorRange.h>
+#include <xylose/random/Kiss.hpp>
+
+#include <physical/physical.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <set>
+#include <cmath>
+
+namespace {
+  using xylose::V3;
+  typedef chimp::make_options<>::type options;
+  typedef chimp::RuntimeDB<options> DB;
+  typedef options::Particle Particle;
+  typedef std::vector<Particle> PVector;
+
+  /** Cell with a single populated species and a uniform background. */
+  struct Cell {
+    typedef xylose::IteratorRange< PVector::iterator > SpeciesRange;
+
+    PVector particles;
+    std::vector< SpeciesRange > species;
+    double density;
+    double v_max;
+
+    Cell( const unsigned int & n_species,
+          const unsigned int & A,
+          const unsigned int & n,
+          const double & v,
+          const double & density )
+      : particles( n, Particle( V3(0.,0.,0.), V3(v,0.,0.), A ) ),
+        species( n_species,
+                 SpeciesRange( particles.end(), particles.end() ) ),
+        density( density ), v_max( 2.0 * v ) {
+      species[A] = SpeciesRange( particles.begin(), particles.end() );
+    }
+
+    std::size_t getNumberOfSpecies() const { return species.size(); }
+    SpeciesRange & getSpecies( const unsigned int & A ) { return species[A]; }
+    double maxRelativeVelocity( const unsigned int &,
+                                const unsigned int & ) const { return v_max; }
+    double backgroundDensity( const unsigned int & ) const { return density; }
+  };
+}
+
+BOOST_AUTO_TEST_SUITE( MCCDriver_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( collision_rate ) {
+    DB db;
+    db.addParticleType("e^-");
+    db.addParticleType("N2");
+    db.filter.reset( new chimp::interaction::filter::Elastic );
+    db.initBinaryInteractions();
+
+    const int e = db.findParticleIndx("e^-");
+    const int N2 = db.findParticleIndx("N2");
+    const DB::Set & set = db(e,N2);
+    BOOST_REQUIRE( set.rhs.size() > 0u );
+
+    /* 1 eV electrons in a cold background. */
+    using physical::constant::si::eV;
+    const double v = std::sqrt( 2.0 * eV / db[e].mass::value );
+    double sigma = 0.0;
+    for ( unsigned int j = 0; j < set.rhs.size(); ++j )
+      sigma += set.rhs[j].cs->operator()(v);
+
+    const double n = 1e20;
+    const double dt = 0.1 / ( n * sigma * v );
+    const unsigned int N = 20000u;
+
+    Cell cell( db.getProps().size(), e, N, v, n );
+
+    chimp::interaction::MCCDriver mcc;
+    mcc.addBackground( N2, 0.0 );
+
+    xylose::random::Kiss rng;
+    PVector products;
+    std::set<PVector::iterator> eq;
+    chimp::interaction::MCCStats stats =
+      mcc( dt, cell, db, products, eq, rng );
+
+    const double expected = N * ( 1.0 - std::exp( -0.1 ) );
+    BOOST_CHECK_CLOSE( double(stats.number_collisions), expected, 5.0 );
+    BOOST_CHECK_GE( stats.number_candidates, stats.number_collisions );
+
+    /* elastic collisions are in place and the background is not kept. */
+    BOOST_CHECK_EQUAL( products.size(), 0u );
+    BOOST_CHECK_EQUAL( eq.size(), 0u );
+    BOOST_CHECK_EQUAL( cell.getSpecies(e).size(), N );
+
+    /* collided electrons changed direction but not their speed (the
+     * background is infinitely cold and much heavier). */
+    unsigned int n_changed = 0u;
+    for ( unsigned int i = 0u; i < N; ++i )
+      if ( cell.particles[i].v[0] != v ) {
+        ++n_changed;
+        BOOST_CHECK_CLOSE( cell.particles[i].v.abs(), v, 1.0 );
+      }
+    BOOST_CHECK_EQUAL( n_changed, stats.number_collisions );
+  }
+
+  BOOST_AUTO_TEST_CASE( bound_exceeded ) {
+    DB db;
+    db.addParticleType("e^-");
+    db.addParticleType("N2");
+    db.filter.reset( new chimp::interaction::filter::Elastic );
+    db.initBinaryInteractions();
+
+    const int e = db.findParticleIndx("e^-");
+    const int N2 = db.findParticleIndx("N2");
+    const DB::Set & set = db(e,N2);
+    BOOST_REQUIRE( set.rhs.size() > 0u );
+
+    using physical::constant::si::eV;
+    const double v = std::sqrt( 2.0 * eV / db[e].mass::value );
+    double sigma = 0.0;
+    for ( unsigned int j = 0; j < set.rhs.size(); ++j )
+      sigma += set.rhs[j].cs->operator()(v);
+
+    const double n = 1e20;
+    const double dt = 0.1 / ( n * sigma * v );
+    const unsigned int N = 20000u;
+
+    /* (sigma*v)_max is only searched well below the relative speed of all
+     * candidates, such that the initial bound is too small. */
+    Cell cell( db.getProps().size(), e, N, v, n );
+    cell.v_max = 0.5 * v;
+    BOOST_REQUIRE_LT( set.findMaxSigmaVProduct( cell.v_max ), sigma * v );
+
+    chimp::interaction::MCCDriver mcc;
+    mcc.addBackground( N2, 0.0 );
+
+    xylose::random::Kiss rng;
+    PVector products;
+    std::set<PVector::iterator> eq;
+    chimp::interaction::MCCStats stats =
+      mcc( dt, cell, db, products, eq, rng );
+
+    /* the bound is raised once, after which the rate is not clipped. */
+    BOOST_CHECK_EQUAL( stats.number_bound_exceeded, 1u );
+    BOOST_CHECK_CLOSE( stats.max_sigma_relspeed, sigma * v, 1e-8 );
+
+    const double expected = N * ( 1.0 - std::exp( -0.1 ) );
+    BOOST_CHECK_CLOSE( double(stats.number_collisions), expected, 5.0 );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
@@ -0,0 +1,185 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Test file for the  ParallelDriver class.
+ * */
+#define BOOST_TEST_MODULE  ParallelDriver
+
+
+#include <chimp/RuntimeDB.h>
+#include <chimp/make_options.h>
+#include <chimp/interaction/Driver.h>
+#include <chimp/interaction/ParallelDriver.h>
+#include <chimp/random/Philox.h>
+
+#include <xylose/Vector.h>
+#include <xylose/IteratorRange.h>
+#include <xylose/random/Kiss.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <set>
+
+namespace {
+  using xylose::V3;
+  typedef chimp::make_options<>::type options;
+  typedef chimp::RuntimeDB<options> DB;
+  typedef options::Particle Particle;
+  typedef std::vector<Particle> PVector;
+
+  /** Minimal single-species cell. */
+  struct Cell {
+    typedef xylose::IteratorRange< PVector::iterator > SpeciesRange;
+
+    PVector particles;
+    std::vector< SpeciesRange > species;
+
+    Cell( const unsigned int & n, const unsigned int & seed ) {
+      xylose::random::Kiss rng;
+      rng.seed( seed );
+      for ( unsigned int i = 0; i < n; ++i )
+        particles.push_back(
+          Particle( V3( 0., 0., 0. ),
+                    V3( 100. * ( rng.rand() - .5 ),
+                        100. * ( rng.rand() - .5 ),
+                        100. * ( rng.rand() - .5 ) ),
+                    0 )
+        );
+      species.push_back( SpeciesRange( particles.begin(), particles.end() ) );
+    }
+
+    Cell( const Cell & that )
+      : particles( that.particles ) {
+      species.push_back( SpeciesRange( particles.begin(), particles.end() ) );
+    }
+
+    std::size_t getNumberOfSpecies() const { return species.size(); }
+    SpeciesRange & getSpecies( const unsigned int & A ) { return species[A]; }
+    double maxRelativeVelocity( const unsigned int &,
+                                const unsigned int & ) const { return 200.; }
+    double volume() const { return 1e-12; }
+  };
+
+  /** Monitor that counts the number of interactions. */
+  struct CountingMonitor {
+    unsigned int n;
+    CountingMonitor() : n(0u) { }
+
+    template < typename ChimpDB, typename PIter, typename BIS >
+    void interactions( const ChimpDB &,
+                       const std::pair<PIter, PIter> &,
+                       const std::pair<int,double> & path,
+                       const BIS & ) {
+      if ( path.first >= 0 )
+        ++n;
+    }
+
+    void pairtests( const double & ) const { }
+
+    void merge( const CountingMonitor & that ) { n += that.n; }
+  };
+
+  std::vector<Cell> makeCells() {
+    std::vector<Cell> cells;
+    /* skewed population of cells */
+    const unsigned int N[] = { 10, 2000, 30, 500, 0, 1, 100, 5 };
+    for ( unsigned int i = 0; i < sizeof(N)/sizeof(N[0]); ++i )
+      cells.push_back( Cell( N[i], i + 1u ) );
+    return cells;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( ParallelDriver_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( matches_serial_driver ) {
+    DB db;
+    db.addParticleType("87Rb");
+    db.initBinaryInteractions();
+
+    std::vector<Cell> cells_s = makeCells();
+    std::vector<Cell> cells_p = makeCells();
+
+    chimp::interaction::SeededRNGStreams< xylose::random::Kiss > rngs(42u);
+
+    /* serial reference, one cell at a time with the same streams. */
+    CountingMonitor mon_s;
+    std::vector<Particle> products_s;
+    std::set<PVector::iterator> eq_s;
+    for ( unsigned int i = 0; i < cells_s.size(); ++i ) {
+      xylose::random::Kiss rng = rngs(i);
+      chimp::interaction::Driver<CountingMonitor> driver( mon_s );
+      driver( 1e-3, cells_s[i], db, products_s, eq_s, rng );
+    }
+
+    CountingMonitor mon_p;
+    std::vector<Particle> products_p;
+    std::set<PVector::iterator> eq_p;
+    chimp::interaction::ParallelDriver<CountingMonitor> pdriver( mon_p );
+    pdriver( 1e-3, cells_p.begin(), cells_p.end(), db, products_p, eq_p, rngs );
+
+    BOOST_CHECK_EQUAL( mon_p.n, mon_s.n );
+    BOOST_CHECK_EQUAL( products_p.size(), products_s.size() );
+    BOOST_CHECK_EQUAL( eq_p.size(), eq_s.size() );
+
+    for ( unsigned int i = 0; i < cells_s.size(); ++i ) {
+      BOOST_REQUIRE_EQUAL( cells_p[i].particles.size(),
+                           cells_s[i].particles.size() );
+      for ( unsigned int j = 0; j < cells_s[i].particles.size(); ++j )
+        BOOST_CHECK_EQUAL( cells_p[i].particles[j].v,
+                           cells_s[i].particles[j].v );
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE( shared_counter_rng_advances ) {
+    typedef chimp::make_options<>::type::setRNG<
+      chimp::random::Philox >::type philox_options;
+    chimp::RuntimeDB<philox_options> db;
+    db.addParticleType("87Rb");
+    db.initBinaryInteractions();
+
+    /* a single Philox generator shared by consecutive (serial) Driver calls
+     * must not replay the same random numbers for each call. */
+    const Cell cell( 2000u, 7u );
+    Cell c0( cell ), c1( cell );
+
+    chimp::random::Philox rng(42u);
+    CountingMonitor mon;
+    std::vector<Particle> products;
+    std::set<PVector::iterator> eq;
+    chimp::interaction::Driver<CountingMonitor> driver( mon );
+
+    driver( 1e-3, c0, db, products, eq, rng );
+    const double r0 = rng.rand();
+    driver( 1e-3, c1, db, products, eq, rng );
+    const double r1 = rng.rand();
+    BOOST_CHECK_NE( r0, r1 );
+
+    BOOST_REQUIRE_GT( mon.n, 0u );
+    bool differ = false;
+    for ( unsigned int j = 0; j < cell.particles.size(); ++j )
+      differ = differ || ( c0.particles[j].v != c1.particles[j].v );
+    BOOST_CHECK( differ );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
@@ -0,0 +1,207 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the  PopulationControl class.
+ * */
+#define BOOST_TEST_MODULE  PopulationControl
+
+
+#include <chimp/interaction/PopulationControl.h>
+#include <chimp/test_Particle.h>
+
+#include <xylose/Vector.h>
+#include <xylose/IteratorRange.h>
+#include <xylose/random/Kiss.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <set>
+
+namespace {
+  using xylose::V3;
+  using chimp::test::Particle;
+  typedef xylose::Vector<double,3u> Vec;
+  typedef std::vector<Particle> PVector;
+
+  /** Single-species cell with random velocities and weights. */
+  struct Cell {
+    typedef xylose::IteratorRange< PVector::iterator > SpeciesRange;
+
+    PVector particles;
+    std::vector< SpeciesRange > species;
+
+    Cell( const unsigned int & n ) {
+      xylose::random::Kiss rng;
+      rng.seed( n );
+      for ( unsigned int i = 0; i < n; ++i )
+        particles.push_back(
+          Particle( V3( rng.rand(), rng.rand(), rng.rand() ),
+                    V3( 100. * ( rng.rand() - .5 ),
+                        100. * ( rng.rand() - .5 ),
+                        100. * ( rng.rand() - .5 ) ),
+                    0,
+                    1.0f + 3.0f * float( rng.rand() ) )
+        );
+      species.push_back( SpeciesRange( particles.begin(), particles.end() ) );
+    }
+
+    std::size_t getNumberOfSpecies() const { return species.size(); }
+    SpeciesRange & getSpecies( const unsigned int & A ) { return species[A]; }
+  };
+
+  /** Total weight, momentum, and kinetic energy (per unit mass). */
+  struct Totals {
+    double W, E;
+    Vec P;
+
+    Totals() : W(0.0), E(0.0), P(0.0) { }
+
+    template < typename Iter >
+    void add( Iter i, const Iter & end ) {
+      for ( ; i != end; ++i ) {
+        W += i->weight;
+        P += double(i->weight) * i->v;
+        E += 0.5 * i->weight * ( i->v * i->v );
+      }
+    }
+  };
+}
+
+BOOST_AUTO_TEST_SUITE( PopulationControl_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( merge ) {
+    Cell cell( 1000u );
+    Totals before;
+    before.add( cell.particles.begin(), cell.particles.end() );
+
+    chimp::interaction::PopulationControl control;
+    control.setTarget( 0u, 300u );
+
+    xylose::random::Kiss rng;
+    PVector products;
+    std::set<PVector::iterator> eq;
+    chimp::interaction::PopulationControlStats stats =
+      control( cell, products, eq, rng );
+
+    const Cell::SpeciesRange & range = cell.getSpecies(0);
+    BOOST_CHECK_LE( range.size(), 300u );
+    BOOST_CHECK_GE( range.size(), 290u );
+    BOOST_CHECK_EQUAL( stats.number_removed, 1000u - range.size() );
+    BOOST_CHECK_EQUAL( eq.size(), stats.number_removed );
+    BOOST_CHECK_EQUAL( products.size(), 0u );
+
+    Totals after;
+    after.add( range.begin(), range.end() );
+    BOOST_CHECK_CLOSE( after.W, before.W, 1e-4 );
+    BOOST_CHECK_CLOSE( after.E, before.E, 1e-4 );
+    for ( unsigned int d = 0u; d < 3u; ++d )
+      BOOST_CHECK_SMALL( after.P[d] - before.P[d], 1e-5 * before.E );
+  }
+
+  BOOST_AUTO_TEST_CASE( merge_small_target ) {
+    /* merging always leaves two particles, even for targets of 1 or 0. */
+    const unsigned int N[] = { 3u, 4u, 10u };
+    for ( unsigned int i = 0u; i < sizeof(N)/sizeof(N[0]); ++i ) {
+      for ( unsigned int n = 0u; n < 2u; ++n ) {
+        Cell cell( N[i] );
+        Totals before;
+        before.add( cell.particles.begin(), cell.particles.end() );
+
+        xylose::random::Kiss rng;
+        std::set<PVector::iterator> eq;
+        Cell::SpeciesRange & range = cell.getSpecies(0);
+        const unsigned int removed =
+          chimp::interaction::PopulationControl::merge( range, n, eq, rng );
+
+        BOOST_CHECK_EQUAL( range.size(), 2u );
+        BOOST_CHECK_EQUAL( removed, N[i] - 2u );
+        BOOST_CHECK_EQUAL( eq.size(), removed );
+
+        Totals after;
+        after.add( range.begin(), range.end() );
+        BOOST_CHECK_CLOSE( after.W, before.W, 1e-4 );
+        BOOST_CHECK_CLOSE( after.E, before.E, 1e-4 );
+      }
+    }
+
+    /* through the per-cell interface with a target of one particle. */
+    Cell cell( 50u );
+    chimp::interaction::PopulationControl control;
+    control.setTarget( 0u, 1u );
+
+    xylose::random::Kiss rng;
+    PVector products;
+    std::set<PVector::iterator> eq;
+    control( cell, products, eq, rng );
+    BOOST_CHECK_EQUAL( cell.getSpecies(0).size(), 2u );
+  }
+
+  BOOST_AUTO_TEST_CASE( split ) {
+    Cell cell( 50u );
+    Totals before;
+    before.add( cell.particles.begin(), cell.particles.end() );
+
+    chimp::interaction::PopulationControl control;
+    control.setTarget( 0u, 175u );
+
+    xylose::random::Kiss rng;
+    PVector products;
+    std::set<PVector::iterator> eq;
+    chimp::interaction::PopulationControlStats stats =
+      control( cell, products, eq, rng );
+
+    const Cell::SpeciesRange & range = cell.getSpecies(0);
+    BOOST_CHECK_EQUAL( range.size(), 50u );
+    BOOST_CHECK_EQUAL( products.size(), 125u );
+    BOOST_CHECK_EQUAL( stats.number_created, 125u );
+    BOOST_CHECK_EQUAL( eq.size(), 0u );
+
+    Totals after;
+    after.add( range.begin(), range.end() );
+    after.add( products.begin(), products.end() );
+    BOOST_CHECK_CLOSE( after.W, before.W, 1e-4 );
+    BOOST_CHECK_CLOSE( after.E, before.E, 1e-4 );
+    for ( unsigned int d = 0u; d < 3u; ++d )
+      BOOST_CHECK_SMALL( after.P[d] - before.P[d], 1e-5 * before.E );
+  }
+
+  BOOST_AUTO_TEST_CASE( tolerance ) {
+    Cell cell( 105u );
+
+    chimp::interaction::PopulationControl control( 0.1 );
+    control.setTarget( 0u, 100u );
+
+    xylose::random::Kiss rng;
+    PVector products;
+    std::set<PVector::iterator> eq;
+    control( cell, products, eq, rng );
+
+    /* within the tolerance:  nothing is done. */
+    BOOST_CHECK_EQUAL( cell.getSpecies(0).size(), 105u );
+    BOOST_CHECK_EQUAL( eq.size(), 0u );
+    BOOST_CHECK_EQUAL( products.size(), 0u );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
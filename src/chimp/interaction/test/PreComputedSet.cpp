@@ -0,0 +1,179 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Test file for the  PreComputedSet class.
+ * */
+#define BOOST_TEST_MODULE  PreComputedSet
+
+
+#include <chimp/RuntimeDB.h>
+#include <chimp/make_options.h>
+#include <chimp/interaction/PreComputedSet.h>
+#include <chimp/interaction/filter/Or.h>
+#include <chimp/interaction/filter/Label.h>
+#include <chimp/interaction/filter/Elastic.h>
+
+#include <xylose/random/Kiss.hpp>
+
+#include <physical/physical.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cmath>
+
+namespace {
+  typedef chimp::make_options<>::type::setPreComputedSets<true>::type options;
+  typedef chimp::RuntimeDB<options> DB;
+
+  void init( DB & db ) {
+    namespace filter = chimp::interaction::filter;
+    typedef boost::shared_ptr<filter::Base> SP;
+
+    db.addParticleType("e^-");
+    db.addParticleType("N2");
+    db.addParticleType("N2(rot)");
+    db.addParticleType("N2(v1res)");
+
+    db.filter =
+      SP(
+        new filter::Or( SP(new filter::Elastic),
+                        SP(new filter::Label("inelastic")) )
+      );
+
+    db.default_PreComputedSet_n = 4000u;
+    db.initBinaryInteractions();
+  }
+
+  /** Relative speed of an electron with the given energy (in eV). */
+  double v_of_eV( const DB::Set & set, const double & E ) {
+    using physical::constant::si::eV;
+    return std::sqrt( 2.0 * E * eV / set.rhs.front().reducedMass.value );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( PreComputedSet_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( table ) {
+    DB db;
+    init(db);
+
+    const DB::Set & set = db("e^-", "N2");
+    BOOST_REQUIRE_EQUAL( set.rhs.size(), 3u );
+    BOOST_REQUIRE( set.isPrecomputed() );
+
+    /* check the table at grid points and between grid points. */
+    const double E[] = { 0.01, 0.1, 1.0, 2.05, 3.0, 10.0, 50.0 };
+    for ( unsigned int e = 0; e < sizeof(E)/sizeof(E[0]); ++e ) {
+      const double v = v_of_eV( set, E[e] );
+
+      double tot = 0.0;
+      for ( unsigned int j = 0; j < set.rhs.size(); ++j )
+        tot += set.rhs[j].cs->operator()(v);
+
+      BOOST_CHECK_CLOSE( set.crossSectionTotal(v), tot, 2.0 );
+      BOOST_CHECK_GE( set.findMaxSigmaVProduct(v), 0.99 * tot * v );
+    }
+
+    /* beyond the table, the exact sum is used. */
+    const double v = 2.0 * set.v_max;
+    double tot = 0.0;
+    for ( unsigned int j = 0; j < set.rhs.size(); ++j )
+      tot += set.rhs[j].cs->operator()(v);
+    BOOST_CHECK_CLOSE( set.crossSectionTotal(v), tot, 1e-10 );
+  }
+
+  BOOST_AUTO_TEST_CASE( calculateOutPath ) {
+    DB db;
+    init(db);
+
+    const DB::Set & set = db("e^-", "N2");
+    BOOST_REQUIRE_EQUAL( set.rhs.size(), 3u );
+
+    /* in the middle of the N2(rot)/N2(v1res) resonances. */
+    const double v = v_of_eV( set, 2.2 );
+
+    std::vector<double> cs( set.rhs.size() );
+    double tot = 0.0;
+    for ( unsigned int j = 0; j < set.rhs.size(); ++j )
+      tot += ( cs[j] = set.rhs[j].cs->operator()(v) );
+
+    xylose::random::Kiss rng;
+    std::vector<unsigned int> counts( set.rhs.size(), 0u );
+    const unsigned int N = 200000u;
+    unsigned int n_accepted = 0u;
+    for ( unsigned int i = 0; i < N; ++i ) {
+      std::pair<int,double> path = set.calculateOutPath( tot * v, v, rng );
+      if ( path.first < 0 )
+        continue;
+      ++n_accepted;
+      ++counts[path.first];
+      BOOST_CHECK_CLOSE( path.second, cs[path.first], 1e-10 );
+    }
+
+    BOOST_CHECK_CLOSE( double(n_accepted), double(N), 3.0 );
+    for ( unsigned int j = 0; j < set.rhs.size(); ++j ) {
+      if ( cs[j] / tot < 0.01 )
+        continue;
+      BOOST_CHECK_CLOSE( double(counts[j]) / n_accepted, cs[j] / tot, 5.0 );
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE( threshold ) {
+    DB db;
+    init(db);
+
+    const DB::Set & set = db("e^-", "N2");
+    BOOST_REQUIRE_EQUAL( set.rhs.size(), 3u );
+
+    /* find the inelastic path with the highest threshold. */
+    unsigned int jt = 0u;
+    for ( unsigned int j = 1; j < set.rhs.size(); ++j )
+      if ( set.rhs[j].cs->getThresholdEnergy() >
+           set.rhs[jt].cs->getThresholdEnergy() )
+        jt = j;
+    const double E_th = set.rhs[jt].cs->getThresholdEnergy();
+    BOOST_REQUIRE_GT( E_th, 0.0 );
+    const double v_th =
+      std::sqrt( 2.0 * E_th / set.rhs[jt].reducedMass.value );
+
+    /* just above and below the threshold, the exact calculation is used. */
+    const double V[] = { v_th * ( 1.0 - 1e-9 ), v_th * ( 1.0 + 1e-9 ) };
+    for ( unsigned int e = 0; e < sizeof(V)/sizeof(V[0]); ++e ) {
+      const double v = V[e];
+      BOOST_REQUIRE_LT( v, set.v_max );
+
+      double tot = 0.0;
+      for ( unsigned int j = 0; j < set.rhs.size(); ++j )
+        tot += set.rhs[j].cs->operator()(v);
+      BOOST_CHECK_CLOSE( set.crossSectionTotal(v), tot, 1e-10 );
+
+      xylose::random::Kiss rng;
+      double s_v = 0.0;
+      std::pair<int,double> path = set.calculateOutPath( tot * v, v, rng, s_v );
+      BOOST_CHECK_CLOSE( s_v, tot * v, 1e-10 );
+      BOOST_CHECK_GE( path.first, 0 );
+    }
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
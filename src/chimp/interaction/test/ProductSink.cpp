@@ -0,0 +1,122 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the  ProductSink classes.
+ * */
+#define BOOST_TEST_MODULE  ProductSink
+
+
+#include <chimp/RuntimeDB.h>
+#include <chimp/interaction/ProductSink.h>
+#include <chimp/interaction/ReducedMass.h>
+#include <chimp/interaction/model/Elastic.h>
+#include <chimp/make_options.h>
+#include <chimp/test_Particle.h>
+
+#include <xylose/Vector.h>
+#include <xylose/random/Kiss.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <deque>
+
+namespace {
+  using xylose::V3;
+  using chimp::test::Particle;
+  using chimp::interaction::ProductSink;
+  using chimp::interaction::SequenceSink;
+  using chimp::interaction::ArenaSink;
+
+  /** Fill the sink with n particles of increasing species. */
+  void fill( ProductSink<Particle> & sink, const unsigned int & n ) {
+    sink.reserve( n );
+    for ( unsigned int i = 0u; i < n; ++i )
+      sink.append( Particle( V3(0.,0.,0.), V3(i,0.,0.), i ) );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( ProductSink_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( sequence ) {
+    std::vector<Particle> v( 1u );
+    SequenceSink< std::vector<Particle> > vsink( v );
+    fill( vsink, 5u );
+    BOOST_CHECK_EQUAL( v.size(), 6u );
+    BOOST_CHECK_EQUAL( vsink.size(), 6u );
+    BOOST_CHECK_EQUAL( vsink[3].species, 2 );
+
+    std::deque<Particle> d;
+    SequenceSink< std::deque<Particle> > dsink( d );
+    fill( dsink, 5u );
+    BOOST_CHECK_EQUAL( d.size(), 5u );
+    BOOST_CHECK_EQUAL( dsink[4].species, 4 );
+  }
+
+  BOOST_AUTO_TEST_CASE( arena ) {
+    ArenaSink<Particle> arena( 2u );
+    fill( arena, 7u );
+    BOOST_REQUIRE_EQUAL( arena.size(), 7u );
+    for ( unsigned int i = 0u; i < arena.size(); ++i )
+      BOOST_CHECK_EQUAL( arena.begin()[i].species, int(i) );
+
+    /* the storage is reused after clear. */
+    const std::size_t capacity = arena.capacity();
+    const Particle * storage = arena.begin();
+    arena.clear();
+    BOOST_CHECK_EQUAL( arena.size(), 0u );
+    fill( arena, 7u );
+    BOOST_CHECK_EQUAL( arena.capacity(), capacity );
+    BOOST_CHECK_EQUAL( arena.begin(), storage );
+    BOOST_CHECK_EQUAL( arena.end() - arena.begin(), 7 );
+  }
+
+  BOOST_AUTO_TEST_CASE( model_products ) {
+    /* out-of-place interactions:  products are appended to the sink. */
+    typedef chimp::make_options<>::type::setInplaceInteractions<false>::type
+      options;
+    typedef chimp::interaction::model::Elastic<options> Elastic;
+    const Elastic elastic( chimp::interaction::ReducedMass( 1.0, 2.0 ) );
+    const chimp::interaction::model::Base<options> & model = elastic;
+
+    const Particle p0( V3(0.,0.,0.), V3( 1.,2.,3.), 0 ),
+                   p1( V3(0.,0.,0.), V3(-1.,0.,1.), 0 );
+
+    xylose::random::Kiss rng0, rng1;
+    rng0.seed( 7u );
+    rng1.seed( 7u );
+
+    std::vector<Particle> products;
+    model.interact( p0, p1, products, rng0 );
+
+    ArenaSink<Particle> arena;
+    model.interact( p0, p1, arena, rng1 );
+
+    BOOST_REQUIRE_EQUAL( products.size(), 2u );
+    BOOST_REQUIRE_EQUAL( arena.size(), 2u );
+    for ( unsigned int i = 0u; i < 2u; ++i )
+      BOOST_CHECK_EQUAL( arena[i].v, products[i].v );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
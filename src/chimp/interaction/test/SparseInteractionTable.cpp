@@ -0,0 +1,231 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Test file for the  SparseInteractionTable class.
+ * */
+#define BOOST_TEST_MODULE  SparseInteractionTable
+
+
+#include <chimp/interaction/SparseInteractionTable.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <algorithm>
+
+namespace {
+  /** Mock interaction set. */
+  struct MockSet {
+    std::vector<int> rhs;
+  };
+
+  typedef chimp::interaction::SparseInteractionTable<MockSet> Table;
+
+  /** Loader that records the number of loads of each set.  The set of
+   * species (i,j) with i != j also loads (i,i). */
+  struct CountingLoader : Table::Loader {
+    const Table * table;
+    mutable std::vector<int> loads;
+
+    CountingLoader( const Table & table )
+      : table( &table ), loads( 16, 0 ) { }
+
+    void load( MockSet & set,
+               const unsigned int & i,
+               const unsigned int & j ) const {
+      #pragma omp atomic
+      ++loads[ 4*i + j ];
+
+      if ( i != j )
+        set.rhs.push_back( (*table)(i,i).rhs.back() );
+      /* the set that is being loaded is returned as it is. */
+      set.rhs.push_back( int( (*table)(i,j).rhs.size() ) );
+      set.rhs.push_back( 10 * i + j );
+    }
+  };
+}
+
+BOOST_AUTO_TEST_SUITE( SparseInteractionTable_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( create_on_demand ) {
+    Table table( 4u );
+    BOOST_CHECK_EQUAL( table.side_length(), 4u );
+    BOOST_CHECK_EQUAL( table.size(), 0u );
+
+    /* const access does not create sets. */
+    const Table & ctable = table;
+    BOOST_CHECK_EQUAL( ctable(1,2).rhs.size(), 0u );
+    BOOST_CHECK( !table.contains(1,2) );
+    BOOST_CHECK_EQUAL( table.size(), 0u );
+
+    table(2,1).rhs.push_back( 5 );
+    table(3,1).rhs.push_back( 7 );
+    table(1,1).rhs.push_back( 9 );
+    BOOST_CHECK_EQUAL( table.size(), 3u );
+    BOOST_CHECK( table.contains(1,2) );
+
+    /* symmetric access. */
+    BOOST_CHECK_EQUAL( &ctable(1,2), &ctable(2,1) );
+    BOOST_CHECK_EQUAL( ctable(1,2).rhs.front(), 5 );
+
+    /* partners are ordered by species. */
+    const Table::PartnerList & p1 = table.partners(1);
+    BOOST_REQUIRE_EQUAL( p1.size(), 3u );
+    BOOST_CHECK_EQUAL( p1[0].species, 1u );
+    BOOST_CHECK_EQUAL( p1[1].species, 2u );
+    BOOST_CHECK_EQUAL( p1[2].species, 3u );
+    BOOST_CHECK_EQUAL( ctable[ p1[2].index ].rhs.front(), 7 );
+
+    BOOST_REQUIRE_EQUAL( table.partners(3).size(), 1u );
+    BOOST_CHECK_EQUAL( table.partners(3).front().species, 1u );
+    BOOST_CHECK_EQUAL( table.partners(0).size(), 0u );
+  }
+
+  BOOST_AUTO_TEST_CASE( compact ) {
+    Table table( 3u );
+    table(0,2).rhs.push_back( 1 );
+    table(0,1);
+    table(2,2).rhs.push_back( 2 );
+    BOOST_CHECK_EQUAL( table.size(), 3u );
+
+    table.compact();
+    BOOST_CHECK_EQUAL( table.size(), 2u );
+    BOOST_CHECK( !table.contains(0,1) );
+    BOOST_CHECK_EQUAL( table.partners(1).size(), 0u );
+
+    const Table & ctable = table;
+    BOOST_CHECK_EQUAL( ctable(2,0).rhs.front(), 1 );
+    BOOST_CHECK_EQUAL( ctable(2,2).rhs.front(), 2 );
+
+    const Table::PartnerList & p2 = table.partners(2);
+    BOOST_REQUIRE_EQUAL( p2.size(), 2u );
+    BOOST_CHECK_EQUAL( p2[0].species, 0u );
+    BOOST_CHECK_EQUAL( ctable[ p2[0].index ].rhs.front(), 1 );
+    BOOST_CHECK_EQUAL( p2[1].species, 2u );
+    BOOST_CHECK_EQUAL( ctable[ p2[1].index ].rhs.front(), 2 );
+
+    /* resizing removes all sets. */
+    table.resize( 5u );
+    BOOST_CHECK_EQUAL( table.size(), 0u );
+    BOOST_CHECK_EQUAL( table.partners(4).size(), 0u );
+  }
+
+  BOOST_AUTO_TEST_CASE( extend ) {
+    Table table( 2u );
+    table(0,1).rhs.push_back( 1 );
+    MockSet & s01 = table(0,1);
+
+    table.extend( 4u );
+    BOOST_CHECK_EQUAL( table.side_length(), 4u );
+    BOOST_CHECK_EQUAL( table.size(), 1u );
+    BOOST_CHECK_EQUAL( &table(1,0), &s01 );
+    BOOST_CHECK( !table.contains(1,3) );
+
+    table(3,1).rhs.push_back( 2 );
+    const Table & ctable = table;
+    BOOST_CHECK_EQUAL( ctable(1,3).rhs.front(), 2 );
+    BOOST_REQUIRE_EQUAL( table.partners(1).size(), 2u );
+    BOOST_CHECK_EQUAL( table.partners(1)[0].species, 0u );
+    BOOST_CHECK_EQUAL( table.partners(1)[1].species, 3u );
+
+    /* shrinking is not possible. */
+    table.extend( 2u );
+    BOOST_CHECK_EQUAL( table.side_length(), 4u );
+  }
+
+  BOOST_AUTO_TEST_CASE( pending_sets ) {
+    Table table( 4u );
+    CountingLoader loader( table );
+    const Table & ctable = table;
+
+    table(0,0).rhs.push_back( 1 );
+    table.setPending(1,1);
+    table.setPending(3,1);
+    table.setPending(2,2);
+    BOOST_CHECK( !table.isPending(0,0) );
+    BOOST_CHECK( table.isPending(1,3) );
+    BOOST_CHECK_EQUAL( table.size(), 4u );
+
+    /* nothing is loaded without a loader. */
+    BOOST_CHECK_EQUAL( ctable(1,3).rhs.size(), 0u );
+    BOOST_CHECK( table.isPending(1,3) );
+
+    table.setLoader( &loader );
+
+    /* compact keeps pending sets. */
+    table.compact();
+    BOOST_CHECK_EQUAL( table.size(), 4u );
+
+    /* loading (1,3) loads (1,1) from within the loader. */
+    const MockSet & s13 = ctable(3,1);
+    BOOST_REQUIRE_EQUAL( s13.rhs.size(), 3u );
+    BOOST_CHECK_EQUAL( s13.rhs[0], 11 );
+    BOOST_CHECK_EQUAL( s13.rhs[1], 1 );
+    BOOST_CHECK_EQUAL( s13.rhs[2], 13 );
+    BOOST_CHECK( !table.isPending(1,1) );
+    BOOST_CHECK( !table.isPending(1,3) );
+    BOOST_CHECK( table.isPending(2,2) );
+    BOOST_CHECK_EQUAL( loader.loads[4*1 + 1], 1 );
+    BOOST_CHECK_EQUAL( loader.loads[4*1 + 3], 1 );
+
+    /* loaded sets are not loaded again. */
+    BOOST_CHECK_EQUAL( &ctable(1,3), &s13 );
+    BOOST_CHECK_EQUAL( table(1,3).rhs.size(), 3u );
+    BOOST_CHECK_EQUAL( loader.loads[4*1 + 3], 1 );
+
+    /* access through the partner lists loads as well. */
+    const Table::PartnerList & p2 = table.partners(2);
+    BOOST_REQUIRE_EQUAL( p2.size(), 1u );
+    BOOST_CHECK_EQUAL( ctable[ p2[0].index ].rhs.back(), 22 );
+    BOOST_CHECK_EQUAL( loader.loads[4*2 + 2], 1 );
+    BOOST_CHECK_EQUAL( loader.loads[0], 0 );
+  }
+
+  BOOST_AUTO_TEST_CASE( concurrent_loads ) {
+    Table table( 4u );
+    CountingLoader loader( table );
+    for ( unsigned int j = 0u; j < 4u; ++j )
+      for ( unsigned int i = 0u; i <= j; ++i )
+        table.setPending(i,j);
+    table.setLoader( &loader );
+
+    const Table & ctable = table;
+    int wrong = 0;
+
+    #pragma omp parallel for schedule(dynamic,1) reduction(+:wrong)
+    for ( int k = 0; k < 1000; ++k ) {
+      const unsigned int i = k % 4, j = (k / 4) % 4;
+      if ( ctable(i,j).rhs.back() != int( 10 * std::min(i,j) +
+                                          std::max(i,j) ) )
+        ++wrong;
+    }
+
+    BOOST_CHECK_EQUAL( wrong, 0 );
+    for ( unsigned int j = 0u; j < 4u; ++j )
+      for ( unsigned int i = 0u; i <= j; ++i ) {
+        BOOST_CHECK_EQUAL( loader.loads[4*i + j], 1 );
+        BOOST_CHECK( !table.isPending(i,j) );
+      }
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
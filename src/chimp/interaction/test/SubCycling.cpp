@@ -0,0 +1,282 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Test file for the  SubCycling classes.
+ * */
+#define BOOST_TEST_MODULE  SubCycling
+
+
+#include <chimp/RuntimeDB.h>
+#include <chimp/make_options.h>
+#include <chimp/interaction/Driver.h>
+#include <chimp/interaction/SubCycling.h>
+
+#include <xylose/Vector.h>
+#include <xylose/IteratorRange.h>
+#include <xylose/random/Kiss.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <set>
+
+namespace {
+  using xylose::V3;
+  typedef chimp::make_options<>::type options;
+  typedef chimp::RuntimeDB<options> DB;
+  typedef options::Particle Particle;
+  typedef std::vector<Particle> PVector;
+
+  /** Mock equation set and cell for testing the policies alone. */
+  struct MockSet { };
+  struct MockCell { };
+
+  /** Minimal cell with n particles of each species. */
+  struct Cell {
+    typedef xylose::IteratorRange< PVector::iterator > SpeciesRange;
+
+    PVector particles;
+    std::vector< SpeciesRange > species;
+
+    Cell( const unsigned int & n,
+          const unsigned int & seed,
+          const unsigned int & n_species = 1u ) {
+      xylose::random::Kiss rng;
+      rng.seed( seed );
+      for ( unsigned int s = 0; s < n_species; ++s )
+        for ( unsigned int i = 0; i < n; ++i )
+          particles.push_back(
+            Particle( V3( 0., 0., 0. ),
+                      V3( 100. * ( rng.rand() - .5 ),
+                          100. * ( rng.rand() - .5 ),
+                          100. * ( rng.rand() - .5 ) ),
+                      s )
+          );
+      for ( unsigned int s = 0; s < n_species; ++s )
+        species.push_back( SpeciesRange( particles.begin() + s * n,
+                                         particles.begin() + (s + 1u) * n ) );
+    }
+
+    std::size_t getNumberOfSpecies() const { return species.size(); }
+    SpeciesRange & getSpecies( const unsigned int & A ) { return species[A]; }
+    double maxRelativeVelocity( const unsigned int &,
+                                const unsigned int & ) const { return 200.; }
+    double volume() const { return 1e-12; }
+  };
+
+  /** Monitor that sums the number of pair tests. */
+  struct TestCountingMonitor {
+    double n;
+    unsigned int n_calls;
+    TestCountingMonitor() : n(0.0), n_calls(0u) { }
+
+    template < typename ChimpDB, typename PIter, typename BIS >
+    void interactions( const ChimpDB &,
+                       const std::pair<PIter, PIter> &,
+                       const std::pair<int,double> &,
+                       const BIS & ) const { }
+
+    void pairtests( const double & number_of_pairtests ) {
+      n += std::floor( number_of_pairtests );
+      ++n_calls;
+    }
+
+    void merge( const TestCountingMonitor & that ) {
+      n += that.n;
+      n_calls += that.n_calls;
+    }
+  };
+
+  /** Monitor that records the species of each tested pair. */
+  struct PairOrderMonitor {
+    std::vector<int> order;
+
+    template < typename ChimpDB, typename PIter, typename BIS >
+    void interactions( const ChimpDB &,
+                       const std::pair<PIter, PIter> & pair,
+                       const std::pair<int,double> &,
+                       const BIS & ) {
+      order.push_back( chimp::accessors::particle::species( *pair.first ) );
+    }
+
+    void pairtests( const double & ) const { }
+
+    void merge( const PairOrderMonitor & that ) {
+      order.insert( order.end(), that.order.begin(), that.order.end() );
+    }
+  };
+
+  void init( DB & db ) {
+    db.addParticleType("87Rb");
+    db.initBinaryInteractions();
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( SubCycling_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( fixed ) {
+    MockSet set;
+    MockCell cell;
+    chimp::interaction::FixedSubCycling sub;
+
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 1, 10.0, 10u, 10u ), 1u );
+
+    sub.setSpecies( 0u, 4u );
+    sub.setSpecies( 2u, 8u );
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 0, 10.0, 10u, 10u ), 4u );
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 1, 10.0, 10u, 10u ), 4u );
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 2, 0, 10.0, 10u, 10u ), 8u );
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 1, 1, 10.0, 10u, 10u ), 1u );
+
+    /* pair values override the species values. */
+    sub.setPair( 2u, 0u, 3u );
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 2, 10.0, 10u, 10u ), 3u );
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 2, 2, 10.0, 10u, 10u ), 8u );
+  }
+
+  BOOST_AUTO_TEST_CASE( automatic ) {
+    MockSet set;
+    MockCell cell;
+    chimp::interaction::AutoSubCycling sub( 0.5, 100u );
+
+    /* 1 test per particle of the smaller population. */
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 1, 10.0, 10u, 1000u ), 2u );
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 1, 4.0, 10u, 1000u ), 1u );
+
+    /* each test of identical species involves two particles. */
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 0, 10.0, 10u, 10u ), 4u );
+
+    /* limited by max_sub_cycles. */
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 1, 1e9, 10u, 10u ), 100u );
+
+    /* empty populations are not sub-cycled. */
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 1, 10.0, 0u, 10u ), 1u );
+
+    /* user values are lower bounds. */
+    sub.setSpecies( 1u, 7u );
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 1, 10.0, 10u, 1000u ), 7u );
+    BOOST_CHECK_EQUAL( sub.get( set, cell, 0, 1, 50.0, 10u, 1000u ), 10u );
+  }
+
+  BOOST_AUTO_TEST_CASE( single_cycle_unchanged ) {
+    DB db;
+    init(db);
+
+    Cell cell_0( 1000u, 1u ), cell_1( 1000u, 1u );
+
+    xylose::random::Kiss rng_0, rng_1;
+    rng_0.seed( 42u );
+    rng_1.seed( 42u );
+
+    std::vector<Particle> products;
+    std::set<PVector::iterator> eq_0, eq_1;
+
+    chimp::interaction::Driver<> driver_0;
+    driver_0( 1e-3, cell_0, db, products, eq_0, rng_0 );
+
+    /* FixedSubCycling without values is the same as NoSubCycling. */
+    typedef chimp::interaction::Driver<
+      chimp::interaction::NullMonitor,
+      chimp::interaction::DefaultMaxSigmaVProduct,
+      chimp::interaction::UniformWeightNTC,
+      chimp::interaction::FixedSubCycling
+    > FixedDriver;
+    FixedDriver driver_1;
+    driver_1( 1e-3, cell_1, db, products, eq_1, rng_1 );
+
+    BOOST_CHECK_EQUAL( eq_0.size(), eq_1.size() );
+    for ( unsigned int i = 0; i < cell_0.particles.size(); ++i )
+      BOOST_CHECK_EQUAL( cell_0.particles[i].v, cell_1.particles[i].v );
+  }
+
+  BOOST_AUTO_TEST_CASE( number_of_tests ) {
+    DB db;
+    init(db);
+
+    typedef chimp::interaction::Driver<
+      TestCountingMonitor,
+      chimp::interaction::DefaultMaxSigmaVProduct,
+      chimp::interaction::UniformWeightNTC,
+      chimp::interaction::FixedSubCycling
+    > FixedDriver;
+
+    xylose::random::Kiss rng;
+    std::vector<Particle> products;
+    std::set<PVector::iterator> eq;
+
+    Cell cell_0( 2000u, 1u );
+    TestCountingMonitor mon_0;
+    FixedDriver driver_0( mon_0 );
+    driver_0( 1e-3, cell_0, db, products, eq, rng );
+    BOOST_CHECK_EQUAL( mon_0.n_calls, 1u );
+
+    /* the sub-cycles share the tests of the time step. */
+    Cell cell_1( 2000u, 1u );
+    TestCountingMonitor mon_1;
+    FixedDriver driver_1( mon_1 );
+    driver_1.subCycling.setSpecies( 0u, 10u );
+    driver_1( 1e-3, cell_1, db, products, eq, rng );
+    BOOST_CHECK_EQUAL( mon_1.n_calls, 10u );
+
+    BOOST_REQUIRE_GT( mon_0.n, 100.0 );
+    BOOST_CHECK_CLOSE( mon_1.n, mon_0.n, 5.0 );
+  }
+
+  BOOST_AUTO_TEST_CASE( interleaved ) {
+    DB db;
+    db.addParticleType("87Rb");
+    db.addParticleType("85Rb");
+    db.initBinaryInteractions();
+
+    typedef chimp::interaction::Driver<
+      PairOrderMonitor,
+      chimp::interaction::DefaultMaxSigmaVProduct,
+      chimp::interaction::UniformWeightNTC,
+      chimp::interaction::FixedSubCycling
+    > FixedDriver;
+
+    xylose::random::Kiss rng;
+    rng.seed( 7u );
+    std::vector<Particle> products;
+    std::set<PVector::iterator> eq;
+
+    Cell cell( 2000u, 1u, 2u );
+    PairOrderMonitor mon;
+    FixedDriver driver( mon );
+    driver.subCycling.setSpecies( 0u, 10u );
+    driver.subCycling.setSpecies( 1u, 10u );
+    driver( 1e-3, cell, db, products, eq, rng );
+
+    /* sub-cycle s of both pairs runs before sub-cycle s+1 of either pair,
+     * such that the tests of the two pairs alternate (rather than all tests
+     * of 87Rb:87Rb being followed by all tests of 85Rb:85Rb). */
+    unsigned int n_switches = 0u;
+    for ( unsigned int i = 1u; i < mon.order.size(); ++i )
+      if ( mon.order[i] != mon.order[i-1u] )
+        ++n_switches;
+
+    BOOST_REQUIRE_GT( mon.order.size(), 100u );
+    BOOST_CHECK_GE( n_switches, 10u );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
@@ -0,0 +1,194 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the  VariableWeightNTC class.
+ * */
+#define BOOST_TEST_MODULE  VariableWeightNTC
+
+
+#include <chimp/interaction/VariableWeightNTC.h>
+#include <chimp/interaction/Driver.h>
+#include <chimp/accessors.h>
+#include <chimp/make_options.h>
+
+#include <xylose/Vector.h>
+#include <xylose/IteratorRange.h>
+#include <xylose/random/Kiss.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+namespace {
+  using xylose::V3;
+  typedef chimp::make_options<>::type options;
+  typedef options::Particle Particle;
+  typedef std::vector<Particle> PVector;
+  typedef xylose::IteratorRange< PVector::iterator > Range;
+  typedef std::pair< PVector::iterator, PVector::iterator > Pair;
+
+  /** Mock equation set that always accepts and modifies the particles in
+   * place (swapping their velocities) and/or creates products. */
+  struct MockSet {
+    bool create_products;
+    bool modify_in_place;
+    mutable double last_m_s_v;
+
+    MockSet( const bool & create_products, const bool & modify_in_place )
+      : create_products( create_products ),
+        modify_in_place( modify_in_place ),
+        last_m_s_v(0.0) { }
+
+    template < typename RNG >
+    std::pair<int,double>
+    interact( const double & m_s_v,
+              const Pair & pair,
+              PVector & result_list,
+              RNG &,
+              double & sigma_relspeed ) const {
+      last_m_s_v = m_s_v;
+      sigma_relspeed = m_s_v;
+      if ( modify_in_place ) {
+        std::swap( pair.first->v, pair.second->v );
+        if ( create_products )
+          /* e.g. an ionizing collision creating one additional particle. */
+          result_list.push_back( *pair.first );
+      } else if ( create_products ) {
+        result_list.push_back( *pair.second );
+        result_list.push_back( *pair.first );
+      }
+      return std::make_pair( 0, 1.0 );
+    }
+  };
+
+  PVector makeParticles() {
+    PVector p;
+    p.push_back( Particle( V3(0.,0.,0.), V3( 1.,0.,0.), 0, 1.0 ) );
+    p.push_back( Particle( V3(0.,0.,0.), V3(-1.,0.,0.), 1, 4.0 ) );
+    p.push_back( Particle( V3(0.,0.,0.), V3( 0.,2.,0.), 1, 2.0 ) );
+    return p;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( VariableWeightNTC_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( weightFactor ) {
+    PVector p = makeParticles();
+    chimp::interaction::VariableWeightNTC vw;
+    chimp::interaction::UniformWeightNTC uw;
+
+    Range a( p.begin(), p.begin() + 1 ), b( p.begin() + 1, p.end() ), empty;
+
+    BOOST_CHECK_EQUAL( vw.weightFactor( a, b ), 4.0 );
+    BOOST_CHECK_EQUAL( vw.weightFactor( b, b ), 4.0 );
+    BOOST_CHECK_EQUAL( vw.weightFactor( a, a ), 1.0 );
+    BOOST_CHECK_EQUAL( vw.weightFactor( a, empty ), 0.0 );
+
+    /* uniform:  Fa Fb / min(Fa,Fb) of the first particles. */
+    BOOST_CHECK_EQUAL( uw.weightFactor( a, b ), 4.0 );
+  }
+
+  BOOST_AUTO_TEST_CASE( out_of_place_conserves_weight ) {
+    PVector p = makeParticles();
+    PVector products;
+    xylose::random::Kiss rng;
+    chimp::interaction::VariableWeightNTC vw;
+    MockSet set( true, false );
+    double s_v = 0.0;
+
+    Pair pair( p.begin(), p.begin() + 1 );
+    std::pair<int,double> path =
+      vw.interact( set, 10.0, 4.0, pair, products, rng, s_v );
+
+    BOOST_CHECK_EQUAL( path.first, 0 );
+    BOOST_CHECK_CLOSE( s_v, 10.0, 1e-10 );
+    BOOST_CHECK_CLOSE( set.last_m_s_v, 10.0, 1e-10 );
+
+    BOOST_REQUIRE_EQUAL( products.size(), 3u );
+    BOOST_CHECK_EQUAL( products[0].weight, 1.0 );
+    BOOST_CHECK_EQUAL( products[1].weight, 1.0 );
+
+    /* the remainder of the heavier particle is kept unmodified. */
+    BOOST_CHECK_EQUAL( products[2].weight, 3.0 );
+    BOOST_CHECK_EQUAL( products[2].species, 1 );
+    BOOST_CHECK_EQUAL( products[2].v, V3(-1.,0.,0.) );
+
+    /* the pair with the lower maximum weight is accepted less often. */
+    Pair pair2( p.begin(), p.begin() + 2 );
+    vw.interact( set, 10.0, 4.0, pair2, products, rng, s_v );
+    BOOST_CHECK_CLOSE( set.last_m_s_v, 20.0, 1e-10 );
+  }
+
+  BOOST_AUTO_TEST_CASE( in_place_restores_heavy_particle ) {
+    xylose::random::Kiss rng;
+    chimp::interaction::VariableWeightNTC vw;
+    MockSet set( false, true );
+    double s_v = 0.0;
+    PVector products;
+
+    const unsigned int N = 100000u;
+    unsigned int n_modified = 0u;
+    for ( unsigned int i = 0; i < N; ++i ) {
+      PVector p = makeParticles();
+      Pair pair( p.begin(), p.begin() + 1 );
+      vw.interact( set, 10.0, 4.0, pair, products, rng, s_v );
+
+      /* the lighter particle always interacts. */
+      BOOST_REQUIRE_EQUAL( p[0].v, V3(-1.,0.,0.) );
+      if ( p[1].v == V3(1.,0.,0.) )
+        ++n_modified;
+    }
+
+    BOOST_CHECK_EQUAL( products.size(), 0u );
+    /* heavy particle interacts with probability w_lo/w_hi = 1/4. */
+    BOOST_CHECK_CLOSE( double(n_modified) / N, 0.25, 2.0 );
+  }
+
+  BOOST_AUTO_TEST_CASE( in_place_with_products_conserves_weight ) {
+    PVector p = makeParticles();
+    PVector products;
+    xylose::random::Kiss rng;
+    chimp::interaction::VariableWeightNTC vw;
+    MockSet set( true, true );
+    double s_v = 0.0;
+
+    Pair pair( p.begin(), p.begin() + 1 );
+    vw.interact( set, 10.0, 4.0, pair, products, rng, s_v );
+
+    /* the heavier particle keeps its post-collision state only for the
+     * interacting fraction of its weight. */
+    BOOST_CHECK_EQUAL( p[0].weight, 1.0 );
+    BOOST_CHECK_EQUAL( p[1].weight, 1.0 );
+    BOOST_CHECK_EQUAL( p[1].v, V3(1.,0.,0.) );
+
+    BOOST_REQUIRE_EQUAL( products.size(), 2u );
+    BOOST_CHECK_EQUAL( products[0].weight, 1.0 );
+
+    /* the remainder of the heavier particle is kept unmodified. */
+    BOOST_CHECK_EQUAL( products[1].weight, 3.0 );
+    BOOST_CHECK_EQUAL( products[1].species, 1 );
+    BOOST_CHECK_EQUAL( products[1].v, V3(-1.,0.,0.) );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
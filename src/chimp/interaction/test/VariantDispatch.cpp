@@ -0,0 +1,170 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the closed-set (variant) dispatch of interaction::Set.
+ * */
+#define BOOST_TEST_MODULE  VariantDispatch
+
+
+#include <chimp/RuntimeDB.h>
+#include <chimp/make_options.h>
+#include <chimp/interaction/Set.h>
+#include <chimp/interaction/detail/VariantDispatch.h>
+#include <chimp/interaction/cross_section/VHS.h>
+#include <chimp/interaction/filter/Or.h>
+#include <chimp/interaction/filter/Label.h>
+#include <chimp/interaction/filter/Elastic.h>
+
+#include <xylose/Vector.h>
+#include <xylose/random/Kiss.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+namespace {
+  using xylose::V3;
+  typedef chimp::make_options<>::type options;
+  typedef options::setVariantDispatch<true>::type voptions;
+  typedef chimp::RuntimeDB<options> DB;
+  typedef chimp::RuntimeDB<voptions> VDB;
+  typedef options::Particle Particle;
+
+  template < typename RnDB >
+  void init( RnDB & db ) {
+    namespace filter = chimp::interaction::filter;
+    typedef boost::shared_ptr<filter::Base> SP;
+
+    db.addParticleType("e^-");
+    db.addParticleType("N2");
+    db.addParticleType("87Rb");
+
+    db.filter =
+      SP(
+        new filter::Or( SP(new filter::Elastic),
+                        SP(new filter::Label("inelastic")) )
+      );
+
+    db.initBinaryInteractions();
+  }
+
+  /** A user-defined cross section derived from a built-in type. */
+  struct DoubledVHS : chimp::interaction::cross_section::VHS<voptions> {
+    typedef chimp::interaction::cross_section::VHS<voptions> super;
+    DoubledVHS( const super & that ) : super(that) { }
+    virtual double operator() (const double & v_relative) const {
+      return 2.0 * super::operator()(v_relative);
+    }
+  };
+}
+
+BOOST_AUTO_TEST_SUITE( VariantDispatch_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( cross_sections ) {
+    VDB db;
+    init(db);
+
+    typedef chimp::interaction::detail::CrossSectionVariant<voptions> CSV;
+    typedef chimp::interaction::detail::ModelVariant<voptions> MV;
+
+    unsigned int n_eqs = 0u;
+    for ( unsigned int A = 0u; A < db.getProps().size(); ++A ) {
+      for ( unsigned int B = A; B < db.getProps().size(); ++B ) {
+        const VDB::Set & set = db(A,B);
+        BOOST_REQUIRE_EQUAL( set.record.size(), set.rhs.size() );
+
+        for ( unsigned int j = 0u; j < set.rhs.size(); ++j, ++n_eqs ) {
+          BOOST_CHECK( set.record[j].cs.kind != CSV::VIRTUAL );
+          BOOST_CHECK( set.record[j].interaction.kind != MV::VIRTUAL );
+
+          for ( double v = 0.0; v < 1e7; v = 1.5 * v + 1.0 )
+            BOOST_CHECK_EQUAL( set.crossSection(j, v),
+                               set.rhs[j].cs->operator()(v) );
+        }
+      }
+    }
+
+    BOOST_CHECK_GT( n_eqs, 2u );
+  }
+
+  BOOST_AUTO_TEST_CASE( user_types_use_virtual_calls ) {
+    VDB db;
+    init(db);
+
+    VDB::Set set = db("87Rb", "87Rb");
+    BOOST_REQUIRE_EQUAL( set.rhs.size(), 1u );
+
+    typedef chimp::interaction::cross_section::VHS<voptions> VHS;
+    const VHS * vhs = dynamic_cast< const VHS * >( set.rhs[0].cs.get() );
+    BOOST_REQUIRE( vhs );
+    const double sigma = (*vhs)(100.0);
+    set.rhs[0].cs.reset( new DoubledVHS( *vhs ) );
+    set.updateRecord();
+
+    typedef chimp::interaction::detail::CrossSectionVariant<voptions> CSV;
+    BOOST_CHECK_EQUAL( set.record[0].cs.kind, CSV::VIRTUAL );
+    BOOST_CHECK_EQUAL( set.crossSection(0, 100.0), 2.0 * sigma );
+  }
+
+  BOOST_AUTO_TEST_CASE( matches_virtual_dispatch ) {
+    DB db;
+    VDB vdb;
+    init(db);
+    init(vdb);
+
+    const char * pairs[][2] = { { "87Rb", "87Rb" }, { "e^-", "N2" } };
+    for ( unsigned int p = 0u; p < 2u; ++p ) {
+      const DB::Set & set = db( pairs[p][0], pairs[p][1] );
+      const VDB::Set & vset = vdb( pairs[p][0], pairs[p][1] );
+      BOOST_REQUIRE_EQUAL( set.rhs.size(), vset.rhs.size() );
+
+      for ( unsigned int j = 0u; j < set.rhs.size(); ++j ) {
+        const int sA = set.rhs[j].A.species;
+        const int sB = set.rhs[j].B.species;
+        Particle pA( V3(0,0,0), V3( 1e6, 0, 0), sA ),
+                 pB( V3(1,2,3), V3(-1e6, 0, 0), sB );
+        Particle vA = pA, vB = pB;
+
+        xylose::random::Kiss rng, vrng;
+        rng.seed( 10u + j );
+        vrng.seed( 10u + j );
+
+        std::vector<Particle> products, vproducts;
+        const std::pair<int,double> path( static_cast<int>(j), 1.0 );
+        set.applyOutPath( path, pA, pB, products, rng );
+        vset.applyOutPath( path, vA, vB, vproducts, vrng );
+
+        BOOST_CHECK_EQUAL( pA.v, vA.v );
+        BOOST_CHECK_EQUAL( pB.v, vB.v );
+        BOOST_REQUIRE_EQUAL( products.size(), vproducts.size() );
+        for ( unsigned int k = 0u; k < products.size(); ++k ) {
+          BOOST_CHECK_EQUAL( products[k].v, vproducts[k].v );
+          BOOST_CHECK_EQUAL( products[k].x, vproducts[k].x );
+          BOOST_CHECK_EQUAL( products[k].species, vproducts[k].species );
+        }
+      }
+    }
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
@@ -82,6 +82,20 @@ namespace chimp {
       return MAX_SPEED_FACTOR * stddev_v;
     }
 
+    /** Estimate the maximum relative speed of a set of thermalized particles
+     * at a given temperature and reduced mass.  This can be used to seed the
+     * search for (sigma*v)_max (see Set::findMaxSigmaVProduct and
+     * AdaptiveMaxSigmaVProduct::seed_temperature).
+     *
+     * @param T
+     *     Temperature of assumed ensemble.
+     * @param reduced_mass
+     *     Reduced mass of particles in assumed ensemble.
+     * */
+    inline double estMaxVFromT(const double & T, const double & reduced_mass) {
+      return estMaxVFromStdV( calcStdVFromT( T, reduced_mass ) );
+    }
+
   }/* namespace particldb::interaction */
 }/* namespace particldb */
 #endif // chimp_interaction_v_rel_fnc_h
@@ -75,6 +75,9 @@ namespace chimp {
    *   \endverbatim
    *   See the default implementations chimp::interaction::velocity,
    *   chimp::interaction::position, chimp::interaction::species.
+   *   chimp::SoAParticle (see chimp/SoAParticles.h) is a ready-made proxy
+   *   of this kind for separate position, velocity, species, and weight
+   *   arrays.
    *
    *   <br>
    *   [Default:  chimp::test::Particle]<br>
@@ -97,7 +100,8 @@ namespace chimp {
    *
    * @tparam _RNG
    *   The type of random number generator that the interaction models will
-   *   accept.
+   *   accept.  Use chimp::random::Philox for counter-based streams keyed by
+   *   (cell, step, pair) (see chimp::interaction::CounterRNGStreams).
    *   [Default:  xylose::random::Kiss]
    *
    * @tparam _cross_section_data_extrapolation_allowed
@@ -106,6 +110,31 @@ namespace chimp {
    *   environment variable.  If this variable is set to 'no' then extrapolation
    *   will not be allowed.  Anything else will allow extrapolation.
    *   [Default:  true]
+   *
+   * @tparam _precomputed_sets
+   *   Whether the RuntimeDB interaction table uses
+   *   chimp::interaction::PreComputedSet (tabulated total cross sections and
+   *   output path probabilities) instead of chimp::interaction::Set.
+   *   [Default:  false]
+   *
+   * @tparam _variant_dispatch
+   *   Whether the record of each interaction::Set (see
+   *   interaction::CollisionRecord) tags the cross section and model of each
+   *   of its equations with their types such that the built-in cross
+   *   sections and interaction models are evaluated without virtual function
+   *   calls.
+   *   Cross sections and models of any other (user-registered) type still use
+   *   virtual calls.
+   *   [Default:  false]
+   *
+   * @tparam _lazy_sets
+   *   Whether initBinaryInteractions() only determines which pairs of species
+   *   interact and defers loading the equations (and preparing the set) of
+   *   each pair until the set of the pair is first accessed.  Startup time
+   *   and memory then scale with the pairs actually used in a simulation.
+   *   Missing elastic cross sections (see _auto_create_missing_elastic) are
+   *   also created on first access.
+   *   [Default:  false]
    * */
   template <
     typename _Particle          = chimp::test::Particle,
@@ -113,7 +142,10 @@ namespace chimp {
     bool _inplace_interactions  = true,
     bool _auto_create_missing_elastic = false,
     typename _RNG               = xylose::random::Kiss,
-    bool _cross_section_data_extrapolation_allowed = true
+    bool _cross_section_data_extrapolation_allowed = true,
+    bool _precomputed_sets      = false,
+    bool _variant_dispatch      = false,
+    bool _lazy_sets             = false
   >
   struct make_options {
     /** The result of the chimp::make_options template metafunction. */
@@ -145,6 +177,17 @@ namespace chimp {
       static const bool cross_section_data_extrapolation_allowed
         = _cross_section_data_extrapolation_allowed;
 
+      /** Whether to use interaction::PreComputedSet for the interaction table.
+       */
+      static const bool precomputed_sets = _precomputed_sets;
+
+      /** Whether to evaluate built-in cross sections and interaction models
+       * of interaction::Set without virtual function calls. */
+      static const bool variant_dispatch = _variant_dispatch;
+
+      /** Whether the interaction sets are loaded on first access. */
+      static const bool lazy_sets = _lazy_sets;
+
       /** Set options with the given Particle type. */
       template < typename T >
       struct setParticle {
@@ -154,7 +197,10 @@ namespace chimp {
           inplace_interactions,
           auto_create_missing_elastic,
           RNG,
-          cross_section_data_extrapolation_allowed
+          cross_section_data_extrapolation_allowed,
+          precomputed_sets,
+          variant_dispatch,
+          lazy_sets
         >::type type;
       };/* setParticle */
 
@@ -167,7 +213,10 @@ namespace chimp {
           inplace_interactions,
           auto_create_missing_elastic,
           RNG,
-          cross_section_data_extrapolation_allowed
+          cross_section_data_extrapolation_allowed,
+          precomputed_sets,
+          variant_dispatch,
+          lazy_sets
         >::type type;
       };/* setProperties */
 
@@ -180,7 +229,10 @@ namespace chimp {
           B,
           auto_create_missing_elastic,
           RNG,
-          cross_section_data_extrapolation_allowed
+          cross_section_data_extrapolation_allowed,
+          precomputed_sets,
+          variant_dispatch,
+          lazy_sets
         >::type type;
       };/* setInplaceInteractions */
 
@@ -193,7 +245,10 @@ namespace chimp {
           inplace_interactions,
           B,
           RNG,
-          cross_section_data_extrapolation_allowed
+          cross_section_data_extrapolation_allowed,
+          precomputed_sets,
+          variant_dispatch,
+          lazy_sets
         >::type type;
       };/* setAutoCreateMissingElastic */
 
@@ -206,7 +261,10 @@ namespace chimp {
           inplace_interactions,
           auto_create_missing_elastic,
           T,
-          cross_section_data_extrapolation_allowed
+          cross_section_data_extrapolation_allowed,
+          precomputed_sets,
+          variant_dispatch,
+          lazy_sets
         >::type type;
       };/* setRNG */
 
@@ -219,9 +277,60 @@ namespace chimp {
           inplace_interactions,
           auto_create_missing_elastic,
           RNG,
+          B,
+          precomputed_sets,
+          variant_dispatch,
+          lazy_sets
+        >::type type;
+      };/* setCrossSectionExtrapolAllowed */
+
+      /** Set options to use (or not) interaction::PreComputedSet. */
+      template < bool B >
+      struct setPreComputedSets {
+        typedef typename make_options<
+          Particle,
+          Properties,
+          inplace_interactions,
+          auto_create_missing_elastic,
+          RNG,
+          cross_section_data_extrapolation_allowed,
+          B,
+          variant_dispatch,
+          lazy_sets
+        >::type type;
+      };/* setPreComputedSets */
+
+      /** Set options to use (or not) variant dispatch of interaction::Set. */
+      template < bool B >
+      struct setVariantDispatch {
+        typedef typename make_options<
+          Particle,
+          Properties,
+          inplace_interactions,
+          auto_create_missing_elastic,
+          RNG,
+          cross_section_data_extrapolation_allowed,
+          precomputed_sets,
+          B,
+          lazy_sets
+        >::type type;
+      };/* setVariantDispatch */
+
+      /** Set options to load (or not) interaction sets on first access. */
+      template < bool B >
+      struct setLazySets {
+        typedef typename make_options<
+          Particle,
+          Properties,
+          inplace_interactions,
+          auto_create_missing_elastic,
+          RNG,
+          cross_section_data_extrapolation_allowed,
+          precomputed_sets,
+          variant_dispatch,
           B
         >::type type;
-      };/* setRNG */
+      };/* setLazySets */
     };/* struct type */
   };/* make_options */
 
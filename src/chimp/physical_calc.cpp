@@ -22,14 +22,17 @@
 
 /** \file
  * Implementation for runtime::physical::calc::Driver (of \ref physical_cpp
- * "physical::c++" package) preparation function.
+ * "physical::c++" package) preparation function and chimp::CalcContext.
  */
 
 #include <chimp/physical_calc.h>
 #include <chimp/interaction/model/detail/inelastic_helpers.h>
+#include <chimp/interaction/detail/NestLock.h>
 
 #include <physical/calc/Driver.h>
 
+#include <boost/scoped_ptr.hpp>
+
 namespace chimp {
 
   void prepareCalculator( const xml::Doc & doc ) {
@@ -61,4 +64,102 @@ namespace chimp {
       calc.exec(x.parse<std::string>());
     }
   }
+
+
+
+  namespace {
+    using runtime::physical::calc::Driver;
+
+    /** Process-wide recursive lock of the calculator. */
+    interaction::detail::NestLock & calcLock() {
+      static interaction::detail::NestLock lock;
+      return lock;
+    }
+
+    /** Symbol table that can be exchanged with the one of the calculator. */
+    struct SymbolTable {
+      virtual ~SymbolTable() { }
+      virtual void swap( Driver & calc ) = 0;
+    };
+
+    template < typename Table >
+    struct SymbolTableImpl : SymbolTable {
+      Table table;
+      virtual void swap( Driver & calc ) { table.swap( calc.symbols ); }
+    };
+
+    /** Create a SymbolTable of the same type as Driver::symbols. */
+    template < typename Table >
+    SymbolTable * newSymbolTable( Table Driver::* ) {
+      return new SymbolTableImpl< Table >;
+    }
+  }
+
+  struct CalcContext::Symbols {
+    /** The symbols of the context while they are not installed and the
+     * process-wide symbols while they are. */
+    boost::scoped_ptr< SymbolTable > table;
+
+    Symbols() : table( newSymbolTable( &Driver::symbols ) ) { }
+  };
+
+  namespace {
+    /** The symbols that are currently installed in the calculator (NULL if
+     * none).  At most one context is installed at any time.  This is only
+     * accessed while holding calcLock(). */
+    CalcContext::Symbols * & installedSymbols() {
+      static CalcContext::Symbols * installed = NULL;
+      return installed;
+    }
+
+    /** Install the given symbols (or none) in place of the ones that are
+     * currently installed. */
+    void installSymbols( CalcContext::Symbols * symbols ) {
+      CalcContext::Symbols * & installed = installedSymbols();
+      if ( installed == symbols )
+        return;
+
+      if ( installed )
+        installed->table->swap( Driver::instance() );
+      if ( symbols )
+        symbols->table->swap( Driver::instance() );
+      installed = symbols;
+    }
+  }
+
+
+  CalcContext::CalcContext() : symbols( new Symbols ) {
+    reset();
+  }
+
+  void CalcContext::reset() {
+    Scope scope( *this );
+    Driver & calc = Driver::instance();
+    calc.symbols.clear();
+    calc.addMathLib();
+    calc.addPhysicalUnits();
+  }
+
+  void CalcContext::prepare( const xml::Doc & doc ) {
+    reset();
+    exec( doc );
+  }
+
+  void CalcContext::exec( const xml::Doc & doc, const std::string & section ) {
+    Scope scope( *this );
+    execCalcCommands( doc, section );
+  }
+
+
+  CalcContext::Scope::Scope( const CalcContext & ctx )
+    : symbols( *ctx.symbols ) {
+    calcLock().set();
+    previous = installedSymbols();
+    installSymbols( &symbols );
+  }
+
+  CalcContext::Scope::~Scope() {
+    installSymbols( previous );
+    calcLock().unset();
+  }
 } /* namespace chimp */
@@ -22,7 +22,8 @@
 
 /** \file
  * Prototype for runtime::physical::calc::Driver (of \ref physical_cpp
- * "physical::c++" package) preparation function.
+ * "physical::c++" package) preparation function and the declaration of the
+ * chimp::CalcContext class.
  */
 
 #ifndef chimp_physical_calc_h
@@ -30,24 +31,103 @@
 
 #include <xylose/xml/Doc.h>
 
+#include <boost/shared_ptr.hpp>
+
 #include <string>
 
 namespace chimp {
   namespace xml = xylose::xml;
+  using boost::shared_ptr;
 
-  /** Prepare the units calculator by executing commands stored in the
-   * calc-command subsections of the xml file.
-   * This function is used inside the RuntimeDB class after the xml data set is
-   * opened.  Generally, an end user does not need to use this function. 
+  /** Prepare the process-wide units calculator by executing commands stored
+   * in the calc-command subsections of the xml file.
+   * The RuntimeDB class uses its own CalcContext instead.  This function is
+   * useful when parsing quantities of an xml data set outside of a RuntimeDB.
    */
   void prepareCalculator( const xml::Doc & doc );
 
   /** Continue preparing the units calculator by executing commands stored in
    * the calc-command subsections of the xml file for the given section.
-   * This function is used inside the RuntimeDB class after the xml data set is
-   * opened.  Generally, an end user does not need to use this function. 
+   * This function is used by CalcContext::exec.  Generally, an end user does
+   * not need to use this function. 
    */
   void execCalcCommands( const xml::Doc & doc, std::string section = "//" );
+
+
+  /** Units calculator context owned by a single RuntimeDB.
+   *
+   * The physical::c++ package parses all quantities (such as those in the
+   * cross section data) with the process-wide
+   * runtime::physical::calc::Driver::instance().  A CalcContext keeps its own
+   * table of symbols and installs it into the process-wide calculator only
+   * for the lifetime of a CalcContext::Scope, such that several RuntimeDB
+   * instances with different calc-commands can coexist in one process.
+   * Scopes are serialized by a process-wide (recursive) lock since the
+   * calculator itself is not thread safe.
+   */
+  class CalcContext {
+    /* TYPEDEFS */
+  public:
+    class Scope;
+
+    /** Storage of the symbol table (defined in the implementation file). */
+    struct Symbols;
+
+
+    /* MEMBER STORAGE */
+  private:
+    /** The symbols of this context.  Copies of a CalcContext share the
+     * symbols. */
+    shared_ptr<Symbols> symbols;
+
+    friend class Scope;
+
+
+    /* MEMBER FUNCTIONS */
+  public:
+    /** Constructor prepares the math library and the physical units. */
+    CalcContext();
+
+    /** Reset the context to only the math library and the physical units. */
+    void reset();
+
+    /** Reset the context to the math library and the physical units and then
+     * execute the calc-commands of the given document. */
+    void prepare( const xml::Doc & doc );
+
+    /** Execute the calc-commands of the given section of the document in this
+     * context. */
+    void exec( const xml::Doc & doc, const std::string & section = "//" );
+  };
+
+
+  /** Installs the symbols of a CalcContext into the process-wide calculator
+   * for the lifetime of the Scope.  Scopes may be nested, also with
+   * different contexts:  the symbols of the innermost scope are always the
+   * ones installed. */
+  class CalcContext::Scope {
+    /* MEMBER STORAGE */
+  private:
+    /** The symbols installed by this scope. */
+    CalcContext::Symbols & symbols;
+
+    /** The symbols that were installed before this scope (NULL if none). */
+    CalcContext::Symbols * previous;
+
+
+    /* MEMBER FUNCTIONS */
+  public:
+    /** Lock the process-wide calculator and install the symbols of ctx. */
+    explicit Scope( const CalcContext & ctx );
+
+    /** Restore the previous symbols of the process-wide calculator (keeping
+     * any new symbols in the context) and unlock it. */
+    ~Scope();
+
+  private:
+    Scope( const Scope & );
+    Scope & operator=( const Scope & );
+  };
 } /* namespace chimp */
 
 #endif // chimp_physical_calc_h
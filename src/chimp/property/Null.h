@@ -49,6 +49,10 @@ namespace chimp {
        * class; required by property::Add template metafunction. */
       template < typename DBnode >
       static inline Null load(const DBnode & x) { return Null(); }
+
+      /** A NO-OP function; required to save aggregated properties. */
+      template < typename Writer >
+      void save( Writer & out ) const { }
     };
 
   }/* namespace chimp::property */
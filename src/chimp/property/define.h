@@ -29,6 +29,7 @@
 #define chimp_property_define_h
 
 #include <chimp/property/detail/check.h>
+#include <chimp/BinaryCache.h>
 
 #include <xylose/xml/Doc.h>
 
@@ -77,6 +78,16 @@ namespace chimp {
           return x.query< cpd::check<T,dimension> > \
             ( xpath, default_value ).value; \
       } \
+ \
+      /** Save function (writes to binary cache). */ \
+      void save(chimp::BinaryWriter & out) const { out.write(value); } \
+ \
+      /** Load function (reads from binary cache). */ \
+      static Property load(chimp::BinaryReader & in) { \
+        Property p; \
+        in.read(p.value); \
+        return p; \
+      } \
     } /* require the ';' by calling code */
 
   }/* namespace chimp::property */
@@ -27,6 +27,8 @@
 #ifndef chimp_property_detail_list_h
 #define chimp_property_detail_list_h
 
+#include <chimp/BinaryCache.h>
+
 #include <ostream>
 
 namespace chimp {
@@ -59,6 +61,20 @@ namespace chimp {
           l.L::operator=(L::load(x));
           return l;
         }
+
+        /** Save properties to a binary cache. */
+        void save( BinaryWriter & out ) const {
+          P::save(out);
+          L::save(out);
+        }
+
+        /** Load properties from a binary cache. */
+        static List load( BinaryReader & in ) {
+          List l;
+          l.P::operator=(P::load(in));
+          l.L::operator=(L::load(in));
+          return l;
+        }
       };
 
       /** Covers the case of <P, Null>. */
@@ -79,6 +95,18 @@ namespace chimp {
           l.P::operator=(P::load(x));
           return l;
         }
+
+        /** Save properties to a binary cache. */
+        void save( BinaryWriter & out ) const {
+          P::save(out);
+        }
+
+        /** Load properties from a binary cache. */
+        static List load( BinaryReader & in ) {
+          List l;
+          l.P::operator=(P::load(in));
+          return l;
+        }
       };
       /* ****** END List SPECIALIZATIONS ******* */
 
@@ -29,6 +29,8 @@
 #define chimp_property_size_h
 
 
+#include <chimp/BinaryCache.h>
+
 #include <xylose/xml/Doc.h>
 
 #include <string>
@@ -60,6 +62,14 @@ namespace chimp {
 
       /** Load function (does not use xml; returns default size value. */
       static inline size load( const xml::Context & x ) { return size(); }
+
+      /** Save function (writes to binary cache). */
+      void save( BinaryWriter & out ) const { out.write(value); }
+
+      /** Load function (reads from binary cache). */
+      static inline size load( BinaryReader & in ) {
+        return size( in.get<double>() );
+      }
     };
 
   }/* namespace chimp::property */
@@ -0,0 +1,257 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+/** \file
+ * Counter-based (Philox4x32-10) random number generator.
+ */
+
+#ifndef chimp_random_Philox_h
+#define chimp_random_Philox_h
+
+#include <boost/cstdint.hpp>
+
+#include <cstddef>
+
+namespace chimp {
+  namespace random {
+
+    /** Counter-based random number generator of the Philox4x32-10 family
+     * (Salmon et al., "Parallel random numbers:  as easy as 1, 2, 3", SC11).
+     *
+     * Each block of four 32-bit random integers is a bijection of a 128-bit
+     * counter keyed with a 64-bit key.  The counter is composed of
+     * (block, pair, cell, step), such that the stream of random numbers is
+     * completely determined by (seed, cell, step, pair) and does not depend on
+     * which thread uses the generator or on how many numbers other streams
+     * consumed.  Because blocks are independent of each other, many blocks can
+     * be generated at once (see fill()), which the compiler can vectorize.
+     *
+     * The interface is compatible with xylose::random::Kiss such that this
+     * class can be used as the RNG of make_options::type::setRNG.
+     */
+    class Philox {
+      /* TYPEDEFS */
+    public:
+      typedef boost::uint32_t uint32;
+      typedef boost::uint64_t uint64;
+
+
+      /* MEMBER STORAGE */
+    private:
+      /** The key:  (seed, 0). */
+      uint32 key[2];
+
+      /** The counter:  (block, pair, cell, step). */
+      uint32 ctr[4];
+
+      /** The current block of random integers. */
+      uint32 buf[4];
+
+      /** Position of the next unused integer of buf (4 if buf is used up). */
+      unsigned int pos;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** Constructor.  The stream (cell, step, pair) is set to (0, 0, 0). */
+      explicit Philox( const unsigned int & s = 1u ) {
+        seed(s);
+      }
+
+      /** Set the key of the generator and reset the stream to
+       * (cell, step, pair) = (0, 0, 0). */
+      void seed( const unsigned int & s ) {
+        key[0] = s;
+        key[1] = 0u;
+        setStream( 0u, 0u, 0u );
+      }
+
+      /** Select the stream of random numbers of the given cell, time step,
+       * and pair (or any other index that should be independent). */
+      void setStream( const uint32 & cell,
+                      const uint32 & step,
+                      const uint32 & pair = 0u ) {
+        ctr[2] = cell;
+        ctr[3] = step;
+        setPair( pair );
+      }
+
+      /** Select the stream of the given pair within the current cell and time
+       * step. */
+      void setPair( const uint32 & pair ) {
+        ctr[0] = 0u;
+        ctr[1] = pair;
+        pos = 4u;
+      }
+
+      /** Advance to the next pair stream within the current cell and time
+       * step.  The current pair stream is kept if nothing has been drawn from
+       * it yet, so that the first stream after setStream is pair 0. */
+      void nextPair() {
+        if ( ctr[0] != 0u || pos != 4u )
+          setPair( ctr[1] + 1u );
+      }
+
+      /** Obtain a random 32-bit integer in [0, 2^32-1]. */
+      uint32 randInt() {
+        if ( pos == 4u ) {
+          block( ctr, key, buf );
+          ++ctr[0];
+          pos = 0u;
+        }
+        return buf[pos++];
+      }
+
+      /** Obtain a random integer in [0, n] for n < 2^32. */
+      uint32 randInt( const uint32 & n ) {
+        return static_cast<uint32>(
+          randExc() * ( static_cast<double>(n) + 1.0 ) );
+      }
+
+      /** Obtain a random real number in [0, 1]. */
+      double rand() { return toClosed( randInt() ); }
+
+      /** Obtain a random real number in [0, 1). */
+      double randExc() { return toHalfOpen( randInt() ); }
+
+      /** Obtain a random real number in (0, 1). */
+      double randDblExc() { return toOpen( randInt() ); }
+
+      /** Fill u with n random real numbers in [0, 1].  The result is the same
+       * as n successive calls of rand(). */
+      void fill( double * u, const std::size_t & n ) {
+        std::size_t i = 0u;
+
+        /* first use up the current block. */
+        for ( ; i < n && pos < 4u; ++i )
+          u[i] = toClosed( buf[pos++] );
+
+        /* whole blocks:  each iteration is independent. */
+        const std::size_t n_blocks = ( n - i ) / 4u;
+        const uint32 c0 = ctr[0];
+        for ( std::size_t b = 0u; b < n_blocks; ++b ) {
+          uint32 c[4] = { static_cast<uint32>( c0 + b ),
+                          ctr[1], ctr[2], ctr[3] };
+          uint32 r[4];
+          block( c, key, r );
+          double * ub = u + i + 4u * b;
+          ub[0] = toClosed( r[0] );
+          ub[1] = toClosed( r[1] );
+          ub[2] = toClosed( r[2] );
+          ub[3] = toClosed( r[3] );
+        }
+        ctr[0] = static_cast<uint32>( c0 + n_blocks );
+        i += 4u * n_blocks;
+
+        /* the remainder. */
+        for ( ; i < n; ++i )
+          u[i] = rand();
+      }
+
+      /** The Philox4x32-10 bijection of a counter with a key. */
+      static void block( const uint32 (&counter)[4],
+                         const uint32 (&k)[2],
+                         uint32 (&out)[4] ) {
+        static const uint32 M0 = 0xD2511F53u;
+        static const uint32 M1 = 0xCD9E8D57u;
+        static const uint32 W0 = 0x9E3779B9u;
+        static const uint32 W1 = 0xBB67AE85u;
+
+        uint32 c0 = counter[0], c1 = counter[1],
+               c2 = counter[2], c3 = counter[3];
+        uint32 k0 = k[0], k1 = k[1];
+
+        for ( unsigned int r = 0u; r < 10u; ++r ) {
+          if ( r > 0u ) {
+            k0 += W0;
+            k1 += W1;
+          }
+          const uint64 p0 = static_cast<uint64>(M0) * c0;
+          const uint64 p1 = static_cast<uint64>(M1) * c2;
+          const uint32 hi0 = static_cast<uint32>( p0 >> 32 );
+          const uint32 lo0 = static_cast<uint32>( p0 );
+          const uint32 hi1 = static_cast<uint32>( p1 >> 32 );
+          const uint32 lo1 = static_cast<uint32>( p1 );
+          c0 = hi1 ^ c1 ^ k0;
+          c1 = lo1;
+          c2 = hi0 ^ c3 ^ k1;
+          c3 = lo0;
+        }
+
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+      }
+
+    private:
+      static double toClosed( const uint32 & x ) {
+        return x * ( 1.0 / 4294967295.0 );
+      }
+
+      static double toHalfOpen( const uint32 & x ) {
+        return x * ( 1.0 / 4294967296.0 );
+      }
+
+      static double toOpen( const uint32 & x ) {
+        return ( x + 0.5 ) * ( 1.0 / 4294967296.0 );
+      }
+    };
+
+
+    /** Fill u with n random real numbers in [0, 1] as given by n successive
+     * calls of rng.rand(). */
+    template < typename RNG >
+    inline void fill( RNG & rng, double * u, const std::size_t & n ) {
+      for ( std::size_t i = 0u; i < n; ++i )
+        u[i] = rng.rand();
+    }
+
+    /** Block-generating overload of fill for the Philox generator. */
+    inline void fill( Philox & rng, double * u, const std::size_t & n ) {
+      rng.fill( u, n );
+    }
+
+
+    /** Select the stream of the given pair for generators that support it
+     * (a no-op for all other generators). */
+    template < typename RNG >
+    inline void setPair( RNG & /* rng */, const unsigned int & /* pair */ ) { }
+
+    /** Select the stream of the given pair of the Philox generator. */
+    inline void setPair( Philox & rng, const unsigned int & pair ) {
+      rng.setPair( pair );
+    }
+
+    /** Advance to the next pair stream for generators that support it
+     * (a no-op for all other generators). */
+    template < typename RNG >
+    inline void nextPair( RNG & /* rng */ ) { }
+
+    /** Advance to the next pair stream of the Philox generator. */
+    inline void nextPair( Philox & rng ) {
+      rng.nextPair();
+    }
+
+  }/* namespace chimp::random */
+}/* namespace chimp */
+
+#endif // chimp_random_Philox_h
@@ -0,0 +1,174 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the  Philox class.
+ * */
+#define BOOST_TEST_MODULE  Philox
+
+
+#include <chimp/random/Philox.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+  using chimp::random::Philox;
+  typedef Philox::uint32 uint32;
+
+  void checkBlock( const uint32 (&ctr)[4],
+                   const uint32 (&key)[2],
+                   const uint32 (&expected)[4] ) {
+    uint32 out[4];
+    Philox::block( ctr, key, out );
+    for ( unsigned int i = 0u; i < 4u; ++i )
+      BOOST_CHECK_EQUAL( out[i], expected[i] );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( Philox_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( known_answers ) {
+    /* Known-answer tests of Philox4x32-10 (from the Random123 library). */
+    {
+      const uint32 ctr[4] = { 0u, 0u, 0u, 0u };
+      const uint32 key[2] = { 0u, 0u };
+      const uint32 res[4] =
+        { 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u };
+      checkBlock( ctr, key, res );
+    }
+
+    {
+      const uint32 ctr[4] =
+        { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu };
+      const uint32 key[2] = { 0xffffffffu, 0xffffffffu };
+      const uint32 res[4] =
+        { 0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu };
+      checkBlock( ctr, key, res );
+    }
+
+    {
+      const uint32 ctr[4] =
+        { 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u };
+      const uint32 key[2] = { 0xa4093822u, 0x299f31d0u };
+      const uint32 res[4] =
+        { 0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u };
+      checkBlock( ctr, key, res );
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE( fill_matches_rand ) {
+    Philox a(7u), b(7u);
+    a.setStream( 3u, 5u, 2u );
+    b.setStream( 3u, 5u, 2u );
+
+    /* start in the middle of a block. */
+    a.rand();
+    b.rand();
+
+    std::vector<double> u( 37u );
+    a.fill( &u[0], u.size() );
+    for ( unsigned int i = 0u; i < u.size(); ++i )
+      BOOST_CHECK_EQUAL( u[i], b.rand() );
+
+    /* both continue from the same point. */
+    BOOST_CHECK_EQUAL( a.rand(), b.rand() );
+
+    /* the generic fill gives the same result for the Philox generator. */
+    std::vector<double> w( 9u );
+    chimp::random::fill( a, &w[0], w.size() );
+    for ( unsigned int i = 0u; i < w.size(); ++i )
+      BOOST_CHECK_EQUAL( w[i], b.rand() );
+  }
+
+  BOOST_AUTO_TEST_CASE( streams ) {
+    Philox a(11u);
+    a.setStream( 4u, 9u, 1u );
+    const double a0 = a.rand();
+    a.rand();
+
+    /* re-selecting a stream restarts it. */
+    a.setPair( 1u );
+    BOOST_CHECK_EQUAL( a.rand(), a0 );
+
+    /* streams of different cells, steps, pairs, and seeds differ. */
+    Philox b(11u);
+    b.setStream( 5u, 9u, 1u );
+    BOOST_CHECK_NE( b.rand(), a0 );
+    b.setStream( 4u, 10u, 1u );
+    BOOST_CHECK_NE( b.rand(), a0 );
+    b.setStream( 4u, 9u, 2u );
+    BOOST_CHECK_NE( b.rand(), a0 );
+
+    Philox c(12u);
+    c.setStream( 4u, 9u, 1u );
+    BOOST_CHECK_NE( c.rand(), a0 );
+  }
+
+  BOOST_AUTO_TEST_CASE( next_pair ) {
+    Philox a(11u), b(11u);
+    a.setStream( 4u, 9u );
+    b.setStream( 4u, 9u );
+
+    /* an unused stream is kept. */
+    a.nextPair();
+    const double a0 = a.rand();
+    BOOST_CHECK_EQUAL( a0, b.rand() );
+
+    /* a used stream is never repeated. */
+    a.nextPair();
+    b.setPair( 1u );
+    const double a1 = a.rand();
+    BOOST_CHECK_EQUAL( a1, b.rand() );
+    BOOST_CHECK_NE( a1, a0 );
+
+    a.nextPair();
+    BOOST_CHECK_NE( a.rand(), a1 );
+  }
+
+  BOOST_AUTO_TEST_CASE( distribution ) {
+    Philox rng;
+    const unsigned int N = 1000000u;
+    double sum = 0.0, sum2 = 0.0;
+    double lo = 1.0, hi = 0.0;
+    for ( unsigned int i = 0u; i < N; ++i ) {
+      const double r = rng.randExc();
+      sum += r;
+      sum2 += r*r;
+      lo = std::min( lo, r );
+      hi = std::max( hi, r );
+    }
+
+    BOOST_CHECK_GE( lo, 0.0 );
+    BOOST_CHECK_LT( hi, 1.0 );
+    BOOST_CHECK_CLOSE( sum / N, 0.5, 0.5 );
+    BOOST_CHECK_CLOSE( sum2 / N - (sum/N)*(sum/N), 1.0/12.0, 1.0 );
+
+    for ( unsigned int i = 0u; i < 1000u; ++i )
+      BOOST_CHECK_LE( rng.randInt(5u), 5u );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
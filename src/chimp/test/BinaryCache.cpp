@@ -0,0 +1,222 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the  BinaryCache class and the binary cache support of the
+ * RuntimeDB class.
+ * */
+#define BOOST_TEST_MODULE  BinaryCache
+
+
+#include <chimp/BinaryCache.h>
+#include <chimp/RuntimeDB.h>
+#include <chimp/interaction/filter/Or.h>
+#include <chimp/interaction/filter/Label.h>
+#include <chimp/interaction/filter/Elastic.h>
+#include <chimp/property/name.h>
+#include <chimp/property/mass.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+
+namespace {
+  typedef chimp::RuntimeDB<
+    chimp::make_options<>::type::setAutoCreateMissingElastic<true>::type
+  > DB;
+
+  const char * filename = "BinaryCache-test.bin";
+
+  /** Check that the two databases have the same properties and interaction
+   * tables. */
+  template < typename DB >
+  void check_equal( const DB & db0, const DB & db1 ) {
+    using chimp::property::name;
+    using chimp::property::mass;
+
+    BOOST_REQUIRE_EQUAL( db0.getProps().size(), db1.getProps().size() );
+    for ( unsigned int i = 0u; i < db0.getProps().size(); ++i ) {
+      BOOST_CHECK_EQUAL( db0[i].name::value, db1[i].name::value );
+      BOOST_CHECK_EQUAL( db0[i].mass::value, db1[i].mass::value );
+    }
+
+    for ( unsigned int A = 0u; A < db0.getProps().size(); ++A ) {
+      for ( unsigned int B = A; B < db0.getProps().size(); ++B ) {
+        const typename DB::Set & s0 = db0(A,B);
+        const typename DB::Set & s1 = db1(A,B);
+        BOOST_REQUIRE_EQUAL( s0.rhs.size(), s1.rhs.size() );
+
+        for ( unsigned int j = 0u; j < s0.rhs.size(); ++j ) {
+          const typename DB::Set::Equation & eq0 = s0.rhs[j];
+          const typename DB::Set::Equation & eq1 = s1.rhs[j];
+
+          std::ostringstream e0, e1;
+          eq0.print( e0, db0 );
+          eq1.print( e1, db1 );
+          BOOST_CHECK_EQUAL( e0.str(), e1.str() );
+
+          BOOST_CHECK_EQUAL( eq0.reducedMass.value, eq1.reducedMass.value );
+          BOOST_CHECK_EQUAL( eq0.interaction->getLabel(),
+                             eq1.interaction->getLabel() );
+          BOOST_CHECK_EQUAL( eq0.cs->getThresholdEnergy(),
+                             eq1.cs->getThresholdEnergy() );
+
+          for ( double v = 1.0; v < 1e6; v *= 1.5 ) {
+            BOOST_CHECK_EQUAL( (*eq0.cs)(v), (*eq1.cs)(v) );
+            BOOST_CHECK_EQUAL( eq0.cs->findMaxSigmaVProduct(v),
+                               eq1.cs->findMaxSigmaVProduct(v) );
+          }
+        }
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( BinaryCache_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( averaged_elastic ) {
+    DB db0;
+    db0.addParticleType("87Rb");
+    db0.addParticleType("85Rb");
+    db0.initBinaryInteractions();
+    db0.saveBinaryCache( filename );
+
+    chimp::BinaryCache cache( filename );
+    DB db1( cache );
+    check_equal( db0, db1 );
+
+    std::remove( filename );
+  }
+
+  BOOST_AUTO_TEST_CASE( data_inelastic ) {
+    namespace filter = chimp::interaction::filter;
+    typedef boost::shared_ptr<filter::Base> SP;
+
+    DB db0;
+    db0.addParticleType("e^-");
+    db0.addParticleType("N2");
+    db0.addParticleType("N2(rot)");
+    db0.addParticleType("N2(v1res)");
+    db0.filter =
+      SP(
+        new filter::Or( SP(new filter::Elastic),
+                        SP(new filter::Label("inelastic")) )
+      );
+    db0.initBinaryInteractions();
+    db0.saveBinaryCache( filename );
+
+    chimp::BinaryCache cache( filename );
+    DB db1( cache );
+    check_equal( db0, db1 );
+
+    BOOST_CHECK_EQUAL( db1("e^-", "N2").rhs.size(), 3u );
+
+    std::remove( filename );
+  }
+
+  BOOST_AUTO_TEST_CASE( shared_memory ) {
+    typedef chimp::RuntimeDB< DB::options::setLazySets<true>::type > LazyDB;
+    const char * name = "/chimp-BinaryCache-test";
+    chimp::BinaryCache::removeShared( name );
+
+    LazyDB db0;
+    db0.addParticleType("87Rb");
+    db0.addParticleType("85Rb");
+    db0.initBinaryInteractions();
+    db0.saveSharedCache( name );
+
+    /* only one process may publish the object. */
+    BOOST_CHECK_THROW( db0.saveSharedCache( name ), std::runtime_error );
+
+    {
+      chimp::BinaryCache cache( name, chimp::BinaryCache::SHARED_MEMORY );
+      LazyDB db1( cache );
+
+      /* the sets are read from the shared memory on first access. */
+      BOOST_CHECK( db1.getInteractions().isPending(0,1) );
+      check_equal( db0, db1 );
+      BOOST_CHECK( !db1.getInteractions().isPending(0,1) );
+    }
+
+    {
+      /* the database keeps the contents of a temporary cache until its
+       * pending sets have been loaded. */
+      LazyDB db2( chimp::BinaryCache( name,
+                                      chimp::BinaryCache::SHARED_MEMORY ) );
+      BOOST_CHECK( db2.getInteractions().isPending(0,1) );
+      check_equal( db0, db2 );
+    }
+
+    BOOST_CHECK( chimp::BinaryCache::removeShared( name ) );
+    BOOST_CHECK_THROW(
+      chimp::BinaryCache cache( name, chimp::BinaryCache::SHARED_MEMORY ),
+      std::runtime_error
+    );
+  }
+
+  BOOST_AUTO_TEST_CASE( temporary_cache ) {
+    typedef chimp::RuntimeDB< DB::options::setLazySets<true>::type > LazyDB;
+
+    LazyDB db0;
+    db0.addParticleType("87Rb");
+    db0.addParticleType("85Rb");
+    db0.initBinaryInteractions();
+    db0.saveBinaryCache( filename );
+
+    /* the cache goes out of scope before the first set is accessed. */
+    LazyDB db1( ( chimp::BinaryCache( filename ) ) );
+    std::remove( filename );
+
+    BOOST_CHECK( db1.getInteractions().isPending(0,0) );
+    check_equal( db0, db1 );
+  }
+
+  BOOST_AUTO_TEST_CASE( invalid_files ) {
+    {
+      std::ofstream fout( filename, std::ios::binary );
+      fout << "not a cache file";
+    }
+    BOOST_CHECK_THROW( chimp::BinaryCache cache( filename ),
+                       std::runtime_error );
+
+    {
+      DB db0;
+      db0.addParticleType("87Rb");
+      db0.initBinaryInteractions();
+      db0.saveBinaryCache( filename );
+    }
+
+    /* a cache for a different options class must be rejected. */
+    chimp::BinaryCache cache( filename );
+    typedef chimp::RuntimeDB<
+      chimp::make_options<>::type::setPreComputedSets<true>::type
+    > OtherDB;
+    BOOST_CHECK_THROW( OtherDB db1( cache ), std::runtime_error );
+
+    std::remove( filename );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
@@ -0,0 +1,139 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+/** \file
+ * Test file for the CalcContext class.
+ * */
+#define BOOST_TEST_MODULE  CalcContext
+
+
+#include <chimp/physical_calc.h>
+
+#include <physical/calc/Driver.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+  using runtime::physical::calc::Driver;
+  using chimp::CalcContext;
+
+  double evalInContext( const CalcContext & ctx, const std::string & expr ) {
+    CalcContext::Scope scope( ctx );
+    return Driver::instance().eval( expr ).getCoeff<double>();
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( CalcContext_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( independent_contexts ) {
+    CalcContext a, b;
+
+    {
+      CalcContext::Scope scope( a );
+      Driver::instance().exec( "chimp_test_symbol = 2" );
+    }
+
+    {
+      CalcContext::Scope scope( b );
+      Driver::instance().exec( "chimp_test_symbol = 3" );
+    }
+
+    BOOST_CHECK_EQUAL( evalInContext( a, "chimp_test_symbol" ), 2.0 );
+    BOOST_CHECK_EQUAL( evalInContext( b, "chimp_test_symbol" ), 3.0 );
+
+    /* neither context leaks into the process-wide calculator. */
+    BOOST_CHECK_EQUAL( Driver::instance().symbols.count("chimp_test_symbol"),
+                       0u );
+
+    /* a reset only affects the one context. */
+    b.reset();
+    BOOST_CHECK_EQUAL( evalInContext( a, "chimp_test_symbol" ), 2.0 );
+    {
+      CalcContext::Scope scope( b );
+      BOOST_CHECK_EQUAL( Driver::instance().symbols.count("chimp_test_symbol"),
+                         0u );
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE( nested_scopes ) {
+    CalcContext a, b;
+    {
+      CalcContext::Scope scope( a );
+      Driver::instance().exec( "chimp_test_symbol = 5" );
+    }
+
+    {
+      CalcContext::Scope outer( a );
+      {
+        CalcContext::Scope inner( a );
+        BOOST_CHECK_EQUAL( evalInContext( a, "chimp_test_symbol" ), 5.0 );
+      }
+      BOOST_CHECK_EQUAL(
+        Driver::instance().eval("chimp_test_symbol").getCoeff<double>(), 5.0
+      );
+
+      {
+        CalcContext::Scope other( b );
+        BOOST_CHECK_EQUAL(
+          Driver::instance().symbols.count("chimp_test_symbol"), 0u
+        );
+      }
+
+      BOOST_CHECK_EQUAL(
+        Driver::instance().eval("chimp_test_symbol").getCoeff<double>(), 5.0
+      );
+    }
+  }
+
+  BOOST_AUTO_TEST_CASE( interleaved_scopes ) {
+    CalcContext a, b;
+    {
+      CalcContext::Scope scope( a );
+      Driver::instance().exec( "chimp_test_symbol = 7" );
+    }
+    {
+      CalcContext::Scope scope( b );
+      Driver::instance().exec( "chimp_test_symbol = 11" );
+    }
+
+    /* a -> b -> a:  the innermost context is always the one installed. */
+    {
+      CalcContext::Scope outer( a );
+      {
+        CalcContext::Scope middle( b );
+        BOOST_CHECK_EQUAL( evalInContext( a, "chimp_test_symbol" ), 7.0 );
+        BOOST_CHECK_EQUAL(
+          Driver::instance().eval("chimp_test_symbol").getCoeff<double>(),
+          11.0
+        );
+      }
+      BOOST_CHECK_EQUAL(
+        Driver::instance().eval("chimp_test_symbol").getCoeff<double>(), 7.0
+      );
+    }
+
+    BOOST_CHECK_EQUAL( Driver::instance().symbols.count("chimp_test_symbol"),
+                       0u );
+    BOOST_CHECK_EQUAL( evalInContext( b, "chimp_test_symbol" ), 11.0 );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }
@@ -30,6 +30,7 @@
 #include <chimp/RuntimeDB.h>
 #include <chimp/interaction/filter/Or.h>
 #include <chimp/interaction/filter/Not.h>
+#include <chimp/interaction/filter/Null.h>
 #include <chimp/interaction/filter/EqIO.h>
 #include <chimp/interaction/filter/Label.h>
 #include <chimp/interaction/filter/Elastic.h>
@@ -37,6 +38,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <sstream>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE( RuntimeDB_tests ); // {
 
@@ -138,8 +140,8 @@ BOOST_AUTO_TEST_SUITE( RuntimeDB_tests ); // {
 
     db.initBinaryInteractions();
 
-    // the size of the table should be 6
-    BOOST_CHECK_EQUAL( db.getInteractions().size(), 6u );
+    // the side-length of the table should be 3
+    BOOST_CHECK_EQUAL( db.getInteractions().side_length(), 3u );
 
     typedef DB::InteractionTable::const_iterator CIter;
     unsigned int number_interactions = 0u;
@@ -152,6 +154,18 @@ BOOST_AUTO_TEST_SUITE( RuntimeDB_tests ); // {
     // NOTE:  if we add new collisions data, we will have to change these:
     BOOST_CHECK_EQUAL( number_interactions, 1u );
 
+    // only the pairs with interactions are stored
+    BOOST_CHECK_EQUAL( db.getInteractions().size(), 1u );
+    {
+      const unsigned int e  = db.findParticleIndx("e^-"),
+                         Hg = db.findParticleIndx("Hg"),
+                         Hg_plus = db.findParticleIndx("Hg^+");
+      BOOST_REQUIRE_EQUAL( db.getInteractions().partners(e).size(), 1u );
+      BOOST_CHECK_EQUAL( db.getInteractions().partners(e).front().species, Hg );
+      BOOST_CHECK_EQUAL( db.getInteractions().partners(Hg).front().species, e );
+      BOOST_CHECK_EQUAL( db.getInteractions().partners(Hg_plus).size(), 0u );
+    }
+
     BOOST_CHECK_EQUAL( db("e^-", "e^-" ).rhs.size(), 0u );
     BOOST_CHECK_EQUAL( db("e^-", "Hg"  ).rhs.size(), 1u );
     BOOST_CHECK_EQUAL( db("e^-", "Hg^+").rhs.size(), 0u );
@@ -162,6 +176,123 @@ BOOST_AUTO_TEST_SUITE( RuntimeDB_tests ); // {
     BOOST_CHECK_EQUAL( db("Hg^+","Hg^+").rhs.size(), 0u );
   }
 
+  BOOST_AUTO_TEST_CASE( extendBinaryInteractions ) {
+    namespace filter = chimp::interaction::filter;
+    typedef boost::shared_ptr<filter::Base> SP;
+
+    typedef chimp::RuntimeDB<> DB;
+    DB db;
+    db.addParticleType("e^-");
+    db.addParticleType("Hg");
+
+    db.filter =
+      SP(
+        new filter::Or( SP(new filter::Elastic),
+                        SP(new filter::Label("inelastic")) )
+      );
+
+    db.initBinaryInteractions();
+    const int e  = db.findParticleIndx("e^-"),
+              Hg = db.findParticleIndx("Hg");
+
+    // the ionization of Hg requires Hg^+
+    BOOST_CHECK_EQUAL( db.getInteractions().size(), 0u );
+
+    db.addParticleType("Hg^+");
+    BOOST_CHECK_EQUAL( db.extendBinaryInteractions(), 2 );
+
+    // the previous species keep their indices (Hg^+ is lighter than Hg)
+    BOOST_CHECK_EQUAL( db.findParticleIndx("e^-"),  e );
+    BOOST_CHECK_EQUAL( db.findParticleIndx("Hg"),   Hg );
+    BOOST_CHECK_EQUAL( db.findParticleIndx("Hg^+"), 2 );
+    BOOST_CHECK_EQUAL( db.getInteractions().side_length(), 3u );
+
+    // the previous pair gained the ionization equation
+    BOOST_CHECK_EQUAL( db.getInteractions().size(), 1u );
+    BOOST_CHECK_EQUAL( db("e^-", "Hg"  ).rhs.size(), 1u );
+    BOOST_CHECK_EQUAL( db("e^-", "Hg^+").rhs.size(), 0u );
+    BOOST_CHECK_EQUAL( db("Hg",  "Hg^+").rhs.size(), 0u );
+    BOOST_CHECK_EQUAL( db("Hg^+","Hg^+").rhs.size(), 0u );
+
+    // nothing changes without new species
+    BOOST_CHECK_EQUAL( db.extendBinaryInteractions(), 3 );
+    BOOST_CHECK_EQUAL( db("e^-", "Hg"  ).rhs.size(), 1u );
+  }
+
+  BOOST_AUTO_TEST_CASE( species_remap ) {
+    typedef chimp::RuntimeDB<> DB;
+
+    struct Remap : DB::SpeciesRemap {
+      std::vector<int> new_index;
+      void operator() ( const std::vector<int> & new_index ) {
+        this->new_index = new_index;
+      }
+    };
+
+    DB db;
+    Remap * remap = new Remap;
+    db.species_remap.reset( remap );
+
+    db.addParticleType("87Rb");
+    db.initBinaryInteractions();
+    BOOST_CHECK( remap->new_index.empty() );
+
+    db.addParticleType("85Rb");
+    BOOST_CHECK_EQUAL( db.extendBinaryInteractions(), 1 );
+    BOOST_CHECK( remap->new_index.empty() );
+    BOOST_CHECK_EQUAL( db.findParticleIndx("85Rb"), 1 );
+    BOOST_CHECK_EQUAL( db("85Rb","85Rb").rhs.size(), 1u );
+    BOOST_CHECK_EQUAL( db("87Rb","85Rb").rhs.size(), 1u );
+
+    // sorting by mass moves 85Rb in front of 87Rb
+    db.initBinaryInteractions();
+    BOOST_REQUIRE_EQUAL( remap->new_index.size(), 2u );
+    BOOST_CHECK_EQUAL( remap->new_index[0], 1 );
+    BOOST_CHECK_EQUAL( remap->new_index[1], 0 );
+    BOOST_CHECK_EQUAL( db.findParticleIndx("85Rb"), 0 );
+    BOOST_CHECK_EQUAL( db("87Rb","85Rb").rhs.size(), 1u );
+  }
+
+  BOOST_AUTO_TEST_CASE( indexed_lhs_lookup_matches_xpath ) {
+    namespace filter = chimp::interaction::filter;
+    typedef boost::shared_ptr<filter::Base> SP;
+    using chimp::property::name;
+    using filter::EqTerm;
+    using filter::EqTermSet;
+
+    typedef chimp::RuntimeDB<> DB;
+    DB db;
+    db.addParticleType("e^-");
+    db.addParticleType("Hg");
+    db.addParticleType("Hg^+");
+    db.addParticleType("N2");
+    db.addParticleType("87Rb");
+    db.filter = SP(new filter::Null);
+
+    DB::LHSRelatedInteractionCtx lhs = db.findAllLHSRelatedInteractionCtx();
+    BOOST_CHECK_EQUAL( lhs.size(), 15u );
+
+    typedef DB::LHSRelatedInteractionCtx::const_iterator LIter;
+    for ( LIter i = lhs.begin(); i != lhs.end(); ++i ) {
+      const std::string & n_A = db[i->first.A.species].name::value;
+      const std::string & n_B = db[i->first.B.species].name::value;
+
+      EqTermSet in;
+      if ( n_A == n_B )
+        in.insert( EqTerm(n_A,2) );
+      else {
+        in.insert( EqTerm(n_A,1) );
+        in.insert( EqTerm(n_B,1) );
+      }
+
+      chimp::xml::Context::list xl = db.xmlDb.eval(
+        "//Interaction/cross_section/../" + getXpathQuery("In", in)
+      );
+      chimp::xml::Context::set xs( xl.begin(), xl.end() );
+      BOOST_CHECK( xs == i->second );
+    }
+  }
+
   BOOST_AUTO_TEST_SUITE( create_missing_elastic_tests ); // {
     /* reused check code */
     template < typename DB >
@@ -266,6 +397,44 @@ BOOST_AUTO_TEST_SUITE( RuntimeDB_tests ); // {
       db.initBinaryInteractions();
       check_table(db, 1u);
     }
+
+    BOOST_AUTO_TEST_CASE( lazy_sets ) {
+      typedef chimp::make_options<>::type
+        ::setAutoCreateMissingElastic<true>::type
+        ::setLazySets<true>::type   options;
+      typedef chimp::RuntimeDB<options> DB;
+      DB db;
+      db.addParticleType("87Rb");
+      db.addParticleType("85Rb");
+
+      namespace filter = chimp::interaction::filter;
+      typedef boost::shared_ptr<filter::Base> SP;
+      db.filter =
+        SP( new filter::Not( // pos - neg
+              // positive filter
+              SP(new filter::Elastic),
+              // negative filter
+              SP(new filter::EqIO(filter::EqIO::IN, "85Rb", "87Rb"))
+        ));
+
+
+      db.initBinaryInteractions();
+
+      int i87Rb = db.findParticleIndx("87Rb");
+      int i85Rb = db.findParticleIndx("85Rb");
+      const DB::InteractionTable & table = db.getInteractions();
+      BOOST_CHECK( table.isPending(i87Rb,i87Rb) );
+      BOOST_CHECK( table.isPending(i85Rb,i85Rb) );
+      BOOST_CHECK( table.isPending(i85Rb,i87Rb) );
+
+      /* the cross-species set loads both single-species sets. */
+      BOOST_CHECK_EQUAL( db(i85Rb,i87Rb).rhs.size(), 1u );
+      BOOST_CHECK( !table.isPending(i87Rb,i87Rb) );
+      BOOST_CHECK( !table.isPending(i85Rb,i85Rb) );
+      BOOST_CHECK( !table.isPending(i85Rb,i87Rb) );
+
+      check_table(db, 1u);
+    }
   BOOST_AUTO_TEST_SUITE_END(); // }
 
 BOOST_AUTO_TEST_SUITE_END(); // }
@@ -0,0 +1,165 @@
+/*==============================================================================
+ * Public Domain Contributions 2009 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of CHIMP                                                  *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+/** \file
+ * Test file for the  SoAParticles adaptor.
+ * */
+#define BOOST_TEST_MODULE  SoAParticles
+
+
+#include <chimp/SoAParticles.h>
+#include <chimp/RuntimeDB.h>
+#include <chimp/make_options.h>
+#include <chimp/interaction/Driver.h>
+
+#include <xylose/Vector.h>
+#include <xylose/IteratorRange.h>
+#include <xylose/random/Kiss.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <set>
+
+namespace {
+  using xylose::V3;
+  typedef xylose::Vector<double,3u> Vec;
+  using chimp::SoAParticle;
+  using chimp::SoAParticles;
+
+  /** Single-species cell of particles of the given iterator range type. */
+  template < typename Range >
+  struct Cell {
+    typedef Range SpeciesRange;
+
+    std::vector< SpeciesRange > species;
+
+    Cell( const SpeciesRange & range ) : species( 1u, range ) { }
+
+    std::size_t getNumberOfSpecies() const { return species.size(); }
+    SpeciesRange & getSpecies( const unsigned int & A ) { return species[A]; }
+    double maxRelativeVelocity( const unsigned int &,
+                                const unsigned int & ) const { return 200.; }
+    double volume() const { return 1e-12; }
+  };
+}
+
+BOOST_AUTO_TEST_SUITE( SoAParticles_tests ); // {
+
+  BOOST_AUTO_TEST_CASE( proxy_semantics ) {
+    std::vector<Vec> x( 2u, V3(0.,0.,0.) ), v( 2u, V3(0.,0.,0.) );
+    std::vector<int> s( 2u, 0 );
+    SoAParticles soa( &x[0], &v[0], &s[0], NULL, 2u );
+
+    SoAParticles::iterator i = soa.begin();
+    BOOST_CHECK( i->isAttached() );
+    BOOST_CHECK_EQUAL( soa.end() - soa.begin(), 2 );
+
+    /* accessors write into the arrays. */
+    setVelocity( *i, V3(1.,2.,3.) );
+    setSpecies( *i, 4 );
+    BOOST_CHECK_EQUAL( v[0], V3(1.,2.,3.) );
+    BOOST_CHECK_EQUAL( s[0], 4 );
+    BOOST_CHECK_EQUAL( weight(*i), 1.0f );
+
+    /* copies are detached. */
+    SoAParticle copy = *i;
+    BOOST_CHECK( !copy.isAttached() );
+    setVelocity( copy, V3(5.,5.,5.) );
+    BOOST_CHECK_EQUAL( v[0], V3(1.,2.,3.) );
+
+    /* assignment to an attached particle writes into the arrays. */
+    *(i + 1) = copy;
+    BOOST_CHECK_EQUAL( v[1], V3(5.,5.,5.) );
+    BOOST_CHECK_EQUAL( s[1], 4 );
+  }
+
+  BOOST_AUTO_TEST_CASE( driver_matches_aos ) {
+    typedef chimp::make_options<>::type aos_options;
+    typedef aos_options::setParticle<SoAParticle>::type soa_options;
+    typedef aos_options::Particle Particle;
+
+    chimp::RuntimeDB<aos_options> aos_db;
+    chimp::RuntimeDB<soa_options> soa_db;
+    aos_db.addParticleType("87Rb");
+    soa_db.addParticleType("87Rb");
+    aos_db.initBinaryInteractions();
+    soa_db.initBinaryInteractions();
+
+    /* identical initial particles in both layouts. */
+    const unsigned int N = 500u;
+    std::vector<Particle> aos;
+    std::vector<Vec> x, v;
+    std::vector<int> s;
+    std::vector<float> w;
+    {
+      xylose::random::Kiss rng;
+      rng.seed( 3u );
+      for ( unsigned int i = 0; i < N; ++i ) {
+        const Vec vi = V3( 100. * ( rng.rand() - .5 ),
+                           100. * ( rng.rand() - .5 ),
+                           100. * ( rng.rand() - .5 ) );
+        aos.push_back( Particle( V3(0.,0.,0.), vi, 0 ) );
+        x.push_back( V3(0.,0.,0.) );
+        v.push_back( vi );
+        s.push_back( 0 );
+        w.push_back( 1.0f );
+      }
+    }
+
+    typedef xylose::IteratorRange< std::vector<Particle>::iterator > AoSRange;
+    typedef xylose::IteratorRange< SoAParticles::iterator > SoARange;
+    SoAParticles soa( &x[0], &v[0], &s[0], &w[0], N );
+    const std::vector<Vec> v0 = v;
+
+    Cell<AoSRange> aos_cell( AoSRange( aos.begin(), aos.end() ) );
+    Cell<SoARange> soa_cell( SoARange( soa.begin(), soa.end() ) );
+
+    xylose::random::Kiss aos_rng, soa_rng;
+    aos_rng.seed( 42u );
+    soa_rng.seed( 42u );
+
+    std::vector<Particle> aos_products;
+    std::set< std::vector<Particle>::iterator > aos_eq;
+    chimp::interaction::Driver<> aos_driver;
+    aos_driver( 1e-3, aos_cell, aos_db, aos_products, aos_eq, aos_rng );
+
+    std::vector<SoAParticle> soa_products;
+    std::set< SoAParticles::iterator > soa_eq;
+    chimp::interaction::Driver<> soa_driver;
+    soa_driver( 1e-3, soa_cell, soa_db, soa_products, soa_eq, soa_rng );
+
+    BOOST_CHECK_EQUAL( soa_products.size(), aos_products.size() );
+    BOOST_CHECK_EQUAL( soa_eq.size(), aos_eq.size() );
+
+    /* same collisions, applied directly to the arrays. */
+    unsigned int n_changed = 0u;
+    for ( unsigned int i = 0; i < N; ++i ) {
+      BOOST_CHECK_EQUAL( v[i], aos[i].v );
+      if ( v[i] != v0[i] )
+        ++n_changed;
+    }
+    BOOST_CHECK_GT( n_changed, 0u );
+  }
+
+BOOST_AUTO_TEST_SUITE_END(); // }